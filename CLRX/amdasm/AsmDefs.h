@@ -28,6 +28,8 @@
 #include <vector>
 #include <utility>
 #include <list>
+#include <deque>
+#include <initializer_list>
 #include <unordered_map>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/amdasm/Commons.h>
@@ -203,7 +205,129 @@ struct AsmSymbol
 };
 
 /// assembler symbol map
-typedef std::unordered_map<CString, AsmSymbol> AsmSymbolMap;
+/** open addressing hash table. entries are stored in insertion order and
+ * they have stable addresses (do not move after inserting new entries).
+ * hash of symbol name can be computed once and used to find symbol in many maps */
+class AsmSymbolMap
+{
+public:
+    /// value type (symbol entry)
+    typedef std::pair<const CString, AsmSymbol> value_type;
+    /// iterator
+    typedef std::deque<value_type>::iterator iterator;
+    /// const iterator
+    typedef std::deque<value_type>::const_iterator const_iterator;
+private:
+    struct Slot
+    {
+        size_t hash;
+        size_t index;   // index of entry, SIZE_MAX if empty
+    };
+    std::deque<value_type> entries;
+    std::vector<Slot> slots;
+    cxuint slotsBits;
+    
+    // get slot index for hash
+    size_t slotForHash(size_t hash) const
+    { return size_t((uint64_t(hash)*0x9e3779b97f4a7c15ULL) >> (64-slotsBits)); }
+    // find index of entry, returns SIZE_MAX if not found
+    size_t findIndex(const char* name, size_t hash) const;
+    // add new entry to slots (entry must be already in entries)
+    void putSlot(size_t hash, size_t index);
+public:
+    /// empty constructor
+    AsmSymbolMap() : slotsBits(0)
+    { }
+    /// constructor with initializer list
+    AsmSymbolMap(std::initializer_list<value_type> list);
+    
+    /// compute hash of symbol name
+    static size_t hashName(const char* name)
+    {
+        size_t hash = 0;
+        for (const char* p = name; *p != 0; p++)
+            hash = ((hash<<8)^(cxbyte)*p)*size_t(0xbf146a3dU);
+        return hash;
+    }
+    
+    /// get number of symbols
+    size_t size() const
+    { return entries.size(); }
+    /// return true if empty
+    bool empty() const
+    { return entries.empty(); }
+    /// get begin iterator
+    iterator begin()
+    { return entries.begin(); }
+    /// get end iterator
+    iterator end()
+    { return entries.end(); }
+    /// get begin iterator
+    const_iterator begin() const
+    { return entries.begin(); }
+    /// get end iterator
+    const_iterator end() const
+    { return entries.end(); }
+    
+    /// find symbol with precomputed hash of name
+    iterator find(const CString& name, size_t hash)
+    {
+        const size_t index = findIndex(name.c_str(), hash);
+        return (index != SIZE_MAX) ? entries.begin()+index : entries.end();
+    }
+    /// find symbol with precomputed hash of name
+    const_iterator find(const CString& name, size_t hash) const
+    {
+        const size_t index = findIndex(name.c_str(), hash);
+        return (index != SIZE_MAX) ? entries.begin()+index : entries.end();
+    }
+    /// find symbol
+    iterator find(const CString& name)
+    { return find(name, hashName(name.c_str())); }
+    /// find symbol
+    const_iterator find(const CString& name) const
+    { return find(name, hashName(name.c_str())); }
+    
+    /// insert symbol with precomputed hash of name if it doesn't exist
+    /**
+     * \param value pair of symbol name and symbol
+     * \param hash hash of symbol name
+     * \return iterator to symbol entry and true if symbol inserted
+     */
+    template<typename P>
+    std::pair<iterator, bool> insert(P&& value, size_t hash)
+    {
+        const size_t index = findIndex(value.first.c_str(), hash);
+        if (index != SIZE_MAX)
+            return std::make_pair(entries.begin()+index, false);
+        entries.emplace_back(std::forward<P>(value));
+        putSlot(hash, entries.size()-1);
+        return std::make_pair(entries.end()-1, true);
+    }
+    /// insert symbol if it doesn't exist
+    template<typename P>
+    std::pair<iterator, bool> insert(P&& value)
+    {
+        const size_t hash = hashName(value.first.c_str());
+        return insert(std::forward<P>(value), hash);
+    }
+    /// insert symbol if it doesn't exist
+    std::pair<iterator, bool> insert(const value_type& value)
+    { return insert<const value_type&>(value); }
+    
+    /// get symbol (insert it if it doesn't exist)
+    AsmSymbol& operator[](const CString& name)
+    { return insert(std::make_pair(name, AsmSymbol())).first->second; }
+    
+    /// remove all symbols
+    void clear()
+    {
+        entries.clear();
+        slots.clear();
+        slotsBits = 0;
+    }
+};
+
 /// assembler symbol entry
 typedef AsmSymbolMap::value_type AsmSymbolEntry;
 
@@ -524,7 +648,7 @@ struct AsmSingleVReg // key for regvar
     { return regVar == r2.regVar && index == r2.index; }
     /// not equal operator
     bool operator!=(const AsmSingleVReg& r2) const
-    { return regVar == r2.regVar && index == r2.index; }
+    { return regVar != r2.regVar || index != r2.index; }
     
     /// less operator
     bool operator<(const AsmSingleVReg& r2) const
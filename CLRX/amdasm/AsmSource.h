@@ -31,6 +31,8 @@
 #include <vector>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <CLRX/amdasm/Commons.h>
 #include <CLRX/utils/Utilities.h>
 
@@ -186,6 +188,50 @@ public:
         LineNo lineNo;    ///< line number
         RefPtr<const AsmSource> source; ///< source
     };
+    
+    /// type of segment of compiled content
+    enum class SegmentType: cxbyte
+    {
+        TEXT = 0,   ///< text from content
+        ARG,        ///< macro argument
+        COUNTER     ///< macro counter ('\@')
+    };
+    
+    /// segment of compiled content (text or substitution)
+    struct Segment
+    {
+        SegmentType type;   ///< segment type
+        size_t index;   ///< position in content or index of argument in sorted args
+        size_t size;    ///< size of text
+    };
+    
+    /// column translation event in compiled content
+    struct ColTransEvent
+    {
+        size_t segment; ///< index of segment
+        size_t offset;  ///< offset in segment
+        LineNo lineNo;  ///< line number
+        bool put;       ///< put column translation
+        bool lineStart; ///< real line start (reset real line position)
+    };
+    
+    /// type of column translation after end of line
+    enum class LineEndMode: cxbyte
+    {
+        NONE = 0,   ///< no next column translation
+        NEWLINE,    ///< next line is real line
+        JOINED      ///< next line is next statement of same real line
+    };
+    
+    /// line of compiled content
+    struct CompiledLine
+    {
+        size_t segmentsStart;   ///< first segment of line
+        size_t eventsStart;     ///< first column translation event of line
+        LineNo firstLineNo;     ///< line number of line start
+        LineNo lineNo;          ///< line number after reading line
+        LineEndMode endMode;    ///< column translation after end of line
+    };
 private:
     LineNo contentLineNo;
     AsmSourcePos sourcePos;
@@ -193,6 +239,9 @@ private:
     std::vector<char> content;
     std::vector<SourceTrans> sourceTranslations;
     std::vector<LineTrans> colTranslations;
+    std::vector<Segment> segments;
+    std::vector<ColTransEvent> colTransEvents;
+    std::vector<CompiledLine> compiledLines;
 public:
     /// constructor
     AsmMacro(const AsmSourcePos& pos, const Array<AsmMacroArg>& args);
@@ -209,12 +258,24 @@ public:
      */
     void addLine(RefPtr<const AsmMacroSubst> macro, RefPtr<const AsmSource> source,
              const std::vector<LineTrans>& colTrans, size_t lineSize, const char* line);
+    /// compile content to segments (text and substitutions) for non-altmacro mode
+    /** should be called after adding last line of macro */
+    void compile();
     /// get column translations
     const std::vector<LineTrans>& getColTranslations() const
     { return colTranslations; }
     /// get content vector
     const std::vector<char>& getContent() const
     { return content; }
+    /// get segments of compiled content
+    const std::vector<Segment>& getSegments() const
+    { return segments; }
+    /// get column translation events of compiled content
+    const std::vector<ColTransEvent>& getColTransEvents() const
+    { return colTransEvents; }
+    /// get compiled lines (last element is end of content)
+    const std::vector<CompiledLine>& getCompiledLines() const
+    { return compiledLines; }
     /// get source translations size
     size_t getSourceTransSize() const
     { return sourceTranslations.size(); }
@@ -406,10 +467,63 @@ public:
     { return type; }
 };
 
+/// filtered content of source file (lines returned by AsmStreamInputFilter)
+struct AsmFilteredContent: public RefCountable
+{
+    /// line of filtered content
+    struct Line
+    {
+        size_t textPos;     ///< position of line in text
+        size_t size;        ///< line size
+        size_t colTransPos; ///< first column translation of line
+        size_t messagePos;  ///< first message printed while reading line
+        LineNo lineNo;      ///< line number after reading line
+    };
+    /// message printed while filtering content
+    struct Message
+    {
+        LineCol lineCol;    ///< position of message
+        bool warning;       ///< true if warning, false if error
+        const char* message;    ///< message (static string)
+    };
+    
+    uint64_t timestamp;     ///< timestamp of file
+    uint64_t fileSize;      ///< size of file
+    std::vector<char> text; ///< text of lines
+    std::vector<Line> lines;    ///< line index (last element is end of content)
+    std::vector<LineTrans> colTranslations; ///< column translations of lines
+    std::vector<Message> messages;  ///< messages
+};
+
+/// cache of filtered content of included files
+/** cache can be shared between many assemblers (also used by many threads).
+ * entries are keyed by path of file and valid only if timestamp and size of file
+ * have not been changed. cache is not used by default by assembler, because
+ * filtering of whole file at once omits reading lines directly from mapped file */
+class AsmIncludeCache: public RefCountable, public NonCopyableAndNonMovable
+{
+private:
+    std::mutex mutex;
+    std::unordered_map<CString, RefPtr<const AsmFilteredContent> > entries;
+public:
+    /// constructor
+    AsmIncludeCache()
+    { }
+    
+    /// get content of file if it is in cache and if it has given timestamp and size
+    RefPtr<const AsmFilteredContent> getContent(const CString& filename,
+                uint64_t timestamp, uint64_t fileSize);
+    /// put content of file
+    void putContent(const CString& filename, RefPtr<const AsmFilteredContent> content);
+    /// remove all entries
+    void clear();
+};
+
 /// assembler input layout filter
 /** filters input from comments and join splitted lines by backslash.
  * readLine returns prepared line which have only space (' ') and
- * non-space characters. */
+ * non-space characters. If input is given by filename, then file is mapped to memory
+ * and lines that do not need any change are returned directly from mapped file. */
 class AsmStreamInputFilter: public AsmInputFilter
 {
 private:
@@ -424,9 +538,22 @@ private:
     
     bool managed;
     std::istream* stream;
+    std::unique_ptr<MappedFileData> mappedFile;
+    size_t mappedPos;   ///< position of unread data in mapped file
+    RefPtr<const AsmFilteredContent> filteredContent;   ///< content from cache
+    AsmFilteredContent* recordedContent;    ///< content to record messages
     LineMode mode;
     size_t stmtPos;
     
+    // open file by mapping it to memory
+    void openFile(const CString& filename);
+    // read next data to buffer from mapped file (to end of physical line)
+    size_t readMapped(size_t pos, size_t maxSize);
+    // print message or record it if filtered content is being prepared
+    void printMessage(Assembler& assembler, LineCol lineCol, bool warning,
+                const char* message);
+    // read line from filtered content
+    const char* readFilteredLine(Assembler& assembler, size_t& lineSize);
 public:
     /// constructor with input stream and their filename
     explicit AsmStreamInputFilter(std::istream& is, const CString& filename = "");
@@ -437,10 +564,24 @@ public:
              const CString& filename = "");
     /// constructor with source position and input filename
     AsmStreamInputFilter(const AsmSourcePos& pos, const CString& filename);
+    /// constructor with source position, input filename and its filtered content
+    AsmStreamInputFilter(const AsmSourcePos& pos, const CString& filename,
+             RefPtr<const AsmFilteredContent> content);
     /// destructor
     ~AsmStreamInputFilter();
     
     const char* readLine(Assembler& assembler, size_t& lineSize);
+    
+    /// read and filter whole file
+    /**
+     * \param assembler assembler
+     * \param filename filename
+     * \param timestamp timestamp of file
+     * \param fileSize size of file
+     * \return filtered content of file
+     */
+    static RefPtr<const AsmFilteredContent> filterFile(Assembler& assembler,
+             const CString& filename, uint64_t timestamp, uint64_t fileSize);
 };
 
 /// assembler macro input filter (for macro filtering)
@@ -462,6 +603,9 @@ private:
     const LineTrans* curColTrans;
     size_t realLinePos; ///< real line size
     bool alternateMacro;
+    
+    // read line from compiled macro content (non-altmacro mode)
+    const char* readCompiledLine(size_t& lineSize);
 public:
     /// constructor with input macro, source position and arguments map
     AsmMacroInputFilter(RefPtr<const AsmMacro> macro, const AsmSourcePos& pos,
@@ -34,6 +34,7 @@
 #include <utility>
 #include <stack>
 #include <list>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 #include <CLRX/utils/Utilities.h>
@@ -63,10 +64,11 @@ enum: Flags
     ASM_MACRONOCASE = 16, /// disable case-insensitive naming (default)
     ASM_OLDMODPARAM = 32,   ///< use old modifier parametrization (values 0 and 1 only)
     ASM_WAVE32 = 64, ///< use WAVESIZE32
+    ASM_LINEARSCAN = 128, ///< use linear-scan register allocation
     ASM_TESTRESOLVE = (1U<<30), ///< enable resolving symbols if ASM_TESTRUN enabled
     ASM_TESTRUN = (1U<<31), ///< only for running tests
     ASM_ALL = FLAGS_ALL&~(ASM_TESTRUN|ASM_TESTRESOLVE|ASM_BUGGYFPLIT|ASM_MACRONOCASE|
-                    ASM_WAVE32|ASM_OLDMODPARAM)  ///< all flags
+                    ASM_WAVE32|ASM_OLDMODPARAM|ASM_LINEARSCAN)  ///< all flags
 };
 
 enum: Flags
@@ -77,36 +79,43 @@ enum: Flags
 struct AsmRegVar;
 
 /// ISA (register and regvar) Usage handler
+/** usages are stored in chunks (one per 64K range of offsets) as packed byte streams.
+ * every usage is encoded as: zigzag varint offset delta (from previous usage),
+ * varint regvar index (0 - register), varint rstart, varint rend-rstart,
+ * regField byte and flags byte (rwFlags, useRegMode, alignment). every 16-th usage
+ * of chunk is in sparse index that used to find position by offset */
 class ISAUsageHandler
 {
 public:
     /// stgructure that hold read position to store later
     struct ReadPos
     {
-        size_t chunkPos;
-        size_t itemPos;
+        size_t chunkPos;    ///< chunk index
+        size_t itemPos;     ///< byte position in chunk data
+        size_t offset;      ///< offset of previous usage (if itemPos!=0)
     };
     
 protected:
-    struct RegVarUsageInt
+    /// index entry (every 16-th usage)
+    struct IndexEntry
     {
-        const AsmRegVar* regVar;    ///< if null, then usage of called register
-        uint16_t rstart;    ///< register start
-        uint16_t rend;      ///< register end
-        AsmRegField regField;   ///< place in instruction
-        cxbyte rwFlags:2;  ///< 1 - read, 2 - write
-        cxbyte align:5;   ///< register alignment
-        cxbyte useRegMode:1; // usereg mode
-        uint16_t offsetLo;
+        uint16_t offsetLo;  ///< low 16 bits of usage offset
+        uint16_t prevOffsetLo;  ///< low 16 bits of previous usage offset
+        uint32_t dataPos;   ///< byte position in chunk data
     };
     
     struct Chunk
     {
         size_t offsetFirst;
-        std::vector<RegVarUsageInt> items;
+        size_t lastOffset;
+        size_t itemsNum;
+        std::vector<cxbyte> data;
+        std::vector<IndexEntry> index;
     };
     
     std::vector<Chunk> chunks;
+    std::vector<const AsmRegVar*> regVars; ///< regvars by index-1
+    std::unordered_map<const AsmRegVar*, size_t> regVarIndices;
     
     /// constructor
     explicit ISAUsageHandler();
@@ -121,9 +130,9 @@ public:
     /// has next regvar usage
     bool hasNext(const ReadPos& readPos) const
     { return readPos.chunkPos < chunks.size() && (readPos.chunkPos+1 != chunks.size() ||
-        readPos.itemPos < chunks.back().items.size());; }
+        readPos.itemPos < chunks.back().data.size()); }
     /// get next usage
-    AsmRegVarUsage nextUsage(ReadPos& readPos);
+    AsmRegVarUsage nextUsage(ReadPos& readPos) const;
     // find position by offset
     ReadPos findPositionByOffset(size_t offset) const;
     
@@ -205,7 +214,7 @@ public:
     { return readPos.delOpPos < delayedOps.size() ||
                 readPos.waitInstrPos < waitInstrs.size(); }
     /// get next instruction, return true if waitInstr
-    bool nextInstr(ReadPos& readPos, AsmDelayedOp& delOp, AsmWaitInstr& waitInstr);
+    bool nextInstr(ReadPos& readPos, AsmDelayedOp& delOp, AsmWaitInstr& waitInstr) const;
     /// find position by offset
     ReadPos findPositionByOffset(size_t offset) const;
     /// copy wait handler (make new copy)
@@ -415,8 +424,81 @@ public:
      // first - orig ssaid, second - dest ssaid
     typedef std::pair<size_t, size_t> SSAReplace;
     typedef std::unordered_map<AsmSingleVReg, VectorSet<SSAReplace> > SSAReplacesMap;
-    // interference graph type
-    typedef Array<DTreeSet<size_t> > InterGraph;
+    /// interference graph
+    /** small graphs are stored as triangular bit matrix (edge (a,b), where a>b,
+     * is at bit a*(a-1)/2+b), large graphs as sorted chunks of sparse bitsets
+     * (one chunk holds neighbours of 64 consecutive nodes) */
+    class InterGraph
+    {
+    public:
+        /// maximal number of nodes stored as triangular bit matrix
+        static const size_t maxMatrixNodesNum = 4096;
+        /// chunk of sparse bitset (first - index of 64-node chunk, second - bits)
+        typedef std::pair<size_t, uint64_t> Chunk;
+    private:
+        size_t nodesNum;
+        bool sparse;
+        Array<uint64_t> matrix;
+        Array<std::vector<Chunk> > chunks;
+        Array<size_t> degrees;
+    public:
+        /// empty constructor
+        InterGraph() : nodesNum(0), sparse(false)
+        { }
+
+        /// resize graph and remove all edges
+        void resize(size_t nodesNum);
+        /// remove all nodes
+        void clear();
+
+        /// get nodes number
+        size_t size() const
+        { return nodesNum; }
+        /// returns true if graph is stored as sparse bitsets
+        bool isSparse() const
+        { return sparse; }
+        /// get degree (number of neighbours) of node
+        size_t degree(size_t node) const
+        { return degrees[node]; }
+
+        /// add edge, returns true if edge has been added
+        bool addEdge(size_t a, size_t b);
+        /// returns true if graph has edge between a and b
+        bool hasEdge(size_t a, size_t b) const;
+
+        /// call func(neighbour) for all neighbours of node
+        template<typename F>
+        void forEachNeighbor(size_t node, F func) const
+        {
+            if (sparse)
+            {
+                for (const Chunk& chunk: chunks[node])
+                    for (uint64_t bits = chunk.second; bits != 0; bits &= bits-1)
+                        func((chunk.first<<6) + CTZ64(bits));
+                return;
+            }
+            // row of node: neighbours lesser than node
+            const size_t rowStart = (node*(node-1))>>1;
+            const size_t rowEnd = rowStart + node;
+            for (size_t w = rowStart>>6; w < ((rowEnd+63)>>6); w++)
+            {
+                uint64_t bits = matrix[w];
+                if (w == (rowStart>>6))
+                    bits &= ~uint64_t(0) << (rowStart&63);
+                if (w == ((rowEnd-1)>>6) && (rowEnd&63) != 0)
+                    bits &= (uint64_t(1) << (rowEnd&63))-1;
+                for (; bits != 0; bits &= bits-1)
+                    func((w<<6) + CTZ64(bits) - rowStart);
+            }
+            // column of node: neighbours greater than node
+            for (size_t a = node+1; a < nodesNum; a++)
+            {
+                const size_t bit = ((a*(a-1))>>1) + node;
+                if ((matrix[bit>>6] >> (bit&63)) & 1)
+                    func(a);
+            }
+        }
+    };
     typedef std::unordered_map<AsmSingleVReg, std::vector<size_t> > VarIndexMap;
     struct LinearDep
     {
@@ -440,12 +522,16 @@ private:
     VarIndexMap vregIndexMaps[MAX_REGTYPES_NUM]; // indices to igraph for 2 reg types
     InterGraph interGraphs[MAX_REGTYPES_NUM]; // for 2 register 
     Array<cxuint> graphColorMaps[MAX_REGTYPES_NUM];
+    cxuint colorsNums[MAX_REGTYPES_NUM]; // number of allocated registers
+    cxuint occupancy;   // achieved waves per SIMD
     std::unordered_map<size_t, LinearDep> linearDepMaps[MAX_REGTYPES_NUM];
     // key - routine block, value - set of svvregs (lv indexes) used in routine
     std::unordered_map<size_t, VIdxSetEntry> vidxRoutineMap;
     // key - call block, value - set of svvregs (lv indexes) used between this call point
     std::unordered_map<size_t, VIdxSetEntry> vidxCallMap;
     
+    // allocate registers without printing warnings
+    void allocateRegistersInt(AsmSectionId sectionId);
 public:
     AsmRegAllocator(Assembler& assembler);
     // constructor for testing
@@ -459,11 +545,41 @@ public:
     void applySSAReplaces();
     void createLivenesses(ISAUsageHandler& usageHandler,
                 ISALinearDepHandler& linDepHandler);
+    /// update livenesses after changes inside code blocks that keep SSA ids
+    /** changed code blocks are in range [firstBlock, lastBlock). Places of code
+     * blocks and code flow must not be changed. Usage handler and linear dep handler
+     * hold register usage of whole changed code. Only changes where the changed blocks
+     * read before write and write same variables (the same number of times) as before
+     * are handled: then only livenesses inside these blocks are recreated.
+     * SSA ids are never renumbered by this method.
+     * Linear dependencies of variables used in changed blocks are recreated from
+     * all code blocks where these variables live.
+     * \return true if livenesses has been updated, false if SSA ids have been changed
+     * (nothing is updated, use recreateLivenesses)
+     */
+    bool updateBlockLivenesses(ISAUsageHandler& usageHandler,
+                ISALinearDepHandler& linDepHandler, size_t firstBlock, size_t lastBlock);
+    /// recreate SSA data and livenesses of whole code from new register usage
+    /** places of code blocks and code flow must not be changed */
+    void recreateLivenesses(ISAUsageHandler& usageHandler,
+                ISALinearDepHandler& linDepHandler);
     void createInterferenceGraph();
     void colorInterferenceGraph();
+    void allocateLinearScan();
+    void computeOccupancy();
+    /// print warning if achieved occupancy is lower than requested
+    void printOccupancyWarning();
     
     void allocateRegisters(AsmSectionId sectionId);
     
+    /// allocate registers for all code sections concurrently
+    /** one allocator per section, threadsNum - number of threads
+     * (0 - all hardware threads). Returned allocators are in section order
+     * (null for sections without code or register usage). Warnings are printed
+     * in section order after allocation */
+    static std::vector<std::unique_ptr<AsmRegAllocator> > allocateRegistersForSections(
+                Assembler& assembler, cxuint threadsNum = 0);
+    
     const std::vector<CodeBlock>& getCodeBlocks() const
     { return codeBlocks; }
     const SSAReplacesMap& getSSAReplacesMap() const
@@ -476,6 +592,18 @@ public:
     
     const VarIndexMap* getVregIndexMaps() const
     { return vregIndexMaps; }
+    const InterGraph* getInterGraphs() const
+    { return interGraphs; }
+    const Array<cxuint>* getGraphColorMaps() const
+    { return graphColorMaps; }
+    size_t getRegTypesNum() const
+    { return regTypesNum; }
+    /// get numbers of allocated registers for register types
+    const cxuint* getColorsNums() const
+    { return colorsNums; }
+    /// get achieved occupancy (waves per SIMD)
+    cxuint getOccupancy() const
+    { return occupancy; }
     
     const std::unordered_map<size_t, VIdxSetEntry>& getVIdxRoutineMap() const
     { return vidxRoutineMap; }
@@ -486,6 +614,27 @@ public:
 /// Assembler Wait scheduler
 class AsmWaitScheduler
 {
+public:
+    /// state of single wait queue
+    struct QueueState
+    {
+        /// ordered entries (from oldest), queue registers of entry are sorted
+        std::vector<std::vector<uint16_t> > ordered;
+        std::vector<uint16_t> random;   ///< randomly ordered queue registers (sorted)
+        cxuint requestedQueueSize;  ///< requested queue size at start of block
+        bool reallyFlushed; ///< true if queue has been flushed in block
+        QueueState() : requestedQueueSize(0), reallyFlushed(false)
+        { }
+    };
+    /// wait state of code block
+    struct BlockState
+    {
+        std::vector<AsmWaitInstr> waitInstrs;   ///< wait instructions in block
+        /// queue states after simulation of this block alone
+        QueueState queues[ASM_WAIT_MAX_TYPES_NUM];
+        /// queue states after joining this block with previous blocks in code flow
+        QueueState joinedQueues[ASM_WAIT_MAX_TYPES_NUM];
+    };
 private:
     const AsmWaitConfig& waitConfig;
     Assembler& assembler;
@@ -493,17 +642,30 @@ private:
     const AsmRegAllocator::VarIndexMap* vregIndexMaps;
     const Array<cxuint>* graphColorMaps;
     bool onlyWarnings;
+    bool collectBlockStates;
     std::vector<AsmWaitInstr> neededWaitInstrs;
+    std::vector<BlockState> blockStates;
 public:
     AsmWaitScheduler(const AsmWaitConfig& asmWaitConfig, Assembler& assembler,
             const std::vector<AsmRegAllocator::CodeBlock>& codeBlocks,
             const AsmRegAllocator::VarIndexMap* vregIndexMaps,
             const Array<cxuint>* graphColorMaps, bool onlyWarnings);
     
-    void schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& waitHandler);
+    /// schedule wait instructions
+    /** threadsNum - number of threads used to simulate queues in code blocks
+     * (0 - all hardware threads), joining queue states is done in single thread */
+    void schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& waitHandler,
+                cxuint threadsNum = 1);
     
     const std::vector<AsmWaitInstr>& getNeededWaitInstrs() const
     { return neededWaitInstrs; }
+    /// enable collecting wait states of code blocks by schedule (only for testing)
+    void setCollectBlockStates(bool _collectBlockStates)
+    { collectBlockStates = _collectBlockStates; }
+    /// get wait states of code blocks (in code block order)
+    /** empty if collecting block states is not enabled */
+    const std::vector<BlockState>& getBlockStates() const
+    { return blockStates; }
 };
 
 /// type of clause
@@ -571,9 +733,13 @@ private:
     bool resolvingRelocs;
     bool doNotRemoveFromSymbolClones;
     cxuint policyVersion;
+    cxuint regAllocOccupancy;
+    AsmSourcePos regAllocOccupancyPos;
     ISAAssembler* isaAssembler;
+    RefPtr<AsmIncludeCache> includeCache;
     std::vector<DefSym> defSyms;
     std::vector<CString> includeDirs;
+    std::vector<CString> includedFiles;
     std::vector<AsmSection> sections;
     std::vector<Array<AsmSectionId> > relSpacesSections;
     std::unordered_set<AsmSymbolEntry*> symbolSnapshots;
@@ -595,6 +761,7 @@ private:
     bool buggyFPLit;
     bool macroCase;
     bool oldModParam;
+    bool linearScan;
     Flags codeFlags;
     
     cxuint inclusionLevel;
@@ -710,7 +877,7 @@ private:
     // find symbol in scopes
     // internal recursive function to find symbol in scope
     AsmSymbolEntry* findSymbolInScopeInt(AsmScope* scope, const CString& symName,
-                    std::unordered_set<AsmScope*>& scopeSet);
+                    size_t symHash, std::unordered_set<AsmScope*>& scopeSet);
     // scope - return scope from scoped name
     AsmSymbolEntry* findSymbolInScope(const CString& symName, AsmScope*& scope,
                       CString& sameSymName, bool insertMode = false);
@@ -897,6 +1064,12 @@ public:
     /// set policy version
     void setPolicyVersion(cxuint pv)
     { policyVersion = pv; }
+    /// get occupancy (waves per SIMD) targeted by register allocator (0 - none)
+    cxuint getRegAllocOccupancy() const
+    { return regAllocOccupancy; }
+    /// set occupancy (waves per SIMD) targeted by register allocator (0 - none)
+    void setRegAllocOccupancy(cxuint occupancy)
+    { regAllocOccupancy = occupancy; }
     /// get flags
     Flags getFlags() const
     { return flags; }
@@ -921,11 +1094,25 @@ public:
     /// get true if buggyFPLit enabled
     bool isBuggyFPLit() const
     { return buggyFPLit; }
+    /// get true if linear-scan register allocation enabled
+    bool isLinearScan() const
+    { return linearScan; }
     /// get include directory list
     const std::vector<CString>& getIncludeDirs() const
     { return includeDirs; }
     /// adds include directory
     void addIncludeDir(const CString& includeDir);
+    /// get cache of included files
+    RefPtr<AsmIncludeCache> getIncludeCache() const
+    { return includeCache; }
+    /// set cache of included files (can be shared between assemblers)
+    /** by default cache is not used (null). cache helps if same files are included
+     * many times, otherwise it is slower than reading lines from mapped file */
+    void setIncludeCache(RefPtr<AsmIncludeCache> cache)
+    { includeCache = cache; }
+    /// get list of files opened by '.include' and '.incbin' (in order of opening)
+    const std::vector<CString>& getIncludedFiles() const
+    { return includedFiles; }
     /// get symbols map
     const AsmSymbolMap& getSymbolMap() const
     { return globalScope.symbolMap; }
@@ -79,6 +79,7 @@ enum: Flags
 };
 
 struct GCNDisasmUtils;
+struct DisasmParallelUtils;
 
 /// main class for
 class ISADisassembler: public NonCopyableAndNonMovable
@@ -214,6 +215,128 @@ public:
     void disassemble();
 };
 
+/// GCN instruction encoding (in decoded instruction)
+enum class GCNEncoding: cxbyte
+{
+    NONE = 0,   ///< illegal encoding
+    SOPC,   ///< SOPC encoding
+    SOPP,   ///< SOPP encoding
+    SOP1,   ///< SOP1 encoding
+    SOP2,   ///< SOP2 encoding
+    SOPK,   ///< SOPK encoding
+    SMRD,   ///< SMRD encoding (GCN 1.0/1.1)
+    SMEM = SMRD,    ///< SMEM encoding (GCN 1.2/1.4/1.5)
+    VOPC,   ///< VOPC encoding
+    VOP1,   ///< VOP1 encoding
+    VOP2,   ///< VOP2 encoding
+    VOP3A,  ///< VOP3A encoding
+    VOP3B,  ///< VOP3B encoding
+    VINTRP, ///< VINTRP encoding
+    DS,     ///< DS encoding
+    MUBUF,  ///< MUBUF encoding
+    MTBUF,  ///< MTBUF encoding
+    MIMG,   ///< MIMG encoding
+    EXP,    ///< EXP encoding
+    FLAT,   ///< FLAT encoding (and GLOBAL/SCRATCH)
+    VOP3P   ///< VOP3P encoding (GCN 1.5)
+};
+
+/// modifier flags of decoded GCN instruction
+enum : uint32_t
+{
+    GCNDECMOD_ABS0 = 1,     ///< absolute value of first source
+    GCNDECMOD_ABS1 = 2,     ///< absolute value of second source
+    GCNDECMOD_ABS2 = 4,     ///< absolute value of third source
+    GCNDECMOD_NEG0 = 8,     ///< negation of first source
+    GCNDECMOD_NEG1 = 16,    ///< negation of second source
+    GCNDECMOD_NEG2 = 32,    ///< negation of third source
+    GCNDECMOD_CLAMP = 64,   ///< clamp result
+    GCNDECMOD_SDWA = 0x80,  ///< SDWA word (VOP1/VOP2/VOPC)
+    GCNDECMOD_DPP = 0x100,  ///< DPP word (VOP1/VOP2/VOPC)
+    GCNDECMOD_GLC = 0x200,  ///< GLC bit (memory instructions)
+    GCNDECMOD_SLC = 0x400,  ///< SLC bit (memory instructions)
+    GCNDECMOD_TFE = 0x800,  ///< TFE bit (memory instructions)
+    GCNDECMOD_OFFEN = 0x1000,   ///< OFFEN bit (MUBUF/MTBUF)
+    GCNDECMOD_IDXEN = 0x2000,   ///< IDXEN bit (MUBUF/MTBUF)
+    GCNDECMOD_ADDR64 = 0x4000,  ///< ADDR64 bit (MUBUF/MTBUF, GCN 1.0/1.1)
+    GCNDECMOD_GDS = 0x8000,     ///< GDS bit (DS)
+    GCNDECMOD_LDS = 0x10000,    ///< LDS bit (MUBUF)
+    GCNDECMOD_IMM = 0x20000,    ///< offset is immediate (SMRD/SMEM)
+    GCNDECMOD_ILLEGAL = 0x40000 ///< instruction is illegal for architecture
+};
+
+/// operand of decoded GCN instruction
+struct GCNDecodedOperand
+{
+    cxbyte field;   ///< operand field (GCNFIELD_* from GCNDefs.h)
+    /// operand code (first register)
+    /** 0-255 - scalar register or constant (in GCN operand encoding),
+     * 256-511 - vector register */
+    uint16_t code;
+};
+
+/// maximal number of operands in decoded GCN instruction
+/** MIMG with NSA (GCN 1.5) has 4 fields and 12 extra addresses */
+const cxuint GCNDECINSTR_MAX_OPERANDS = 16;
+
+/// decoded GCN instruction
+/** operands holds all register fields of encoding (independently from that
+ * instruction uses them) */
+struct GCNDecodedInstr
+{
+    size_t offset;  ///< offset of instruction (in bytes, includes start offset)
+    const uint32_t* words;  ///< instruction words (in little-endian, points to code)
+    cxuint wordsNum;    ///< number of instruction words
+    GCNEncoding encoding;   ///< instruction encoding
+    cxuint opcode;  ///< opcode in encoding
+    const char* mnemonic;   ///< mnemonic (null if illegal)
+    cxuint operandsNum; ///< number of operands
+    GCNDecodedOperand operands[GCNDECINSTR_MAX_OPERANDS]; ///< operands
+    bool haveLiteral;   ///< true if instruction have literal (or 32-bit constant)
+    uint32_t literal;   ///< literal or 32-bit constant
+    int32_t imm;    ///< immediate (simm16, offset, attribute or target)
+    uint32_t modifiers; ///< modifiers (GCNDECMOD_*)
+    cxbyte omod;    ///< output modifier (VOP3)
+};
+
+/// streaming decoder of GCN instructions
+/** pull-style decoder that produces decoded instructions without any text formatting.
+ * Decoder does not copy code, hence code must be available while decoding */
+class GCNInstrDecoder: public NonCopyableAndNonMovable
+{
+private:
+    GPUArchitecture arch;
+    const uint32_t* codeWords;
+    size_t codeWordsNum;
+    size_t pos;
+    size_t startOffset;
+public:
+    /// constructor
+    /**
+     * \param deviceType GPU device type
+     * \param codeSize size of code in bytes
+     * \param code code
+     * \param startOffset offset of code (added to offset of instructions)
+     */
+    GCNInstrDecoder(GPUDeviceType deviceType, size_t codeSize, const cxbyte* code,
+                size_t startOffset = 0);
+    
+    /// decode next instruction
+    /** \param instr output decoded instruction
+     * \return false if end of code */
+    bool next(GCNDecodedInstr& instr);
+    
+    /// get current position (in bytes)
+    size_t getPosition() const
+    { return pos<<2; }
+    /// set current position (in bytes, must be aligned to 4 bytes)
+    void setPosition(size_t position)
+    { pos = position>>2; }
+    /// returns true if end of code
+    bool atEnd() const
+    { return pos >= codeWordsNum; }
+};
+
 /// single kernel input for disassembler
 /** all pointer members holds only pointers that should be freed by your routines.
  * No management of data */
@@ -377,6 +500,7 @@ class Disassembler: public NonCopyableAndNonMovable
 {
 private:
     friend class ISADisassembler;
+    friend struct DisasmParallelUtils; // INTERNAL LOGIC
     std::unique_ptr<ISADisassembler> isaDisassembler;
     bool fromBinary;
     BinaryFormat binaryFormat;
@@ -390,6 +514,7 @@ private:
     std::ostream& output;
     Flags flags;
     size_t sectionCount;
+    cxuint threadsNum;
 public:
     /// constructor for 32-bit GPU binary
     /**
@@ -493,6 +618,15 @@ public:
     void setFlags(Flags flags)
     { this->flags = flags; }
     
+    /// get threads number used to disassemble kernels
+    cxuint getThreadsNum() const
+    { return threadsNum; }
+    /// set threads number used to disassemble kernels
+    /** if threadsNum is greater than 1, then kernels will be disassembled
+     * concurrently (output is same as in serial mode). 0 - use all hardware threads */
+    void setThreadsNum(cxuint threadsNum)
+    { this->threadsNum = threadsNum; }
+    
     /// get deviceType
     GPUDeviceType getDeviceType() const;
     
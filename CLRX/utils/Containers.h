@@ -25,6 +25,7 @@
 
 #include <CLRX/Config.h>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <algorithm>
 #include <vector>
@@ -497,78 +498,144 @@ void mapSort(Iter begin, Iter end, Comp comp)
 /** Simple cache **/
 
 /// Simple cache for object. object class should have a weight method
+/** cache removes the least frequently used entries (LFU) if total weight exceeds
+ * maximal weight. entries are grouped in buckets by usage counter, buckets are
+ * in a list sorted by usage, hence all operations have constant time */
 template<typename K, typename V>
 class SimpleCache
 {
 private:
+    struct Entry;
+    typedef std::pair<const K, Entry> EntryNode;
+    
     struct Entry
     {
-        size_t sortedPos;
-        size_t usage;
         V value;
+        size_t bucket;  // bucket index
+        EntryNode* prev;    // previous entry in bucket
+        EntryNode* next;    // next entry in bucket
+    };
+    
+    // bucket holds entries that have same usage
+    struct Bucket
+    {
+        size_t usage;
+        size_t prev;    // bucket with lower usage
+        size_t next;    // bucket with higher usage
+        EntryNode* first;
+        EntryNode* last;   // last entry - the most recently used
     };
     
+    static const size_t noBucket = SIZE_MAX;
+    
     size_t totalWeight;
     size_t maxWeight;
     
-    typedef typename std::unordered_map<K, Entry>::iterator EntryMapIt;
-    // sorted entries - sorted by usage
-    std::vector<EntryMapIt> sortedEntries;
     std::unordered_map<K, Entry> entryMap;
+    std::vector<Bucket> buckets;
+    std::vector<size_t> freeBuckets;
+    size_t firstBucket; // bucket with lowest usage
     
-    void updateInSortedEntries(EntryMapIt it)
+    // create bucket after specified bucket (or at begin if prevBucket is noBucket)
+    size_t createBucket(size_t prevBucket, size_t usage)
     {
-        const size_t curPos = it->second.sortedPos;
-        if (curPos == 0)
-            return; // first position
-        if (sortedEntries[curPos-1]->second.usage < it->second.usage &&
-            (curPos==1 || sortedEntries[curPos-2]->second.usage >= it->second.usage))
+        size_t bi;
+        if (!freeBuckets.empty())
         {
-            //std::cout << "fast path" << std::endl;
-            std::swap(sortedEntries[curPos-1]->second.sortedPos, it->second.sortedPos);
-            std::swap(sortedEntries[curPos-1], sortedEntries[curPos]);
-            return;
+            bi = freeBuckets.back();
+            freeBuckets.pop_back();
         }
-        //std::cout << "slow path" << std::endl;
-        auto fit = std::upper_bound(sortedEntries.begin(),
-            sortedEntries.begin()+it->second.sortedPos, it,
-            [](EntryMapIt it1, EntryMapIt it2)
-            { return it1->second.usage > it2->second.usage; });
-        if (fit != sortedEntries.begin()+it->second.sortedPos)
+        else
         {
-            const size_t curPos = it->second.sortedPos;
-            std::swap((*fit)->second.sortedPos, it->second.sortedPos);
-            std::swap(*fit, sortedEntries[curPos]);
+            bi = buckets.size();
+            buckets.push_back(Bucket());
         }
+        const size_t nextBucket = (prevBucket != noBucket) ?
+                    buckets[prevBucket].next : firstBucket;
+        buckets[bi] = Bucket{ usage, prevBucket, nextBucket, nullptr, nullptr };
+        if (prevBucket != noBucket)
+            buckets[prevBucket].next = bi;
+        else
+            firstBucket = bi;
+        if (nextBucket != noBucket)
+            buckets[nextBucket].prev = bi;
+        return bi;
     }
     
-    void insertToSortedEntries(EntryMapIt it)
+    void removeBucket(size_t bi)
     {
-        it->second.sortedPos = sortedEntries.size();
-        sortedEntries.push_back(it);
+        const Bucket& bucket = buckets[bi];
+        if (bucket.prev != noBucket)
+            buckets[bucket.prev].next = bucket.next;
+        else
+            firstBucket = bucket.next;
+        if (bucket.next != noBucket)
+            buckets[bucket.next].prev = bucket.prev;
+        freeBuckets.push_back(bi);
     }
     
-    void removeFromSortedEntries(size_t pos)
+    // get bucket with specified usage that follows prevBucket (or create it)
+    size_t getBucketAfter(size_t prevBucket, size_t usage)
     {
-        // update later element positioning
-        for (size_t i = pos+1; i < sortedEntries.size(); i++)
-            (sortedEntries[i]->second.sortedPos)--;
-        sortedEntries.erase(sortedEntries.begin() + pos);
+        const size_t nextBucket = (prevBucket != noBucket) ?
+                    buckets[prevBucket].next : firstBucket;
+        if (nextBucket != noBucket && buckets[nextBucket].usage == usage)
+            return nextBucket;
+        return createBucket(prevBucket, usage);
+    }
+    
+    void linkEntry(EntryNode* node, size_t bi)
+    {
+        Bucket& bucket = buckets[bi];
+        node->second.bucket = bi;
+        node->second.prev = bucket.last;
+        node->second.next = nullptr;
+        if (bucket.last != nullptr)
+            bucket.last->second.next = node;
+        else
+            bucket.first = node;
+        bucket.last = node;
+    }
+    
+    // unlink entry from its bucket (removes bucket if it will be empty)
+    void unlinkEntry(EntryNode* node)
+    {
+        const size_t bi = node->second.bucket;
+        Bucket& bucket = buckets[bi];
+        if (node->second.prev != nullptr)
+            node->second.prev->second.next = node->second.next;
+        else
+            bucket.first = node->second.next;
+        if (node->second.next != nullptr)
+            node->second.next->second.prev = node->second.prev;
+        else
+            bucket.last = node->second.prev;
+        if (bucket.first == nullptr)
+            removeBucket(bi);
     }
     
 public:
     /// constructor
-    explicit SimpleCache(size_t _maxWeight) : totalWeight(0), maxWeight(_maxWeight)
+    explicit SimpleCache(size_t _maxWeight) : totalWeight(0), maxWeight(_maxWeight),
+            firstBucket(noBucket)
     { }
     
+    SimpleCache(const SimpleCache&) = delete;
+    SimpleCache& operator=(const SimpleCache&) = delete;
+    
     /// use key - get value
     V* use(const K& key)
     {
         auto it = entryMap.find(key);
         if (it != entryMap.end())
         {
-            it->second.usage++;
-            updateInSortedEntries(it);
+            EntryNode* node = &*it;
+            const size_t oldBucket = it->second.bucket;
+            // get next bucket before unlinking (old bucket can be removed)
+            const size_t newBucket = getBucketAfter(oldBucket,
+                        buckets[oldBucket].usage+1);
+            unlinkEntry(node);
+            linkEntry(node, newBucket);
             return &(it->second.value);
         }
         return nullptr;
@@ -581,13 +648,14 @@ public:
     /// put value
     void put(const K& key, const V& value)
     {
-        auto res = entryMap.insert({ key, Entry{ 0, 0, value } });
+        auto res = entryMap.insert({ key, Entry{ value, noBucket, nullptr, nullptr } });
+        EntryNode* node = &*res.first;
         if (!res.second)
         {
-            removeFromSortedEntries(res.first->second.sortedPos); // remove old value
+            unlinkEntry(node); // remove old value
             // update value
-            totalWeight -= res.first->second.value.weight();
-            res.first->second = Entry{ 0, 0, value };
+            totalWeight -= node->second.value.weight();
+            node->second.value = value;
         }
         const size_t elemWeight = value.weight();
         
@@ -597,14 +665,16 @@ public:
         
         while (totalWeight+elemWeight > maxWeight)
         {
-            // remove min usage element
-            auto minUsageIt = sortedEntries.back();
-            sortedEntries.pop_back();
-            totalWeight -= minUsageIt->second.value.weight();
-            entryMap.erase(minUsageIt);
+            // remove min usage element (most recently used from them)
+            EntryNode* minUsageNode = buckets[firstBucket].last;
+            unlinkEntry(minUsageNode);
+            totalWeight -= minUsageNode->second.value.weight();
+            // erase by iterator (key is owned by node that will be destroyed)
+            entryMap.erase(entryMap.find(minUsageNode->first));
         }
         
-        insertToSortedEntries(res.first); // new entry in sorted entries
+        // new entry in bucket with zero usage
+        linkEntry(node, getBucketAfter(noBucket, 0));
         
         totalWeight += elemWeight;
     }
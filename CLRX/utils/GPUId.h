@@ -163,7 +163,8 @@ enum: Flags {
     REGCOUNT_NO_VCC = 1,
     REGCOUNT_NO_FLAT = 2,
     REGCOUNT_NO_XNACK = 4,
-    REGCOUNT_NO_EXTRA = 0xffff
+    REGCOUNT_NO_EXTRA = 0xffff,
+    REGCOUNT_WAVE32 = 0x10000
 };
 
 enum: cxuint {
@@ -218,6 +219,20 @@ extern size_t getGPUMaxGDSSize(GPUArchitecture architecture);
 extern cxuint getGPUExtraRegsNum(GPUArchitecture architecture, cxuint regType,
               Flags flags);
 
+/// get maximum number of waves per SIMD
+extern cxuint getGPUMaxWavesPerSIMD(GPUArchitecture architecture);
+
+/// get maximum available registers for GPU that allows given waves per SIMD
+/** flags have this same meaning as in getGPUMaxRegistersNum, for GCN1.5
+ * REGCOUNT_WAVE32 choose wave32 (wave64 uses twice register file per wave) */
+extern cxuint getGPUMaxRegsNumForWaves(GPUArchitecture architecture, cxuint regType,
+              cxuint wavesNum, Flags flags = 0);
+
+/// get number of waves per SIMD that can be run with given number of registers
+/** flags have this same meaning as in getGPUMaxRegsNumForWaves */
+extern cxuint getGPUWavesNumForRegsNum(GPUArchitecture architecture, cxuint regType,
+              cxuint regsNum, Flags flags = 0);
+
 /// structure helper for AMDGPU architecture version
 struct AMDGPUArchVersion
 {
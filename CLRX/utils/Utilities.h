@@ -32,6 +32,7 @@
 #include <cstdint>
 #include <mutex>
 #include <atomic>
+#include <functional>
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
@@ -778,6 +779,41 @@ extern bool isFileExists(const char* path);
  */
 extern Array<cxbyte> loadDataFromFile(const char* filename);
 
+/// file data mapped into memory
+/** Regular files are mapped privately into memory, hence any change of data
+ * is not visible in file and file is never modified. For other files (pipes, devices)
+ * or if mapping is not supported, data is loaded by loadDataFromFile.
+ * Data is available until destruction of this object.
+ */
+class MappedFileData: public NonCopyableAndNonMovable
+{
+private:
+    size_t dataSize;
+    cxbyte* mappedData;
+    Array<cxbyte> loadedData;
+public:
+    /// constructor - maps or loads file
+    /**
+     * \param filename filename
+     */
+    explicit MappedFileData(const char* filename);
+    /// destructor
+    ~MappedFileData();
+    
+    /// get size of data
+    size_t size() const
+    { return dataSize; }
+    /// get data
+    cxbyte* data()
+    { return (mappedData!=nullptr) ? mappedData : loadedData.data(); }
+    /// get data
+    const cxbyte* data() const
+    { return (mappedData!=nullptr) ? mappedData : loadedData.data(); }
+    /// returns true if data is mapped from file (not loaded)
+    bool isMapped() const
+    { return mappedData!=nullptr; }
+};
+
 /// convert to filesystem from unified path (with slashes)
 extern void filesystemPath(char* path);
 /// convert to filesystem from unified path (with slashes)
@@ -789,6 +825,9 @@ extern std::string joinPaths(const std::string& path1, const std::string& path2)
 /// get file timestamp in nanosecond since Unix epoch
 extern uint64_t getFileTimestamp(const char* filename);
 
+/// get size of file in bytes
+extern uint64_t getFileSize(const char* filename);
+
 /// get user's home directory
 extern std::string getHomeDir();
 /// create directory
@@ -1062,6 +1101,12 @@ inline void callOnce(OnceFlag& flag, Callable&& f, Args&&... args)
 }
 #endif
 
+/// run jobs (0..jobsNum-1) on threadsNum threads (0 - all hardware threads)
+/** current thread is also a worker. If any job throws exception, then
+ * an exception from first failed job (in order of jobs) will be rethrown */
+extern void runParallelJobs(size_t jobsNum, cxuint threadsNum,
+            const std::function<void(size_t)>& job);
+
 };
 
 #endif
@@ -36,7 +36,7 @@
 using namespace CLRX;
 
 // all AmdCL2 pseudo-op names (sorted)
-static const char* amdCL2PseudoOpNamesTbl[] =
+const char* CLRX::amdCL2PseudoOpNamesTbl[] =
 {
     "acl_version", "arch_minor", "arch_stepping",
     "arg", "bssdata", "call_convention", "codeversion",
@@ -73,6 +73,8 @@ static const char* amdCL2PseudoOpNamesTbl[] =
     "workitem_vgpr_count"
 };
 
+const size_t CLRX::amdCL2PseudoOpNamesTblSize = sizeof(amdCL2PseudoOpNamesTbl)/sizeof(char*);
+
 // all enums for AmdCL2 pseudo-ops
 enum
 {
@@ -453,10 +455,7 @@ bool AsmAmdCL2PseudoOps::checkPseudoOpName(const CString& string)
 {
     if (string.empty() || string[0] != '.')
         return false;
-    const size_t pseudoOp = binaryFind(amdCL2PseudoOpNamesTbl, amdCL2PseudoOpNamesTbl +
-                sizeof(amdCL2PseudoOpNamesTbl)/sizeof(char*), string.c_str()+1,
-               CStringLess()) - amdCL2PseudoOpNamesTbl;
-    return pseudoOp < sizeof(amdCL2PseudoOpNamesTbl)/sizeof(char*);
+    return getAsmPseudoOp(string.c_str()+1, ASMPOKIND_AMDCL2) != ASMPOP_NONE;
 }
 
 void AsmAmdCL2PseudoOps::setAclVersion(AsmAmdCL2Handler& handler, const char* linePtr)
@@ -1496,9 +1495,7 @@ void AsmAmdCL2PseudoOps::doHSALayout(AsmAmdCL2Handler& handler, const char* pseu
 bool AsmAmdCL2Handler::parsePseudoOp(const CString& firstName,
        const char* stmtPlace, const char* linePtr)
 {
-    const size_t pseudoOp = binaryFind(amdCL2PseudoOpNamesTbl, amdCL2PseudoOpNamesTbl +
-                    sizeof(amdCL2PseudoOpNamesTbl)/sizeof(char*), firstName.c_str()+1,
-                   CStringLess()) - amdCL2PseudoOpNamesTbl;
+    const cxuint pseudoOp = getAsmPseudoOp(firstName.c_str()+1, ASMPOKIND_AMDCL2);
     
     switch(pseudoOp)
     {
@@ -108,6 +108,10 @@ enum AmdCL2ConfigValueTarget
     AMDCL2CVAL_PGMRSRC2 = AMDCL2CVAL_HSA_PGMRSRC2
 };
 
+// all AMD OpenCL 2.0 pseudo-op names (sorted)
+extern const char* amdCL2PseudoOpNamesTbl[] CLRX_INTERNAL;
+extern const size_t amdCL2PseudoOpNamesTblSize CLRX_INTERNAL;
+
 struct CLRX_INTERNAL AsmAmdCL2PseudoOps: AsmPseudoOps
 {
     static bool checkPseudoOpName(const CString& string);
@@ -32,7 +32,7 @@
 using namespace CLRX;
 
 // all AMD Catalyst pseudo-op names (sorted)
-static const char* amdPseudoOpNamesTbl[] =
+const char* CLRX::amdPseudoOpNamesTbl[] =
 {
     "arg", "boolconsts", "calnote", "cbid",
     "cbmask", "compile_options", "condout", "config",
@@ -50,6 +50,8 @@ static const char* amdPseudoOpNamesTbl[] =
     "useprintf", "userdata", "vgprsnum"
 };
 
+const size_t CLRX::amdPseudoOpNamesTblSize = sizeof(amdPseudoOpNamesTbl)/sizeof(char*);
+
 // all AMD Catalyst pseudo-op names (sorted)
 enum
 {
@@ -290,10 +292,7 @@ bool AsmAmdPseudoOps::checkPseudoOpName(const CString& string)
 {
     if (string.empty() || string[0] != '.')
         return false;
-    const size_t pseudoOp = binaryFind(amdPseudoOpNamesTbl, amdPseudoOpNamesTbl +
-                sizeof(amdPseudoOpNamesTbl)/sizeof(char*), string.c_str()+1,
-               CStringLess()) - amdPseudoOpNamesTbl;
-    return pseudoOp < sizeof(amdPseudoOpNamesTbl)/sizeof(char*);
+    return getAsmPseudoOp(string.c_str()+1, ASMPOKIND_AMD) != ASMPOP_NONE;
 }
 
 void AsmAmdPseudoOps::setCompileOptions(AsmAmdHandler& handler, const char* linePtr)
@@ -1505,9 +1504,7 @@ void AsmAmdPseudoOps::doArg(AsmAmdHandler& handler, const char* pseudoOpPlace,
 bool AsmAmdHandler::parsePseudoOp(const CString& firstName,
        const char* stmtPlace, const char* linePtr)
 {
-    const size_t pseudoOp = binaryFind(amdPseudoOpNamesTbl, amdPseudoOpNamesTbl +
-                    sizeof(amdPseudoOpNamesTbl)/sizeof(char*), firstName.c_str()+1,
-                   CStringLess()) - amdPseudoOpNamesTbl;
+    const cxuint pseudoOp = getAsmPseudoOp(firstName.c_str()+1, ASMPOKIND_AMD);
     
     switch(pseudoOp)
     {
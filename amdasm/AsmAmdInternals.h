@@ -57,6 +57,10 @@ enum AmdConfigValueTarget
     AMDCVAL_EXCEPTIONS
 };
 
+// all AMD pseudo-op names (sorted)
+extern const char* amdPseudoOpNamesTbl[] CLRX_INTERNAL;
+extern const size_t amdPseudoOpNamesTblSize CLRX_INTERNAL;
+
 struct CLRX_INTERNAL AsmAmdPseudoOps: AsmPseudoOps
 {
     static bool checkPseudoOpName(const CString& string);
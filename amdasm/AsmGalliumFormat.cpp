@@ -36,7 +36,7 @@
 using namespace CLRX;
 
 // all Gallium pseudo-op names (sorted)
-static const char* galliumPseudoOpNamesTbl[] =
+const char* CLRX::galliumPseudoOpNamesTbl[] =
 {
     "arch_minor", "arch_stepping",
     "arg", "args", "call_convention", "codeversion",
@@ -79,6 +79,8 @@ static const char* galliumPseudoOpNamesTbl[] =
     "workitem_private_segment_size", "workitem_vgpr_count"
 };
 
+const size_t CLRX::galliumPseudoOpNamesTblSize = sizeof(galliumPseudoOpNamesTbl)/sizeof(char*);
+
 // all enums for Gallium pseudo-ops
 enum
 {
@@ -346,10 +348,7 @@ bool AsmGalliumPseudoOps::checkPseudoOpName(const CString& string)
 {
     if (string.empty() || string[0] != '.')
         return false;
-    const size_t pseudoOp = binaryFind(galliumPseudoOpNamesTbl, galliumPseudoOpNamesTbl +
-                sizeof(galliumPseudoOpNamesTbl)/sizeof(char*), string.c_str()+1,
-               CStringLess()) - galliumPseudoOpNamesTbl;
-    return pseudoOp < sizeof(galliumPseudoOpNamesTbl)/sizeof(char*);
+    return getAsmPseudoOp(string.c_str()+1, ASMPOKIND_GALLIUM) != ASMPOP_NONE;
 }
 
 void AsmGalliumPseudoOps::setArchMinor(AsmGalliumHandler& handler, const char* linePtr)
@@ -1099,9 +1098,7 @@ void AsmGalliumPseudoOps::scratchSymbol(AsmGalliumHandler& handler, const char*
 bool AsmGalliumHandler::parsePseudoOp(const CString& firstName,
            const char* stmtPlace, const char* linePtr)
 {
-    const size_t pseudoOp = binaryFind(galliumPseudoOpNamesTbl, galliumPseudoOpNamesTbl +
-                    sizeof(galliumPseudoOpNamesTbl)/sizeof(char*), firstName.c_str()+1,
-                   CStringLess()) - galliumPseudoOpNamesTbl;
+    const cxuint pseudoOp = getAsmPseudoOp(firstName.c_str()+1, ASMPOKIND_GALLIUM);
     
     switch(pseudoOp)
     {
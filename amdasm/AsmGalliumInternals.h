@@ -103,6 +103,10 @@ enum GalliumConfigValueTarget
     GALLIUMCVAL_HSA_FIRST_PARAM = GALLIUMCVAL_HSA_SGPRSNUM
 };
 
+// all Gallium pseudo-op names (sorted)
+extern const char* galliumPseudoOpNamesTbl[] CLRX_INTERNAL;
+extern const size_t galliumPseudoOpNamesTblSize CLRX_INTERNAL;
+
 struct CLRX_INTERNAL AsmGalliumPseudoOps: AsmPseudoOps
 {
     static bool checkPseudoOpName(const CString& string);
@@ -22,6 +22,7 @@
 
 #include <CLRX/Config.h>
 #include <cstdint>
+#include <climits>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -326,6 +327,8 @@ struct CLRX_INTERNAL AsmPseudoOps: AsmParseUtils
     static void doEnum(Assembler& asmr, const char* linePtr);
     // set policy version
     static void setPolicyVersion(Assembler& asmr, const char* linePtr);
+    // set occupancy targeted by register allocator
+    static void setRegAllocOccupancy(Assembler& asmr, const char* linePtr);
     
     static void ignoreString(Assembler& asmr, const char* linePtr);
     
@@ -378,6 +381,45 @@ struct CLRX_INTERNAL AsmKcodePseudoOps : AsmParseUtils
         GOOD = false; \
     }
 
+/* pseudo-op dispatch table - single hash table that holds all pseudo-ops
+ * (main, used while skipping clauses, used in macro content and format specific) */
+
+/// kind of pseudo-op table
+enum : cxuint
+{
+    ASMPOKIND_MAIN = 0,     ///< main pseudo-ops
+    ASMPOKIND_OFFLINE,      ///< pseudo-ops used while skipping clauses
+    ASMPOKIND_MACROREPEAT,  ///< pseudo-ops not ignored while putting macro content
+    ASMPOKIND_GALLIUM,      ///< Gallium format pseudo-ops
+    ASMPOKIND_AMD,          ///< AMD Catalyst format pseudo-ops
+    ASMPOKIND_AMDCL2,       ///< AMD OpenCL 2.0 format pseudo-ops
+    ASMPOKIND_ROCM,         ///< ROCm format pseudo-ops
+    ASMPOKIND_MAX
+};
+
+/// pseudo-op does not exist in table
+static const cxuint ASMPOP_NONE = UINT_MAX;
+
+/// entry of pseudo-op dispatch table
+struct CLRX_INTERNAL AsmPseudoOpEntry
+{
+    const char* name;   ///< name without dot
+    cxuint ops[ASMPOKIND_MAX];  ///< pseudo-op id in every kind of table
+};
+
+/// initialize pseudo-op dispatch table (must be called before any lookup)
+extern CLRX_INTERNAL void initializeAsmPseudoOps();
+
+/// find pseudo-op (name without dot), returns null if not found
+extern CLRX_INTERNAL const AsmPseudoOpEntry* findAsmPseudoOp(const char* name);
+
+/// get pseudo-op id (name without dot) for kind of table
+inline cxuint getAsmPseudoOp(const char* name, cxuint kind)
+{
+    const AsmPseudoOpEntry* entry = findAsmPseudoOp(name);
+    return (entry!=nullptr) ? entry->ops[kind] : ASMPOP_NONE;
+}
+
 extern CLRX_INTERNAL cxbyte cstrtobyte(const char*& str, const char* end);
 
 extern const cxbyte tokenCharTable[96] CLRX_INTERNAL;
@@ -18,7 +18,10 @@
  */
 
 #include <CLRX/Config.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <utility>
 #include <CLRX/utils/Utilities.h>
@@ -110,12 +113,12 @@ static const char* pseudoOpNamesTbl[] =
     "iflt", "ifnarch", "ifnb", "ifnc", "ifndef",
     "ifne", "ifnes", "ifnfmt", "ifngpu", "ifnotdef", "incbin",
     "include", "int", "irp", "irpc", "kernel", "lflags",
-    "line", "ln", "local", "long",
+    "line", "linearscan", "ln", "local", "long",
     "macro", "macrocase", "main", "noaltmacro",
-    "nobuggyfplit", "nomacrocase", "nooldmodparam",
+    "nobuggyfplit", "nolinearscan", "nomacrocase", "nooldmodparam",
     "nowave32", "octa", "offset", "oldmodparam", "org",
     "p2align", "policy", "print", "purgem", "quad",
-    "rawcode", "regvar", "rept", "rocm", "rodata",
+    "rawcode", "regalloc_occupancy", "regvar", "rept", "rocm", "rodata",
     "rvlin", "rvlin_once", "sbttl", "scope", "section", "set",
     "short", "single", "size", "skip",
     "space", "string", "string16", "string32",
@@ -153,12 +156,14 @@ enum
     ASMOP_IFLT, ASMOP_IFNARCH, ASMOP_IFNB, ASMOP_IFNC, ASMOP_IFNDEF,
     ASMOP_IFNE, ASMOP_IFNES, ASMOP_IFNFMT, ASMOP_IFNGPU, ASMOP_IFNOTDEF, ASMOP_INCBIN,
     ASMOP_INCLUDE, ASMOP_INT, ASMOP_IRP, ASMOP_IRPC, ASMOP_KERNEL, ASMOP_LFLAGS,
-    ASMOP_LINE, ASMOP_LN, ASMOP_LOCAL, ASMOP_LONG,
+    ASMOP_LINE, ASMOP_LINEARSCAN, ASMOP_LN, ASMOP_LOCAL, ASMOP_LONG,
     ASMOP_MACRO, ASMOP_MACROCASE, ASMOP_MAIN, ASMOP_NOALTMACRO,
-    ASMOP_NOBUGGYFPLIT, ASMOP_NOMACROCASE, ASMOP_NOOLDMODPARAM,
-    ASMOP_NOWAVE32, ASMOP_OCTA, ASMOP_OFFSET, ASMOP_OLDMODPARAM, ASMOP_ORG,
+    ASMOP_NOBUGGYFPLIT, ASMOP_NOLINEARSCAN, ASMOP_NOMACROCASE, ASMOP_NOOLDMODPARAM,
+    ASMOP_NOWAVE32, ASMOP_OCTA, ASMOP_OFFSET, ASMOP_OLDMODPARAM,
+    ASMOP_ORG,
     ASMOP_P2ALIGN, ASMOP_POLICY, ASMOP_PRINT, ASMOP_PURGEM, ASMOP_QUAD,
-    ASMOP_RAWCODE, ASMOP_REGVAR, ASMOP_REPT, ASMOP_ROCM, ASMOP_RODATA,
+    ASMOP_RAWCODE, ASMOP_REGALLOC_OCCUPANCY, ASMOP_REGVAR, ASMOP_REPT, ASMOP_ROCM,
+    ASMOP_RODATA,
     ASMOP_RVLIN, ASMOP_RVLIN_ONCE, ASMOP_SBTTL, ASMOP_SCOPE, ASMOP_SECTION, ASMOP_SET,
     ASMOP_SHORT, ASMOP_SINGLE, ASMOP_SIZE, ASMOP_SKIP,
     ASMOP_SPACE, ASMOP_STRING, ASMOP_STRING16, ASMOP_STRING32,
@@ -167,29 +172,102 @@ enum
     ASMOP_WARNING, ASMOP_WAVE32, ASMOP_WEAK, ASMOP_WHILE, ASMOP_WORD
 };
 
+/* pseudo-op dispatch table (open addressing with linear probing) */
+
+static OnceFlag asmPseudoOpsOnceFlag;
+static Array<AsmPseudoOpEntry> asmPseudoOpEntries;
+static Array<cxuint> asmPseudoOpHashTable; // indices to entries
+static size_t asmPseudoOpHashMask = 0;
+
+// FNV-1a hash
+static inline uint32_t asmPseudoOpHash(const char* name)
+{
+    uint32_t hash = 2166136261U;
+    for (; *name!=0; name++)
+        hash = (hash ^ cxbyte(*name)) * 16777619U;
+    return hash;
+}
+
+static void initializeAsmPseudoOpsInt()
+{
+    const struct { const char** names; size_t namesNum; } pseudoOpTables[ASMPOKIND_MAX] =
+    {
+        { pseudoOpNamesTbl, sizeof(pseudoOpNamesTbl)/sizeof(char*) },
+        { offlinePseudoOpNamesTbl, sizeof(offlinePseudoOpNamesTbl)/sizeof(char*) },
+        { macroRepeatPseudoOpNamesTbl,
+                sizeof(macroRepeatPseudoOpNamesTbl)/sizeof(char*) },
+        { galliumPseudoOpNamesTbl, galliumPseudoOpNamesTblSize },
+        { amdPseudoOpNamesTbl, amdPseudoOpNamesTblSize },
+        { amdCL2PseudoOpNamesTbl, amdCL2PseudoOpNamesTblSize },
+        { rocmPseudoOpNamesTbl, rocmPseudoOpNamesTblSize }
+    };
+    // merge all tables (by name)
+    std::vector<AsmPseudoOpEntry> entries;
+    for (cxuint kind = 0; kind < ASMPOKIND_MAX; kind++)
+        for (size_t i = 0; i < pseudoOpTables[kind].namesNum; i++)
+        {
+            const char* name = pseudoOpTables[kind].names[i];
+            entries.push_back({ name, { } });
+            std::fill(entries.back().ops, entries.back().ops+ASMPOKIND_MAX, ASMPOP_NONE);
+            entries.back().ops[kind] = i;
+        }
+    std::stable_sort(entries.begin(), entries.end(),
+            [](const AsmPseudoOpEntry& e1, const AsmPseudoOpEntry& e2)
+            { return ::strcmp(e1.name, e2.name) < 0; });
+    size_t j = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+        if (j != 0 && ::strcmp(entries[j-1].name, entries[i].name) == 0)
+        {
+            for (cxuint kind = 0; kind < ASMPOKIND_MAX; kind++)
+                if (entries[i].ops[kind] != ASMPOP_NONE)
+                    entries[j-1].ops[kind] = entries[i].ops[kind];
+        }
+        else
+            entries[j++] = entries[i];
+    asmPseudoOpEntries.assign(entries.begin(), entries.begin()+j);
+    
+    // fill hash table (load factor is lower than 0.5)
+    size_t tableSize = 1;
+    while (tableSize < (j<<1)) tableSize <<= 1;
+    asmPseudoOpHashMask = tableSize-1;
+    asmPseudoOpHashTable.resize(tableSize);
+    std::fill(asmPseudoOpHashTable.begin(), asmPseudoOpHashTable.end(), ASMPOP_NONE);
+    for (size_t i = 0; i < j; i++)
+    {
+        size_t pos = asmPseudoOpHash(asmPseudoOpEntries[i].name) & asmPseudoOpHashMask;
+        while (asmPseudoOpHashTable[pos] != ASMPOP_NONE)
+            pos = (pos+1) & asmPseudoOpHashMask;
+        asmPseudoOpHashTable[pos] = i;
+    }
+}
+
 namespace CLRX
 {
 
+void initializeAsmPseudoOps()
+{
+    callOnce(asmPseudoOpsOnceFlag, initializeAsmPseudoOpsInt);
+}
+
+const AsmPseudoOpEntry* findAsmPseudoOp(const char* name)
+{
+    size_t pos = asmPseudoOpHash(name) & asmPseudoOpHashMask;
+    for (; asmPseudoOpHashTable[pos] != ASMPOP_NONE; pos = (pos+1) & asmPseudoOpHashMask)
+    {
+        const AsmPseudoOpEntry& entry = asmPseudoOpEntries[asmPseudoOpHashTable[pos]];
+        if (::strcmp(entry.name, name) == 0)
+            return &entry;
+    }
+    return nullptr;
+}
+
 // checking whether name is pseudo-op name
 // (checking any extra pseudo-op provided by format handler)
 bool AsmPseudoOps::checkPseudoOpName(const CString& string)
 {
     if (string.empty() || string[0] != '.')
         return false;
-    const size_t pseudoOp = binaryFind(pseudoOpNamesTbl, pseudoOpNamesTbl +
-                    sizeof(pseudoOpNamesTbl)/sizeof(char*), string.c_str()+1,
-                   CStringLess()) - pseudoOpNamesTbl;
-    if (pseudoOp < sizeof(pseudoOpNamesTbl)/sizeof(char*))
-        return true;
-    if (AsmGalliumPseudoOps::checkPseudoOpName(string))
-        return true;
-    if (AsmAmdPseudoOps::checkPseudoOpName(string))
-        return true;
-    if (AsmAmdCL2PseudoOps::checkPseudoOpName(string))
-        return true;
-    if (AsmROCmPseudoOps::checkPseudoOpName(string))
-        return true;
-    return false;
+    return findAsmPseudoOp(string.c_str()+1) != nullptr;
 }
 
 };
@@ -198,9 +276,9 @@ bool AsmPseudoOps::checkPseudoOpName(const CString& string)
 void Assembler::parsePseudoOps(const CString& firstName,
        const char* stmtPlace, const char* linePtr)
 {
-    const size_t pseudoOp = binaryFind(pseudoOpNamesTbl, pseudoOpNamesTbl +
-                    sizeof(pseudoOpNamesTbl)/sizeof(char*), firstName.c_str()+1,
-                   CStringLess()) - pseudoOpNamesTbl;
+    const AsmPseudoOpEntry* pseudoOpEntry = findAsmPseudoOp(firstName.c_str()+1);
+    const cxuint pseudoOp = (pseudoOpEntry!=nullptr) ?
+                pseudoOpEntry->ops[ASMPOKIND_MAIN] : ASMPOP_NONE;
     
     switch(pseudoOp)
     {
@@ -582,6 +660,10 @@ void Assembler::parsePseudoOps(const CString& firstName,
         case ASMOP_LN:
             printWarning(stmtPlace, "'.line' is ignored by this assembler.");
             break;
+        case ASMOP_LINEARSCAN:
+            if (AsmPseudoOps::checkGarbagesAtEnd(*this, linePtr))
+                linearScan = true;
+            break;
         case ASMOP_LOCAL:
             AsmPseudoOps::setSymbolBind(*this, linePtr, STB_LOCAL);
             break;
@@ -603,6 +685,10 @@ void Assembler::parsePseudoOps(const CString& firstName,
             if (AsmPseudoOps::checkGarbagesAtEnd(*this, linePtr))
                 buggyFPLit = false;
             break;
+        case ASMOP_NOLINEARSCAN:
+            if (AsmPseudoOps::checkGarbagesAtEnd(*this, linePtr))
+                linearScan = false;
+            break;
         case ASMOP_NOMACROCASE:
             if (AsmPseudoOps::checkGarbagesAtEnd(*this, linePtr))
                 macroCase = false;
@@ -647,6 +733,9 @@ void Assembler::parsePseudoOps(const CString& firstName,
         case ASMOP_QUAD:
             AsmPseudoOps::putIntegers<uint64_t>(*this, stmtPlace, linePtr);
             break;
+        case ASMOP_REGALLOC_OCCUPANCY:
+            AsmPseudoOps::setRegAllocOccupancy(*this, linePtr);
+            break;
         case ASMOP_REGVAR:
             AsmPseudoOps::defRegVar(*this, linePtr);
             break;
@@ -738,10 +827,14 @@ void Assembler::parsePseudoOps(const CString& firstName,
             break;
         default:
         {
-            bool isGalliumPseudoOp = AsmGalliumPseudoOps::checkPseudoOpName(firstName);
-            bool isAmdPseudoOp = AsmAmdPseudoOps::checkPseudoOpName(firstName);
-            bool isAmdCL2PseudoOp = AsmAmdCL2PseudoOps::checkPseudoOpName(firstName);
-            bool isROCmPseudoOp = AsmROCmPseudoOps::checkPseudoOpName(firstName);
+            bool isGalliumPseudoOp = pseudoOpEntry!=nullptr &&
+                    pseudoOpEntry->ops[ASMPOKIND_GALLIUM] != ASMPOP_NONE;
+            bool isAmdPseudoOp = pseudoOpEntry!=nullptr &&
+                    pseudoOpEntry->ops[ASMPOKIND_AMD] != ASMPOP_NONE;
+            bool isAmdCL2PseudoOp = pseudoOpEntry!=nullptr &&
+                    pseudoOpEntry->ops[ASMPOKIND_AMDCL2] != ASMPOP_NONE;
+            bool isROCmPseudoOp = pseudoOpEntry!=nullptr &&
+                    pseudoOpEntry->ops[ASMPOKIND_ROCM] != ASMPOP_NONE;
             if (isGalliumPseudoOp || isAmdPseudoOp || isAmdCL2PseudoOp || isROCmPseudoOp)
             {
                 // initialize only if gallium pseudo-op or AMD pseudo-op
@@ -831,9 +924,8 @@ bool Assembler::skipClauses(bool exitm)
         CString pseudoOpName = extractSymName(linePtr, end, false);
         toLowerString(pseudoOpName);
         
-        const size_t pseudoOp = binaryFind(offlinePseudoOpNamesTbl,
-               offlinePseudoOpNamesTbl + sizeof(offlinePseudoOpNamesTbl)/sizeof(char*),
-               pseudoOpName.c_str()+1, CStringLess()) - offlinePseudoOpNamesTbl;
+        const cxuint pseudoOp = getAsmPseudoOp(pseudoOpName.c_str()+1,
+                    ASMPOKIND_OFFLINE);
         
         // any conditional inside macro or repeat will be ignored
         bool insideMacroOrRepeat = !clauses.empty() && 
@@ -982,10 +1074,8 @@ bool Assembler::putMacroContent(RefPtr<AsmMacro> macro)
         CString pseudoOpName = extractSymName(linePtr, end, false);
         toLowerString(pseudoOpName);
         
-        const size_t pseudoOp = binaryFind(macroRepeatPseudoOpNamesTbl,
-               macroRepeatPseudoOpNamesTbl + sizeof(macroRepeatPseudoOpNamesTbl) /
-               sizeof(char*), pseudoOpName.c_str()+1, CStringLess()) -
-               macroRepeatPseudoOpNamesTbl;
+        const cxuint pseudoOp = getAsmPseudoOp(pseudoOpName.c_str()+1,
+                    ASMPOKIND_MACROREPEAT);
         // handle pseudo-op in macro content
         switch(pseudoOp)
         {
@@ -1020,6 +1110,9 @@ bool Assembler::putMacroContent(RefPtr<AsmMacro> macro)
                   currentInputFilter->getSource(),
                   currentInputFilter->getColTranslations(), lineSize, line);
     }
+    if (good)
+        // prepare content for fast substitution
+        macro->compile();
     return good;
 }
 
@@ -1051,10 +1144,8 @@ bool Assembler::putRepetitionContent(AsmRepeat& repeat)
         
         CString pseudoOpName = extractSymName(linePtr, end, false);
         toLowerString(pseudoOpName);
-        const size_t pseudoOp = binaryFind(macroRepeatPseudoOpNamesTbl,
-               macroRepeatPseudoOpNamesTbl + sizeof(macroRepeatPseudoOpNamesTbl) /
-               sizeof(char*), pseudoOpName.c_str()+1, CStringLess()) -
-               macroRepeatPseudoOpNamesTbl;
+        const cxuint pseudoOp = getAsmPseudoOp(pseudoOpName.c_str()+1,
+                    ASMPOKIND_MACROREPEAT);
         // handle pseudo-op in macro content
         switch(pseudoOp)
         {
@@ -396,6 +396,7 @@ void AsmPseudoOps::includeBinFile(Assembler& asmr, const char* pseudoOpPlace,
     std::ifstream ifs;
     sysfilename = filename;
     filesystemPath(sysfilename);
+    std::string openedFilename = sysfilename;
     // try in this directory
     ifs.open(sysfilename.c_str(), std::ios::binary);
     if (!ifs)
@@ -405,7 +406,8 @@ void AsmPseudoOps::includeBinFile(Assembler& asmr, const char* pseudoOpPlace,
         {
             std::string incDirPath(incDir.c_str());
             filesystemPath(incDirPath);
-            ifs.open(joinPaths(incDirPath.c_str(), sysfilename).c_str(), std::ios::binary);
+            openedFilename = joinPaths(incDirPath.c_str(), sysfilename);
+            ifs.open(openedFilename.c_str(), std::ios::binary);
             if (ifs)
                 break;
         }
@@ -413,6 +415,7 @@ void AsmPseudoOps::includeBinFile(Assembler& asmr, const char* pseudoOpPlace,
     if (!ifs)
         ASM_RETURN_BY_ERROR(namePlace, (std::string("Binary file '") + filename +
                     "' not found or unavailable in any directory").c_str())
+    asmr.includedFiles.push_back(openedFilename.c_str());
     // exception for checking file seeking
     bool seekingIsWorking = true;
     ifs.exceptions(std::ios::badbit | std::ios::failbit); // exceptions
@@ -2267,6 +2270,30 @@ void AsmPseudoOps::setPolicyVersion(Assembler& asmr, const char* linePtr)
     asmr.setPolicyVersion(value);
 }
 
+void AsmPseudoOps::setRegAllocOccupancy(Assembler& asmr, const char* linePtr)
+{
+    const char* end = asmr.line + asmr.lineSize;
+    skipSpacesToEnd(linePtr, end);
+    uint64_t value = 0;
+    const char* valuePlace = linePtr;
+    if (!getAbsoluteValueArg(asmr, value, linePtr, true))
+        return;
+    if (!checkGarbagesAtEnd(asmr, linePtr))
+        return;
+    
+    const cxuint maxWavesNum = getGPUMaxWavesPerSIMD(
+                getGPUArchitectureFromDeviceType(asmr.deviceType));
+    if (value > maxWavesNum)
+    {
+        char buf[64];
+        snprintf(buf, 64, "Occupancy out of range (0-%u)", maxWavesNum);
+        asmr.printError(valuePlace, buf);
+        return;
+    }
+    asmr.setRegAllocOccupancy(value);
+    asmr.regAllocOccupancyPos = asmr.getSourcePos(valuePlace);
+}
+
 void AsmPseudoOps::ignoreString(Assembler& asmr, const char* linePtr)
 {
     const char* end = asmr.line+asmr.lineSize;
@@ -34,7 +34,7 @@
 using namespace CLRX;
 
 // all ROCm pseudo-op names (sorted)
-static const char* rocmPseudoOpNamesTbl[] =
+const char* CLRX::rocmPseudoOpNamesTbl[] =
 {
     "arch_minor", "arch_stepping", "arg",
     "call_convention", "codeversion", "config",
@@ -74,6 +74,8 @@ static const char* rocmPseudoOpNamesTbl[] =
     "workitem_vgpr_count"
 };
 
+const size_t CLRX::rocmPseudoOpNamesTblSize = sizeof(rocmPseudoOpNamesTbl)/sizeof(char*);
+
 // all enums for ROCm pseudo-ops
 enum
 {
@@ -363,10 +365,7 @@ bool AsmROCmPseudoOps::checkPseudoOpName(const CString& string)
 {
     if (string.empty() || string[0] != '.')
         return false;
-    const size_t pseudoOp = binaryFind(rocmPseudoOpNamesTbl, rocmPseudoOpNamesTbl +
-                sizeof(rocmPseudoOpNamesTbl)/sizeof(char*), string.c_str()+1,
-               CStringLess()) - rocmPseudoOpNamesTbl;
-    return pseudoOp < sizeof(rocmPseudoOpNamesTbl)/sizeof(char*);
+    return getAsmPseudoOp(string.c_str()+1, ASMPOKIND_ROCM) != ASMPOP_NONE;
 }
 
 void AsmROCmPseudoOps::setArchMinor(AsmROCmHandler& handler, const char* linePtr)
@@ -1945,9 +1944,7 @@ void AsmROCmPseudoOps::addGotSymbol(AsmROCmHandler& handler,
 bool AsmROCmHandler::parsePseudoOp(const CString& firstName, const char* stmtPlace,
                const char* linePtr)
 {
-    const size_t pseudoOp = binaryFind(rocmPseudoOpNamesTbl, rocmPseudoOpNamesTbl +
-                    sizeof(rocmPseudoOpNamesTbl)/sizeof(char*), firstName.c_str()+1,
-                   CStringLess()) - rocmPseudoOpNamesTbl;
+    const cxuint pseudoOp = getAsmPseudoOp(firstName.c_str()+1, ASMPOKIND_ROCM);
     
     switch(pseudoOp)
     {
@@ -99,6 +99,10 @@ enum ROCmConfigValueTarget
     ROCMCVAL_MAX_FLAT_WORK_GROUP_SIZE
 };
 
+// all ROCm pseudo-op names (sorted)
+extern const char* rocmPseudoOpNamesTbl[] CLRX_INTERNAL;
+extern const size_t rocmPseudoOpNamesTblSize CLRX_INTERNAL;
+
 struct CLRX_INTERNAL AsmROCmPseudoOps: AsmPseudoOps
 {
     static bool checkPseudoOpName(const CString& string);
@@ -21,6 +21,8 @@
 #include <assert.h>
 #include <iostream>
 #include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include <stack>
 #include <deque>
 #include <vector>
@@ -28,6 +30,8 @@
 #include <unordered_set>
 #include <map>
 #include <set>
+#include <queue>
+#include <functional>
 #include <unordered_map>
 #include <algorithm>
 #include <CLRX/utils/Utilities.h>
@@ -48,80 +52,204 @@ std::ostream& operator<<(std::ostream& os, const CLRX::BlockIndex& v)
 }
 #endif
 
+/*
+ * register allocator arena
+ */
+
+static const size_t regAllocArenaBlockSize = 65536;
+
+// arena of current thread (register allocations can be run in many threads)
+static thread_local RegAllocArena* currentRegAllocArena = nullptr;
+
+RegAllocArena::RegAllocArena() : blockPos(nullptr), blockEnd(nullptr)
+{
+    std::fill(freeLists, freeLists + (maxChunkSize/chunkAlign), nullptr);
+}
+
+RegAllocArena::~RegAllocArena()
+{
+    for (char* block: blocks)
+        ::operator delete(block);
+}
+
+void* RegAllocArena::allocateFromNewBlock(size_t size)
+{
+    // rest of the current block is lost
+    char* block = static_cast<char*>(::operator new(regAllocArenaBlockSize));
+    try
+    { blocks.push_back(block); }
+    catch(...)
+    {
+        ::operator delete(block);
+        throw;
+    }
+    blockPos = block + size;
+    blockEnd = block + regAllocArenaBlockSize;
+    return block;
+}
+
+RegAllocArena* RegAllocArena::getCurrent()
+{
+    return currentRegAllocArena;
+}
+
+RegAllocArena* RegAllocArena::setCurrent(RegAllocArena* arena)
+{
+    RegAllocArena* prevArena = currentRegAllocArena;
+    currentRegAllocArena = arena;
+    return prevArena;
+}
+
 ISAUsageHandler::ISAUsageHandler()
 { }
 
 ISAUsageHandler::~ISAUsageHandler()
 { }
 
-void ISAUsageHandler::pushUsage(const AsmRegVarUsage& rvu)
+// every usageIndexStep-th usage of chunk is in index
+static const size_t usageIndexStep = 16;
+
+static inline void putUsageVarUInt(std::vector<cxbyte>& data, size_t value)
 {
-    if (!chunks.empty())
+    while (value >= 0x80)
     {
-        const Chunk& last = chunks.back();
-        
-        if ((last.offsetFirst & ~size_t(0xffff)) != (rvu.offset & ~size_t(0xffff)))
-            // add new chunk
-            chunks.push_back(Chunk{ rvu.offset });
+        data.push_back(cxbyte(value) | 0x80);
+        value >>= 7;
     }
-    else
-        chunks.push_back(Chunk{ rvu.offset });
+    data.push_back(cxbyte(value));
+}
+
+static inline size_t getUsageVarUInt(const cxbyte*& data)
+{
+    // fast path: most of values fits in single byte
+    if (*data < 0x80)
+        return *data++;
+    size_t value = 0;
+    cxuint shift = 0;
+    for (; *data >= 0x80; data++, shift += 7)
+        value |= size_t(*data & 0x7f) << shift;
+    return value | (size_t(*data++) << shift);
+}
+
+void ISAUsageHandler::pushUsage(const AsmRegVarUsage& rvu)
+{
+    if (chunks.empty() ||
+        (chunks.back().offsetFirst & ~size_t(0xffff)) != (rvu.offset & ~size_t(0xffff)))
+        // add new chunk
+        chunks.push_back(Chunk{ rvu.offset, rvu.offset, 0 });
+    Chunk& chunk = chunks.back();
     
+    if ((chunk.itemsNum % usageIndexStep) == 0)
+        chunk.index.push_back(IndexEntry{ uint16_t(rvu.offset & 0xffffU),
+                uint16_t(chunk.lastOffset & 0xffffU), uint32_t(chunk.data.size()) });
+    
+    // regvar index (0 - register)
+    size_t regVarIndex = 0;
+    if (rvu.regVar != nullptr)
+    {
+        auto it = regVarIndices.find(rvu.regVar);
+        if (it == regVarIndices.end())
+        {
+            regVars.push_back(rvu.regVar);
+            it = regVarIndices.insert({ rvu.regVar, regVars.size() }).first;
+        }
+        regVarIndex = it->second;
+    }
+    // zigzag encoded offset delta (offset of usages can be unordered)
+    putUsageVarUInt(chunk.data, rvu.offset >= chunk.lastOffset ?
+            (rvu.offset - chunk.lastOffset)<<1 : ((chunk.lastOffset - rvu.offset)<<1)-1);
+    putUsageVarUInt(chunk.data, regVarIndex);
+    putUsageVarUInt(chunk.data, rvu.rstart);
+    putUsageVarUInt(chunk.data, uint16_t(rvu.rend - rvu.rstart));
     const cxbyte align = rvu.align!=0 ? 32-CLZ32(rvu.align) : 0;
-    chunks.back().items.push_back(RegVarUsageInt{ rvu.regVar, rvu.rstart, rvu.rend, 
-                rvu.regField, rvu.rwFlags, align, rvu.useRegMode,
-                uint16_t(rvu.offset & 0xffffU) });
+    chunk.data.push_back(rvu.regField);
+    chunk.data.push_back((rvu.rwFlags & 3) | (rvu.useRegMode ? 4 : 0) | (align<<3));
+    chunk.lastOffset = rvu.offset;
+    chunk.itemsNum++;
 }
 
-AsmRegVarUsage ISAUsageHandler::nextUsage(ReadPos& readPos)
+AsmRegVarUsage ISAUsageHandler::nextUsage(ReadPos& readPos) const
 {
     const Chunk& chunk = chunks[readPos.chunkPos];
-    const RegVarUsageInt& item = chunk.items[readPos.itemPos];
-    readPos.itemPos++;
+    const cxbyte* data = chunk.data.data() + readPos.itemPos;
+    size_t zdelta, regVarIndex;
+    uint16_t rstart, rend;
+    // usage has at least 6 bytes, check 4 varints at once
+    uint32_t word;
+    ::memcpy(&word, data, 4);
+    if ((word & 0x80808080U) == 0)
+    {
+        // fast path: all varints in single bytes
+        zdelta = data[0];
+        regVarIndex = data[1];
+        rstart = data[2];
+        rend = rstart + data[3];
+        data += 4;
+    }
+    else
+    {
+        zdelta = getUsageVarUInt(data);
+        regVarIndex = getUsageVarUInt(data);
+        rstart = getUsageVarUInt(data);
+        rend = rstart + getUsageVarUInt(data);
+    }
+    const size_t offset = (readPos.itemPos!=0 ? readPos.offset : chunk.offsetFirst) +
+            ((zdelta&1) ? -(zdelta>>1)-1 : (zdelta>>1));
+    const AsmRegField regField = data[0];
+    const cxbyte flags = data[1];
+    data += 2;
+    
+    readPos.itemPos = data - chunk.data.data();
+    readPos.offset = offset;
     // fix itemPos to zero
-    if (readPos.itemPos >= chunk.items.size())
+    if (readPos.itemPos >= chunk.data.size())
     {
         readPos.itemPos = 0;
         readPos.chunkPos++;
     }
-    const cxbyte outAlign = item.align!=0 ? 1U<<(item.align-1) : 0;
-    return AsmRegVarUsage{ (chunk.offsetFirst & ~size_t(0xffffU)) | item.offsetLo,
-            item.regVar, item.rstart, item.rend, item.regField, item.rwFlags,
-            cxbyte(outAlign), item.useRegMode!=0 };
+    const cxbyte align = flags>>3;
+    const cxbyte outAlign = align!=0 ? 1U<<(align-1) : 0;
+    return AsmRegVarUsage{ offset, regVarIndex!=0 ? regVars[regVarIndex-1] : nullptr,
+            rstart, rend, regField, cxbyte(flags&3), outAlign, (flags&4)!=0 };
 }
 
 ISAUsageHandler::ReadPos ISAUsageHandler::findPositionByOffset(size_t offset) const
 {
-    if (chunks.empty())
-        return ReadPos{ 0, 0 };
-    size_t chunkPos = std::lower_bound(chunks.begin(), chunks.end(), Chunk{ offset },
-            [](const Chunk& a, const Chunk& b)
-            { return a.offsetFirst < b.offsetFirst; }) - chunks.begin();
-    // fix - move back if found offset is greater or if end
-    if (chunkPos == chunks.size() ||
-        (chunkPos != 0 && chunks[chunkPos].offsetFirst != offset))
-        chunkPos--;
+    // find last chunk that begins not after offset
+    size_t chunkPos = std::upper_bound(chunks.begin(), chunks.end(), offset,
+            [](size_t a, const Chunk& b)
+            { return a < b.offsetFirst; }) - chunks.begin();
+    if (chunkPos == 0)
+        return ReadPos{ 0, 0, 0 };
+    chunkPos--;
     
-    size_t itemPos = 0;
-    if (chunks[chunkPos].offsetFirst != offset)
-    {
-        const std::vector<RegVarUsageInt>& items = chunks[chunkPos].items;
-        RegVarUsageInt rvu;
-        rvu.offsetLo = uint16_t(offset & 0xffff);
-        size_t itemPos = std::lower_bound(items.begin(), items.end(), rvu,
-                [](const RegVarUsageInt& a, const RegVarUsageInt& b)
-                { return a.offsetLo < b.offsetLo; }) - items.begin();
-        // fix itemPos to zero
-        if (itemPos >= items.size())
+    const Chunk& chunk = chunks[chunkPos];
+    // if offset in the same 64K range, then find first usage not before offset
+    if ((chunk.offsetFirst ^ offset) <= 0xffffU)
+    {
+        const uint16_t offsetLo = offset & 0xffffU;
+        // find last indexed usage before offset and scan usages from it
+        size_t indexPos = std::lower_bound(chunk.index.begin(), chunk.index.end(),
+                offsetLo, [](const IndexEntry& a, uint16_t b)
+                { return a.offsetLo < b; }) - chunk.index.begin();
+        if (indexPos != 0)
+            indexPos--;
+        const size_t offsetHi = chunk.offsetFirst & ~size_t(0xffffU);
+        const IndexEntry& entry = chunk.index[indexPos];
+        ReadPos readPos{ chunkPos, entry.dataPos, offsetHi | entry.prevOffsetLo };
+        while (readPos.chunkPos == chunkPos)
         {
-            chunkPos++;
-            itemPos = 0;
+            ReadPos nextPos = readPos;
+            if (nextUsage(nextPos).offset >= offset)
+                return readPos;
+            readPos = nextPos;
         }
+        return readPos;
     }
-    return ReadPos{ chunkPos, itemPos };
+    // all usages in this chunk are before offset
+    return ReadPos{ chunkPos+1, 0, 0 };
 }
 
-
 ISALinearDepHandler::ISALinearDepHandler()
 { }
 
@@ -142,13 +270,19 @@ ISALinearDepHandler* ISALinearDepHandler::copy() const
  * Asm register allocator stuff
  */
 
-AsmRegAllocator::AsmRegAllocator(Assembler& _assembler) : assembler(_assembler)
-{ }
+AsmRegAllocator::AsmRegAllocator(Assembler& _assembler) : assembler(_assembler),
+        occupancy(0)
+{
+    std::fill(colorsNums, colorsNums+MAX_REGTYPES_NUM, 0);
+}
 
 AsmRegAllocator::AsmRegAllocator(Assembler& _assembler,
         const std::vector<CodeBlock>& _codeBlocks, const SSAReplacesMap& _ssaReplacesMap)
-        : assembler(_assembler), codeBlocks(_codeBlocks), ssaReplacesMap(_ssaReplacesMap)
-{ }
+        : assembler(_assembler), codeBlocks(_codeBlocks), ssaReplacesMap(_ssaReplacesMap),
+          occupancy(0)
+{
+    std::fill(colorsNums, colorsNums+MAX_REGTYPES_NUM, 0);
+}
 
 static inline bool codeBlockStartLess(const AsmRegAllocator::CodeBlock& c1,
                   const AsmRegAllocator::CodeBlock& c2)
@@ -349,7 +483,7 @@ void AsmRegAllocator::applySSAReplaces()
     {
         size_t minSSAId;
         bool visited;
-        std::unordered_set<size_t> nexts;
+        ArenaUnorderedSet<size_t> nexts;
         MinSSAGraphNode() : minSSAId(SIZE_MAX), visited(false)
         { }
     };
@@ -359,12 +493,12 @@ void AsmRegAllocator::applySSAReplaces()
     struct MinSSAGraphStackEntry
     {
         SSAGraphNodesMap::iterator nodeIt;
-        std::unordered_set<size_t>::const_iterator nextIt;
+        ArenaUnorderedSet<size_t>::const_iterator nextIt;
         size_t minSSAId;
         
         MinSSAGraphStackEntry(
                 SSAGraphNodesMap::iterator _nodeIt,
-                std::unordered_set<size_t>::const_iterator _nextIt,
+                ArenaUnorderedSet<size_t>::const_iterator _nextIt,
                 size_t _minSSAId = SIZE_MAX)
                 : nodeIt(_nodeIt), nextIt(_nextIt), minSSAId(_minSSAId)
         { }
@@ -567,60 +701,156 @@ void AsmRegAllocator::applySSAReplaces()
     ssaReplacesMap.clear();
 }
 
-void AsmRegAllocator::createInterferenceGraph()
+void AsmRegAllocator::InterGraph::resize(size_t newNodesNum)
+{
+    nodesNum = newNodesNum;
+    sparse = nodesNum > maxMatrixNodesNum;
+    degrees.resize(nodesNum);
+    std::fill(degrees.begin(), degrees.end(), size_t(0));
+    if (!sparse)
+    {
+        chunks.clear();
+        matrix.resize(((((nodesNum*(nodesNum-1))>>1))+63)>>6);
+        std::fill(matrix.begin(), matrix.end(), uint64_t(0));
+    }
+    else
+    {
+        matrix.clear();
+        chunks.clear();
+        chunks.resize(nodesNum);
+    }
+}
+
+void AsmRegAllocator::InterGraph::clear()
+{
+    nodesNum = 0;
+    sparse = false;
+    matrix.clear();
+    chunks.clear();
+    degrees.clear();
+}
+
+// set bit in sparse bitset, returns true if bit has been set
+static bool setSparseBit(std::vector<AsmRegAllocator::InterGraph::Chunk>& chunks,
+            size_t index)
+{
+    const size_t chunkIndex = index>>6;
+    const uint64_t bit = uint64_t(1)<<(index&63);
+    // chunks are mostly added in ascending order, check last chunk firstly
+    if (chunks.empty() || chunks.back().first < chunkIndex)
+    {
+        chunks.push_back(std::make_pair(chunkIndex, bit));
+        return true;
+    }
+    auto it = std::lower_bound(chunks.begin(), chunks.end(),
+                std::make_pair(chunkIndex, uint64_t(0)));
+    if (it != chunks.end() && it->first == chunkIndex)
+    {
+        if ((it->second & bit) != 0)
+            return false;
+        it->second |= bit;
+        return true;
+    }
+    chunks.insert(it, std::make_pair(chunkIndex, bit));
+    return true;
+}
+
+bool AsmRegAllocator::InterGraph::addEdge(size_t a, size_t b)
+{
+    if (a == b)
+        return false;
+    if (!sparse)
+    {
+        if (a < b)
+            std::swap(a, b);
+        const size_t bit = ((a*(a-1))>>1) + b;
+        uint64_t& word = matrix[bit>>6];
+        const uint64_t mask = uint64_t(1)<<(bit&63);
+        if ((word & mask) != 0)
+            return false;
+        word |= mask;
+    }
+    else
+    {
+        if (!setSparseBit(chunks[a], b))
+            return false;
+        setSparseBit(chunks[b], a);
+    }
+    degrees[a]++;
+    degrees[b]++;
+    return true;
+}
+
+bool AsmRegAllocator::InterGraph::hasEdge(size_t a, size_t b) const
+{
+    if (a == b)
+        return false;
+    if (!sparse)
+    {
+        if (a < b)
+            std::swap(a, b);
+        const size_t bit = ((a*(a-1))>>1) + b;
+        return ((matrix[bit>>6] >> (bit&63)) & 1) != 0;
+    }
+    const std::vector<Chunk>& nodeChunks = chunks[a];
+    const size_t chunkIndex = b>>6;
+    auto it = std::lower_bound(nodeChunks.begin(), nodeChunks.end(),
+                std::make_pair(chunkIndex, uint64_t(0)));
+    return it != nodeChunks.end() && it->first == chunkIndex &&
+            ((it->second >> (b&63)) & 1) != 0;
+}
+
+// construct sorted live blocks from livenesses (livenesses will be cleared)
+static void createLiveBlocks(size_t regTypesNum,
+            Array<AsmRegAllocator::OutLiveness>* outLivenesses,
+            std::vector<LiveBlock>* liveBlockMaps)
 {
-    /// construct liveBlockMaps
-    std::set<LiveBlock> liveBlockMaps[MAX_REGTYPES_NUM];
     for (size_t regType = 0; regType < regTypesNum; regType++)
     {
-        std::set<LiveBlock>& liveBlockMap = liveBlockMaps[regType];
-        Array<OutLiveness>& liveness = outLivenesses[regType];
+        std::vector<LiveBlock>& liveBlockMap = liveBlockMaps[regType];
+        Array<AsmRegAllocator::OutLiveness>& liveness = outLivenesses[regType];
         for (size_t li = 0; li < liveness.size(); li++)
         {
-            OutLiveness& lv = liveness[li];
+            AsmRegAllocator::OutLiveness& lv = liveness[li];
             for (const std::pair<size_t, size_t>& blk: lv)
                 if (blk.first != blk.second)
-                    liveBlockMap.insert({ blk.first, blk.second, li });
+                    liveBlockMap.push_back({ blk.first, blk.second, li });
             lv.clear();
         }
         liveness.clear();
+        std::sort(liveBlockMap.begin(), liveBlockMap.end());
     }
+}
+
+void AsmRegAllocator::createInterferenceGraph()
+{
+    std::vector<LiveBlock> liveBlockMaps[MAX_REGTYPES_NUM];
+    createLiveBlocks(regTypesNum, outLivenesses, liveBlockMaps);
     
     // create interference graphs
     for (size_t regType = 0; regType < regTypesNum; regType++)
     {
         InterGraph& interGraph = interGraphs[regType];
         interGraph.resize(graphVregsCounts[regType]);
-        std::set<LiveBlock>& liveBlockMap = liveBlockMaps[regType];
+        const std::vector<LiveBlock>& liveBlockMap = liveBlockMaps[regType];
         
-        auto lit = liveBlockMap.begin();
-        size_t rangeStart = 0;
-        if (lit != liveBlockMap.end())
-            rangeStart = lit->start;
-        while (lit != liveBlockMap.end())
+        // sweep live blocks in start order, variables whose live blocks overlap
+        // interfere. activeBlocks holds (end, vidx) of blocks live at current start
+        std::vector<std::pair<size_t, size_t> > activeBlocks;
+        for (const LiveBlock& lb: liveBlockMap)
         {
-            const size_t blkStart = lit->start;
-            const size_t blkEnd = lit->end;
-            size_t rangeEnd = blkEnd;
-            auto liStart = liveBlockMap.lower_bound({ rangeStart, 0, 0 });
-            auto liEnd = liveBlockMap.lower_bound({ rangeEnd, 0, 0 });
-            // collect from this range, variable indices
-            std::set<size_t> varIndices;
-            for (auto lit2 = liStart; lit2 != liEnd; ++lit2)
-                varIndices.insert(lit2->vidx);
-            // push to intergraph as full subgGraph
-            for (auto vit = varIndices.begin(); vit != varIndices.end(); ++vit)
-                for (auto vit2 = varIndices.begin(); vit2 != varIndices.end(); ++vit2)
-                    if (vit != vit2)
-                        interGraph[*vit].insert(*vit2);
-            // go to next live blocks
-            rangeStart = rangeEnd;
-            for (; lit != liveBlockMap.end(); ++lit)
-                if (lit->start != blkStart && lit->end != blkEnd)
-                    break;
-            if (lit == liveBlockMap.end())
-                break; // 
-            rangeStart = std::max(rangeStart, lit->start);
+            // remove blocks that ends before this block
+            for (size_t i = 0; i < activeBlocks.size(); )
+                if (activeBlocks[i].first <= lb.start)
+                {
+                    activeBlocks[i] = activeBlocks.back();
+                    activeBlocks.pop_back();
+                }
+                else
+                    i++;
+            for (const std::pair<size_t, size_t>& active: activeBlocks)
+                interGraph.addEdge(lb.vidx, active.second);
+            activeBlocks.push_back(std::make_pair(lb.end, lb.vidx));
         }
     }
 }
@@ -634,6 +864,66 @@ void AsmRegAllocator::createInterferenceGraph()
  *               try to link free ends of two distinct regranges
  */
 
+// get flags to count registers for occupancy (VCC is always counted)
+static inline Flags getOccupancyRegFlags(const Assembler& assembler)
+{
+    return REGCOUNT_NO_VCC |
+            (((assembler.getCodeFlags() & ASM_CODE_WAVE32)!=0) ? REGCOUNT_WAVE32 : 0);
+}
+
+// get number of registers that allows to achieve occupancy
+static cxuint getRegsNumForOccupancy(GPUArchitecture arch, cxuint regType,
+            cxuint wavesNum, Flags regFlags)
+{
+    if (wavesNum == 0)
+        return getGPUMaxRegistersNum(arch, regType, 0);
+    return getGPUMaxRegsNumForWaves(arch, regType, wavesNum, regFlags);
+}
+
+/* iterated greedy recoloring: nodes are visited by color classes from the
+ * last color to first and get first free color. this never increases
+ * number of colors and often decreases it. fixed (real registers) nodes
+ * keep their colors. returns new number of colors */
+static cxuint recolorGraph(const AsmRegAllocator::InterGraph& interGraph,
+            Array<cxuint>& gcMap, const std::vector<bool>& fixedNodes, cxuint colorsNum)
+{
+    const size_t nodesNum = interGraph.size();
+    // nodes sorted by color classes (last color first)
+    std::vector<size_t> order;
+    for (size_t i = 0; i < nodesNum; i++)
+        if (!fixedNodes[i])
+            order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&gcMap](size_t a, size_t b)
+            { return gcMap[a] > gcMap[b]; });
+    
+    Array<cxuint> newGcMap(gcMap);
+    for (size_t node: order)
+        newGcMap[node] = UINT_MAX;
+    
+    cxuint newColorsNum = 0;
+    for (size_t i = 0; i < nodesNum; i++)
+        if (fixedNodes[i])
+            newColorsNum = std::max(newColorsNum, gcMap[i]+1);
+    std::vector<bool> usedColors;
+    for (size_t node: order)
+    {
+        usedColors.assign(newColorsNum+1, false);
+        interGraph.forEachNeighbor(node, [&](size_t nb)
+        {
+            if (newGcMap[nb] != UINT_MAX)
+                usedColors[newGcMap[nb]] = true;
+        });
+        cxuint color = 0;
+        while (usedColors[color])
+            color++;
+        newGcMap[node] = color;
+        newColorsNum = std::max(newColorsNum, color+1);
+    }
+    if (newColorsNum < colorsNum)
+        gcMap = newGcMap;
+    return std::min(newColorsNum, colorsNum);
+}
+
 void AsmRegAllocator::colorInterferenceGraph()
 {
     const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
@@ -642,7 +932,9 @@ void AsmRegAllocator::colorInterferenceGraph()
     for (size_t regType = 0; regType < regTypesNum; regType++)
     {
         const size_t maxColorsNum = getGPUMaxRegistersNum(arch, regType);
-        InterGraph& interGraph = interGraphs[regType];
+        const cxuint colorsBudget = getRegsNumForOccupancy(arch, regType,
+                    assembler.regAllocOccupancy, getOccupancyRegFlags(assembler));
+        const InterGraph& interGraph = interGraphs[regType];
         const VarIndexMap& vregIndexMap = vregIndexMaps[regType];
         Array<cxuint>& gcMap = graphColorMaps[regType];
         
@@ -654,35 +946,58 @@ void AsmRegAllocator::colorInterferenceGraph()
         
         SDOLDOCompare compare(interGraph, sdoCounts);
         std::set<size_t, SDOLDOCompare> nodeSet(compare);
-        for (size_t i = 0; i < nodesNum; i++)
-            nodeSet.insert(i);
+        
+        // bitsets of colors of neighbours for every node
+        const size_t colorWordsNum = (maxColorsNum+63)>>6;
+        Array<uint64_t> nbColors(nodesNum*colorWordsNum);
+        std::fill(nbColors.begin(), nbColors.end(), uint64_t(0));
+        // update SDO for uncolored neighbours of colored node
+        auto updateNeighbors = [&](size_t node)
+        {
+            const cxuint color = gcMap[node];
+            interGraph.forEachNeighbor(node, [&](size_t nb)
+            {
+                uint64_t& colorWord = nbColors[nb*colorWordsNum + (color>>6)];
+                const uint64_t colorMask = uint64_t(1)<<(color&63);
+                if ((colorWord & colorMask) != 0)
+                    return; // color already used by other neighbour
+                colorWord |= colorMask;
+                if (gcMap[nb] != UINT_MAX)
+                    return;
+                const bool inSet = nodeSet.erase(nb) != 0;
+                sdoCounts[nb]++;
+                if (inSet)
+                    nodeSet.insert(nb);
+            });
+        };
         
         cxuint colorsNum = 0;
         // firstly, allocate real registers
         for (const auto& entry: vregIndexMap)
             if (entry.first.regVar == nullptr)
                 gcMap[entry.second[0]] = colorsNum++;
+        for (size_t i = 0; i < nodesNum; i++)
+            if (gcMap[i] != UINT_MAX)
+                updateNeighbors(i);
+        
+        for (size_t i = 0; i < nodesNum; i++)
+            if (gcMap[i] == UINT_MAX)
+                nodeSet.insert(i);
         
-        for (size_t colored = 0; colored < nodesNum; colored++)
+        while (!nodeSet.empty())
         {
-            size_t node = *nodeSet.begin();
-            if (gcMap[node] != UINT_MAX)
-                continue; // already colored
-            size_t color = 0;
+            // choose node with greatest saturation degree
+            const size_t node = *nodeSet.begin();
+            nodeSet.erase(nodeSet.begin());
             
-            for (color = 0; color <= colorsNum; color++)
-            {
-                // find first usable color
-                bool thisSame = false;
-                for (size_t nb: interGraph[node])
-                    if (gcMap[nb] == color)
-                    {
-                        thisSame = true;
-                        break;
-                    }
-                if (!thisSame)
-                    break;
-            }
+            // find first usable color
+            const uint64_t* nodeColors = nbColors.data() + node*colorWordsNum;
+            size_t w = 0;
+            while (w < colorWordsNum && nodeColors[w] == ~uint64_t(0))
+                w++;
+            cxuint color = (w < colorWordsNum) ? (w<<6) + CTZ64(~nodeColors[w]) :
+                        colorWordsNum<<6;
+            color = std::min(color, colorsNum);
             if (color==colorsNum) // add new color if needed
             {
                 if (colorsNum >= maxColorsNum)
@@ -691,42 +1006,203 @@ void AsmRegAllocator::colorInterferenceGraph()
             }
             
             gcMap[node] = color;
-            // update SDO for node
-            bool colorExists = false;
-            for (size_t nb: interGraph[node])
-                if (gcMap[nb] == color)
-                {
-                    colorExists = true;
+            updateNeighbors(node);
+        }
+        
+        // try to reduce colors to fit into budget for occupancy
+        if (colorsNum > colorsBudget)
+        {
+            std::vector<bool> fixedNodes(nodesNum, false);
+            for (const auto& entry: vregIndexMap)
+                if (entry.first.regVar == nullptr)
+                    fixedNodes[entry.second[0]] = true;
+            for (cxuint pass = 0; pass < 16 && colorsNum > colorsBudget; pass++)
+            {
+                const cxuint newColorsNum = recolorGraph(interGraph, gcMap,
+                                fixedNodes, colorsNum);
+                if (newColorsNum == colorsNum)
+                    break; // no progress
+                colorsNum = newColorsNum;
+            }
+        }
+        colorsNums[regType] = colorsNum;
+    }
+}
+
+/* linear-scan allocation:
+ * variables joined by linear dependencies are grouped into chains that
+ * get consecutive registers, first register of chain is aligned.
+ * every group is treated as single interval from first start to last end
+ * of its live blocks. intervals are visited in start order and get
+ * first free (and aligned) registers; registers of intervals that ended
+ * before are freed */
+
+void AsmRegAllocator::allocateLinearScan()
+{
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                    assembler.deviceType);
+    std::vector<LiveBlock> liveBlockMaps[MAX_REGTYPES_NUM];
+    createLiveBlocks(regTypesNum, outLivenesses, liveBlockMaps);
+    
+    for (size_t regType = 0; regType < regTypesNum; regType++)
+    {
+        const size_t maxColorsNum = getGPUMaxRegistersNum(arch, regType);
+        const VarIndexMap& vregIndexMap = vregIndexMaps[regType];
+        const LinearDepMap& linearDepMap = linearDepMaps[regType];
+        Array<cxuint>& gcMap = graphColorMaps[regType];
+        const size_t nodesNum = graphVregsCounts[regType];
+        gcMap.resize(nodesNum);
+        std::fill(gcMap.begin(), gcMap.end(), cxuint(UINT_MAX));
+        
+        // bitset of used colors
+        std::vector<uint64_t> usedColors((maxColorsNum+63)>>6, uint64_t(0));
+        auto isColorUsed = [&usedColors](size_t color)
+        { return ((usedColors[color>>6] >> (color&63)) & 1) != 0; };
+        auto setColorsUsed = [&usedColors](size_t color, size_t count, bool used)
+        {
+            for (size_t c = color; c < color+count; c++)
+                if (used)
+                    usedColors[c>>6] |= uint64_t(1)<<(c&63);
+                else
+                    usedColors[c>>6] &= ~(uint64_t(1)<<(c&63));
+        };
+        
+        cxuint colorsNum = 0;
+        // firstly, allocate real registers (they are reserved for whole code)
+        for (const auto& entry: vregIndexMap)
+            if (entry.first.regVar == nullptr)
+            {
+                gcMap[entry.second[0]] = colorsNum;
+                setColorsUsed(colorsNum++, 1, true);
+            }
+        
+        // intervals of variables (hull of live blocks)
+        Array<std::pair<size_t, size_t> > intervals(nodesNum);
+        std::fill(intervals.begin(), intervals.end(), std::make_pair(SIZE_MAX, size_t(0)));
+        for (const LiveBlock& lb: liveBlockMaps[regType])
+        {
+            intervals[lb.vidx].first = std::min(intervals[lb.vidx].first, lb.start);
+            intervals[lb.vidx].second = std::max(intervals[lb.vidx].second, lb.end);
+        }
+        
+        // group variables by linear dependencies (chains from first to last)
+        struct Group
+        {
+            size_t start, end;
+            size_t first;   // index of first vidx in groupVidxes
+            size_t count;
+            size_t align;
+        };
+        std::vector<Group> groups;
+        std::vector<size_t> groupVidxes;
+        std::vector<bool> grouped(nodesNum, false);
+        for (size_t i = 0; i < nodesNum; i++)
+            grouped[i] = (gcMap[i] != UINT_MAX);
+        
+        auto addGroup = [&](size_t vidx)
+        {
+            Group group{ SIZE_MAX, 0, groupVidxes.size(), 0, 1 };
+            auto ldit = linearDepMap.find(vidx);
+            if (ldit != linearDepMap.end() && ldit->second.align != 0)
+                group.align = ldit->second.align;
+            while (true)
+            {
+                grouped[vidx] = true;
+                groupVidxes.push_back(vidx);
+                group.count++;
+                group.start = std::min(group.start, intervals[vidx].first);
+                group.end = std::max(group.end, intervals[vidx].second);
+                // follow first not grouped next variable
+                auto it = linearDepMap.find(vidx);
+                if (it == linearDepMap.end())
                     break;
-                }
-            if (!colorExists)
-                sdoCounts[node]++;
-            // update SDO for neighbors
-            for (size_t nb: interGraph[node])
+                auto nextIt = std::find_if(it->second.nextVidxes.begin(),
+                        it->second.nextVidxes.end(),
+                        [&grouped](size_t nv) { return !grouped[nv]; });
+                if (nextIt == it->second.nextVidxes.end())
+                    break;
+                vidx = *nextIt;
+            }
+            if (group.start > group.end)
+                group.start = group.end = 0; // not used variables
+            groups.push_back(group);
+        };
+        // start from chain heads, next from rest of variables
+        for (size_t vidx = 0; vidx < nodesNum; vidx++)
+        {
+            auto ldit = linearDepMap.find(vidx);
+            if (!grouped[vidx] && (ldit == linearDepMap.end() ||
+                        ldit->second.prevVidxes.empty()))
+                addGroup(vidx);
+        }
+        for (size_t vidx = 0; vidx < nodesNum; vidx++)
+            if (!grouped[vidx])
+                addGroup(vidx);
+        
+        std::sort(groups.begin(), groups.end(), [](const Group& g1, const Group& g2)
+            { return g1.start < g2.start || (g1.start == g2.start && g1.first < g2.first); });
+        
+        // active groups: first - end, second - group index
+        typedef std::pair<size_t, size_t> ActiveEntry;
+        std::priority_queue<ActiveEntry, std::vector<ActiveEntry>,
+                std::greater<ActiveEntry> > activeGroups;
+        for (size_t gi = 0; gi < groups.size(); gi++)
+        {
+            const Group& group = groups[gi];
+            // free registers of groups that ends before this group
+            while (!activeGroups.empty() && activeGroups.top().first <= group.start)
             {
-                colorExists = false;
-                for (size_t nb2: interGraph[nb])
-                    if (gcMap[nb2] == color)
-                    {
-                        colorExists = true;
-                        break;
-                    }
-                if (!colorExists)
-                {
-                    if (gcMap[nb] == UINT_MAX)
-                        nodeSet.erase(nb);  // before update we erase from nodeSet
-                    sdoCounts[nb]++;
-                    if (gcMap[nb] == UINT_MAX)
-                        nodeSet.insert(nb); // after update, insert again
-                }
+                const Group& endGroup = groups[activeGroups.top().second];
+                setColorsUsed(gcMap[groupVidxes[endGroup.first]], endGroup.count, false);
+                activeGroups.pop();
             }
-            
-            gcMap[node] = color;
+            // find first free aligned range of registers
+            size_t color = 0;
+            while (true)
+            {
+                if (color + group.count > maxColorsNum)
+                    throw AsmException("Too many register is needed");
+                size_t k = 0;
+                while (k < group.count && !isColorUsed(color+k))
+                    k++;
+                if (k == group.count)
+                    break;
+                // skip to next aligned color after used color
+                color = ((color+k+group.align) / group.align) * group.align;
+            }
+            for (size_t k = 0; k < group.count; k++)
+                gcMap[groupVidxes[group.first+k]] = color+k;
+            colorsNum = std::max(colorsNum, cxuint(color + group.count));
+            setColorsUsed(color, group.count, true);
+            activeGroups.push(std::make_pair(group.end, gi));
         }
+        colorsNums[regType] = colorsNum;
     }
 }
 
-void AsmRegAllocator::allocateRegisters(AsmSectionId sectionId)
+void AsmRegAllocator::computeOccupancy()
+{
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                    assembler.deviceType);
+    occupancy = getGPUMaxWavesPerSIMD(arch);
+    for (size_t regType = 0; regType < regTypesNum; regType++)
+        occupancy = std::min(occupancy, getGPUWavesNumForRegsNum(arch, regType,
+                    colorsNums[regType], getOccupancyRegFlags(assembler)));
+}
+
+void AsmRegAllocator::printOccupancyWarning()
+{
+    const cxuint targetOccupancy = assembler.regAllocOccupancy;
+    if (targetOccupancy != 0 && occupancy < targetOccupancy)
+    {
+        char buf[100];
+        snprintf(buf, 100, "Register allocation achieved occupancy %u waves "
+                "instead of %u", occupancy, targetOccupancy);
+        assembler.printWarning(assembler.regAllocOccupancyPos, buf);
+    }
+}
+
+void AsmRegAllocator::allocateRegistersInt(AsmSectionId sectionId)
 {
     // before any operation, clear all
     codeBlocks.clear();
@@ -737,17 +1213,63 @@ void AsmRegAllocator::allocateRegisters(AsmSectionId sectionId)
         interGraphs[i].clear();
         linearDepMaps[i].clear();
         graphColorMaps[i].clear();
+        colorsNums[i] = 0;
     }
     ssaReplacesMap.clear();
     cxuint maxRegs[MAX_REGTYPES_NUM];
     assembler.isaAssembler->getMaxRegistersNum(regTypesNum, maxRegs);
     
+    /* working data (routines, caches, flow stacks) are allocated in this arena
+     * and freed at once after allocation */
+    RegAllocArena arena;
+    RegAllocArenaScope arenaScope(arena);
+    
     // set up
     const AsmSection& section = assembler.sections[sectionId];
     createCodeStructure(section.codeFlow, section.content.size(), section.content.data());
     createSSAData(*section.usageHandler, *section.linearDepHandler);
     applySSAReplaces();
     createLivenesses(*section.usageHandler, *section.linearDepHandler);
-    createInterferenceGraph();
-    colorInterferenceGraph();
+    if (assembler.isLinearScan())
+        allocateLinearScan();
+    else
+    {
+        createInterferenceGraph();
+        colorInterferenceGraph();
+    }
+    computeOccupancy();
+}
+
+void AsmRegAllocator::allocateRegisters(AsmSectionId sectionId)
+{
+    allocateRegistersInt(sectionId);
+    printOccupancyWarning();
+}
+
+std::vector<std::unique_ptr<AsmRegAllocator> >
+AsmRegAllocator::allocateRegistersForSections(Assembler& assembler, cxuint threadsNum)
+{
+    std::vector<std::unique_ptr<AsmRegAllocator> > regAllocs(assembler.sections.size());
+    std::vector<AsmSectionId> sectionIds;
+    for (AsmSectionId i = 0; i < assembler.sections.size(); i++)
+    {
+        const AsmSection& section = assembler.sections[i];
+        if (section.type == AsmSectionType::CODE && section.usageHandler != nullptr &&
+            section.linearDepHandler != nullptr)
+        {
+            regAllocs[i].reset(new AsmRegAllocator(assembler));
+            sectionIds.push_back(i);
+        }
+    }
+    
+    // sections are independent, the allocators only read assembler's state
+    runParallelJobs(sectionIds.size(), threadsNum, [&regAllocs, &sectionIds](size_t j)
+    {
+        const AsmSectionId sectionId = sectionIds[j];
+        regAllocs[sectionId]->allocateRegistersInt(sectionId);
+    });
+    // print warnings in section order
+    for (AsmSectionId sectionId: sectionIds)
+        regAllocs[sectionId]->printOccupancyWarning();
+    return regAllocs;
 }
@@ -27,6 +27,8 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <map>
+#include <deque>
+#include <type_traits>
 #include <algorithm>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/Containers.h>
@@ -64,6 +66,156 @@ static inline bool checkNoWriteWithSSA(const AsmRegVarUsage& rvu)
     return (rvu.rwFlags != ASMRVU_WRITE || rvu.regField==ASMFIELD_NONE);
 }
 
+// update SSA info of single vreg by its usage (while scanning code block)
+static inline void updateSSAInfoByUsage(AsmRegAllocator::SSAInfo& sinfo, bool firstUsage,
+            const AsmRegVarUsage& rvu)
+{
+    if (firstUsage)
+        sinfo.firstPos = rvu.offset;
+    sinfo.lastPos = rvu.offset;
+    
+    const bool writeWithSSA = checkWriteWithSSA(rvu);
+    if (!writeWithSSA && (sinfo.ssaIdChange == 0 ||
+        // if first write RVU instead read RVU
+        (sinfo.ssaIdChange == 1 && sinfo.firstPos==rvu.offset)))
+        sinfo.readBeforeWrite = true;
+    /* change SSA id only for write-only regvars -
+     *   read-write place can not have two different variables */
+    if (writeWithSSA)
+        sinfo.ssaIdChange++;
+    if (rvu.regVar==nullptr)
+        sinfo.ssaIdBefore = sinfo.ssaIdFirst = sinfo.ssaId = sinfo.ssaIdLast = 0;
+}
+
+/* memory arena for working data of register allocator (one per allocation run).
+ * small chunks are taken from big blocks and freed chunks are kept in free lists
+ * (by size class) to reuse them. all memory is freed when arena is destroyed.
+ * big chunks are allocated directly by operator new */
+class CLRX_INTERNAL RegAllocArena: public NonCopyableAndNonMovable
+{
+public:
+    static const size_t chunkAlign = 16;
+    static const size_t maxChunkSize = 256;
+private:
+    struct FreeChunk
+    { FreeChunk* next; };
+    std::vector<char*> blocks;
+    char* blockPos;
+    char* blockEnd;
+    FreeChunk* freeLists[maxChunkSize/chunkAlign];
+    
+    void* allocateFromNewBlock(size_t size);
+public:
+    RegAllocArena();
+    ~RegAllocArena();
+    
+    void* allocate(size_t size)
+    {
+        if (size > maxChunkSize)
+            return ::operator new(size);
+        const size_t sizeClass = size!=0 ? (size-1) / chunkAlign : 0;
+        FreeChunk* chunk = freeLists[sizeClass];
+        if (chunk != nullptr)
+        {
+            freeLists[sizeClass] = chunk->next;
+            return chunk;
+        }
+        size = (sizeClass+1) * chunkAlign;
+        if (size_t(blockEnd - blockPos) < size)
+            return allocateFromNewBlock(size);
+        void* ptr = blockPos;
+        blockPos += size;
+        return ptr;
+    }
+    
+    void deallocate(void* ptr, size_t size)
+    {
+        if (size > maxChunkSize)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+        const size_t sizeClass = size!=0 ? (size-1) / chunkAlign : 0;
+        FreeChunk* chunk = reinterpret_cast<FreeChunk*>(ptr);
+        chunk->next = freeLists[sizeClass];
+        freeLists[sizeClass] = chunk;
+    }
+    
+    /// get arena of current thread (or null)
+    static RegAllocArena* getCurrent();
+    /// set arena of current thread, returns previous arena
+    static RegAllocArena* setCurrent(RegAllocArena* arena);
+};
+
+// set arena for current thread while this object lives
+class CLRX_INTERNAL RegAllocArenaScope: public NonCopyableAndNonMovable
+{
+private:
+    RegAllocArena* prevArena;
+public:
+    explicit RegAllocArenaScope(RegAllocArena& arena)
+            : prevArena(RegAllocArena::setCurrent(&arena))
+    { }
+    ~RegAllocArenaScope()
+    { RegAllocArena::setCurrent(prevArena); }
+};
+
+/* allocator for containers of working data. it holds arena which was current
+ * while creating container (if no arena, then uses operator new) */
+template<typename T>
+class CLRX_INTERNAL RegAllocArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    
+    template<typename U>
+    struct rebind
+    { typedef RegAllocArenaAllocator<U> other; };
+    
+    RegAllocArena* arena;
+    
+    RegAllocArenaAllocator() : arena(RegAllocArena::getCurrent())
+    { }
+    template<typename U>
+    RegAllocArenaAllocator(const RegAllocArenaAllocator<U>& a) : arena(a.arena)
+    { }
+    
+    T* allocate(size_t n)
+    {
+        if (arena == nullptr)
+            return static_cast<T*>(::operator new(n*sizeof(T)));
+        return static_cast<T*>(arena->allocate(n*sizeof(T)));
+    }
+    
+    void deallocate(T* ptr, size_t n)
+    {
+        if (arena == nullptr)
+            ::operator delete(ptr);
+        else
+            arena->deallocate(ptr, n*sizeof(T));
+    }
+    
+    template<typename U>
+    bool operator==(const RegAllocArenaAllocator<U>& a) const
+    { return arena == a.arena; }
+    template<typename U>
+    bool operator!=(const RegAllocArenaAllocator<U>& a) const
+    { return arena != a.arena; }
+};
+
+// containers that use arena
+template<typename K, typename V, typename H = std::hash<K> >
+using ArenaUnorderedMap = std::unordered_map<K, V, H, std::equal_to<K>,
+            RegAllocArenaAllocator<std::pair<const K, V> > >;
+template<typename K, typename H = std::hash<K> >
+using ArenaUnorderedSet = std::unordered_set<K, H, std::equal_to<K>,
+            RegAllocArenaAllocator<K> >;
+template<typename T>
+using ArenaDeque = std::deque<T, RegAllocArenaAllocator<T> >;
+
 typedef AsmRegAllocator::CodeBlock CodeBlock;
 typedef AsmRegAllocator::NextBlock NextBlock;
 typedef AsmRegAllocator::SSAInfo SSAInfo;
@@ -134,7 +286,7 @@ public:
 
 // map of last SSAId for routine, key - varid, value - last SSA ids
 class CLRX_INTERNAL LastSSAIdMap: public
-            std::unordered_map<AsmSingleVReg, VectorSet<size_t> >
+            ArenaUnorderedMap<AsmSingleVReg, VectorSet<size_t> >
 {
 public:
     LastSSAIdMap()
@@ -159,9 +311,9 @@ public:
     { return size(); }
 };
 
-typedef std::unordered_map<AsmSingleVReg, BlockIndex> SVRegBlockMap;
+typedef ArenaUnorderedMap<AsmSingleVReg, BlockIndex> SVRegBlockMap;
 
-class CLRX_INTERNAL SVRegMap: public std::unordered_map<AsmSingleVReg, size_t>
+class CLRX_INTERNAL SVRegMap: public ArenaUnorderedMap<AsmSingleVReg, size_t>
 {
 public:
     SVRegMap()
@@ -172,7 +324,7 @@ public:
 };
 
 typedef LastSSAIdMap RBWSSAIdMap;
-typedef std::unordered_map<BlockIndex, VectorSet<BlockIndex> > SubrLoopsMap;
+typedef ArenaUnorderedMap<BlockIndex, VectorSet<BlockIndex> > SubrLoopsMap;
 
 struct CLRX_INTERNAL RetSSAEntry
 {
@@ -181,7 +333,7 @@ struct CLRX_INTERNAL RetSSAEntry
     size_t prevSSAId; // for curSSAId
 };
 
-typedef std::unordered_map<AsmSingleVReg, RetSSAEntry> RetSSAIdMap;
+typedef ArenaUnorderedMap<AsmSingleVReg, RetSSAEntry> RetSSAIdMap;
 
 struct CLRX_INTERNAL LoopSSAIdMap
 {
@@ -197,7 +349,7 @@ struct CLRX_INTERNAL RoutineData
     LastSSAIdMap curSSAIdMap;
     LastSSAIdMap lastSSAIdMap;
     // key - loop block, value - last ssaId map for loop end
-    std::unordered_map<BlockIndex, LoopSSAIdMap> loopEnds;
+    ArenaUnorderedMap<BlockIndex, LoopSSAIdMap> loopEnds;
     bool notFirstReturn;
     bool generated;
     size_t weight_;
@@ -233,10 +385,11 @@ struct CLRX_INTERNAL LastVRegStackPos
     bool inSubroutines; // true if last access in some called subroutine
 };
 
-typedef std::unordered_map<AsmSingleVReg, VectorSet<LastAccessBlockPos> > LastAccessMap;
-typedef std::unordered_map<AsmSingleVReg, LastAccessBlockPos> RoutineCurAccessMap;
+typedef ArenaUnorderedMap<AsmSingleVReg, VectorSet<LastAccessBlockPos> >
+            LastAccessMap;
+typedef ArenaUnorderedMap<AsmSingleVReg, LastAccessBlockPos> RoutineCurAccessMap;
 class CLRX_INTERNAL LastStackPosMap
-        : public std::unordered_map<AsmSingleVReg, LastVRegStackPos>
+        : public ArenaUnorderedMap<AsmSingleVReg, LastVRegStackPos>
 {
 public:
     LastStackPosMap()
@@ -253,10 +406,10 @@ struct CLRX_INTERNAL RoutineDataLv
     SVRegMap rbwSSAIdMap;
     // holds all vreg SSA's used in routine (used while creating call point)
     // includes subroutines called in this routines
-    std::unordered_set<size_t> allSSAs[MAX_REGTYPES_NUM];
+    ArenaUnorderedSet<size_t> allSSAs[MAX_REGTYPES_NUM];
     // key - svreg, value - list of the last codeblocks where is svreg
     LastAccessMap lastAccessMap;
-    std::unordered_set<size_t> haveReturnBlocks;
+    ArenaUnorderedSet<size_t> haveReturnBlocks;
     bool fromSecondPass;
 };
 
@@ -303,10 +456,10 @@ struct CLRX_INTERNAL CallStackEntry
     BlockIndex routineBlock;    // routine block
 };
 
-typedef std::unordered_map<BlockIndex, RoutineData> RoutineMap;
-typedef std::unordered_map<BlockIndex, RoutineDataLv> RoutineLvMap;
+typedef ArenaUnorderedMap<BlockIndex, RoutineData> RoutineMap;
+typedef ArenaUnorderedMap<BlockIndex, RoutineDataLv> RoutineLvMap;
 
-typedef std::unordered_map<size_t, std::pair<size_t, size_t> > PrevWaysIndexMap;
+typedef ArenaUnorderedMap<size_t, std::pair<size_t, size_t> > PrevWaysIndexMap;
 
 class CLRX_INTERNAL ResSecondPointsToCache: public CBlockBitPool
 {
@@ -428,10 +581,11 @@ struct CLRX_INTERNAL Liveness
 
 typedef AsmRegAllocator::VarIndexMap VarIndexMap;
 
-typedef std::deque<FlowStackEntry3>::const_iterator FlowStackCIter;
+typedef ArenaDeque<FlowStackEntry3>::const_iterator FlowStackCIter;
 
 // key - singlevreg, value - code block chain
-typedef std::unordered_map<AsmSingleVReg, std::vector<LastVRegStackPos> > LastVRegMap;
+typedef ArenaUnorderedMap<AsmSingleVReg, std::vector<LastVRegStackPos> >
+            LastVRegMap;
 
 struct CLRX_INTERNAL LiveBlock
 {
@@ -461,11 +615,16 @@ struct CLRX_INTERNAL SDOLDOCompare
         : interGraph(_interGraph), sdoCounts(_sdoCounts)
     { }
     
+    // greater saturation degree first, next greater degree, next lesser index
     bool operator()(size_t a, size_t b) const
     {
-        if (sdoCounts[a] > sdoCounts[b])
-            return true;
-        return interGraph[a].size() > interGraph[b].size();
+        if (sdoCounts[a] != sdoCounts[b])
+            return sdoCounts[a] > sdoCounts[b];
+        const size_t degreeA = interGraph.degree(a);
+        const size_t degreeB = interGraph.degree(b);
+        if (degreeA != degreeB)
+            return degreeA > degreeB;
+        return a < b;
     }
 };
 
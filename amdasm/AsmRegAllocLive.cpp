@@ -44,7 +44,7 @@ namespace CLRX
 
 struct CLRX_INTERNAL LivenessState
 {
-    const std::deque<FlowStackEntry3>& flowStack;
+    const ArenaDeque<FlowStackEntry3>& flowStack;
     const std::vector<CodeBlock>& codeBlocks;
     std::vector<bool>& waysToCache;
     ResSecondPointsToCache& cblocksToCache;
@@ -146,11 +146,11 @@ static void fillUpInsideRoutine(LivenessState& ls,
             size_t startBlock, size_t routineBlock, const AsmSingleVReg& svreg,
             Liveness& lv, cxuint lvRType /* lv register type */, size_t vidx,
             size_t ssaId, const RoutineDataLv& rdata,
-            std::unordered_set<size_t>& havePathBlocks)
+            ArenaUnorderedSet<size_t>& havePathBlocks)
 {
-    const std::unordered_set<size_t>& haveReturnBlocks = rdata.haveReturnBlocks;
-    std::deque<FlowStackEntry3> flowStack;
-    std::unordered_set<size_t> visited;
+    const ArenaUnorderedSet<size_t>& haveReturnBlocks = rdata.haveReturnBlocks;
+    ArenaDeque<FlowStackEntry3> flowStack;
+    ArenaUnorderedSet<size_t> visited;
     
     flowStack.push_back({ startBlock, 0 });
     
@@ -302,8 +302,8 @@ static void joinVRegRecur(LivenessState& ls, LastVRegStackPos flowStkStart,
         const RoutineDataLv* rdata;
     };
     
-    std::unordered_set<LastAccessBlockPos> visited;
-    std::unordered_set<size_t> havePathBlocks;
+    ArenaUnorderedSet<LastAccessBlockPos> visited;
+    ArenaUnorderedSet<size_t> havePathBlocks;
     
     FlowStackCIter flitEnd = ls.flowStack.end();
     if (skipLastBlock)
@@ -446,9 +446,9 @@ static void addJoinSecCacheEntry(LivenessState& ls,
     ARDOut << "addJoinSecCacheEntry: " << nextBlock << "\n";
     //std::stack<CallStackEntry> callStack = prevCallStack;
     // traverse by graph from next block
-    std::deque<FlowStackEntry3> flowStack;
+    ArenaDeque<FlowStackEntry3> flowStack;
     flowStack.push_back({ nextBlock, 0 });
-    std::unordered_set<size_t> visited;
+    ArenaUnorderedSet<size_t> visited;
     
     // already read in current path
     // key - vreg, value - source block where vreg of conflict found
@@ -654,7 +654,7 @@ static void joinRegVarLivenesses(LivenessState& ls,
                 ls.cblocksToCache.count(nextBlock)>=2;
     
     // traverse by graph from next block
-    std::deque<FlowStackEntry3> flowStack;
+    ArenaDeque<FlowStackEntry3> flowStack;
     flowStack.push_back({ nextBlock, 0 });
     std::vector<bool> visited(ls.codeBlocks.size(), false);
     
@@ -809,7 +809,7 @@ static void joinRegVarLivenesses(LivenessState& ls,
 
 static bool addUsageDeps(const cxbyte* ldeps, const std::vector<AsmRegVarUsage>& rvus,
             const std::vector<AsmRegVarLinearDep>& instrLinDeps, LinearDepMap* ldepsOut,
-            Array<std::pair<AsmSingleVReg, SSAInfo> >& ssaInfoMap,
+            const Array<std::pair<AsmSingleVReg, SSAInfo> >& ssaInfoMap,
             const SVRegMap& ssaIdIdxMap, const std::vector<AsmSingleVReg>& readSVRegs,
             const std::vector<AsmSingleVReg>& writtenSVRegs, LivenessState& ls)
 {
@@ -983,15 +983,15 @@ static void createRoutineDataLv(LivenessState& ls, RoutineDataLv& rdata,
         VIdxSetEntry& routineVIdxes, size_t routineBlock)
 {
     ARDOut << "--------- createRoutineDataLv(" << routineBlock << ")\n";
-    std::deque<FlowStackEntry4> flowStack;
-    std::unordered_set<size_t> visited;
+    ArenaDeque<FlowStackEntry4> flowStack;
+    ArenaUnorderedSet<size_t> visited;
     
     // already read in current path
     // key - vreg, value - source block where vreg of conflict found
     SVRegMap alreadyReadMap;
-    std::unordered_set<AsmSingleVReg> vregsNotInAllRets;
-    std::unordered_set<AsmSingleVReg> vregsInFirstReturn;
-    std::unordered_set<size_t>& haveReturnBlocks = rdata.haveReturnBlocks;
+    ArenaUnorderedSet<AsmSingleVReg> vregsNotInAllRets;
+    ArenaUnorderedSet<AsmSingleVReg> vregsInFirstReturn;
+    ArenaUnorderedSet<size_t>& haveReturnBlocks = rdata.haveReturnBlocks;
     
     bool notFirstReturn = false;
     flowStack.push_back({ routineBlock, 0 });
@@ -1198,6 +1198,133 @@ static inline void revertLastSVReg(LastVRegMap& lastVRegMap, const AsmSingleVReg
     }
 }
 
+/* create livenesses inside code block from its register usage and
+ * add linear dependencies from its instructions */
+static void createBlockLivenesses(LivenessState& ls, const CodeBlock& cblock,
+            ISAUsageHandler& usageHandler, ISALinearDepHandler& linDepHandler,
+            LinearDepMap* linearDepMaps)
+{
+    const size_t linearDepSize = linDepHandler.size();
+    SVRegMap ssaIdIdxMap;
+    std::vector<AsmRegVarUsage> instrRVUs;
+    
+    std::vector<AsmSingleVReg> readSVRegs;
+    std::vector<AsmSingleVReg> writtenSVRegs;
+    
+    ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
+    size_t oldOffset = usageHandler.hasNext(usagePos) ?
+            cblock.start : cblock.end;
+    
+    size_t linearDepPos = linDepHandler.findPositionByOffset(cblock.start);
+    
+    // register in liveness
+    bool rvuFirst = true;
+    while (true)
+    {
+        AsmRegVarUsage rvu = { 0U, nullptr, 0U, 0U };
+        bool hasNext = false;
+        if (usageHandler.hasNext(usagePos) && oldOffset < cblock.end)
+        {
+            hasNext = true;
+            rvu = usageHandler.nextUsage(usagePos);
+            if (rvuFirst)
+            {
+                oldOffset = rvu.offset;
+                rvuFirst = false;
+            }
+        }
+        const size_t liveTime = oldOffset;
+        if ((!hasNext || rvu.offset > oldOffset) && oldOffset < cblock.end)
+        {
+            ARDOut << "apply to liveness. offset: " << oldOffset << "\n";
+            // apply to liveness
+            for (AsmSingleVReg svreg: readSVRegs)
+            {
+                auto svrres = ssaIdIdxMap.insert({ svreg, 0 });
+                Liveness& lv = getLiveness(svreg, svrres.first->second,
+                        binaryMapFind(cblock.ssaInfoMap.begin(),
+                            cblock.ssaInfoMap.end(), svreg)->second, ls);
+                if (svrres.second)
+                    // begin region from this block
+                    lv.insert(cblock.start, liveTime+1);
+                else
+                    lv.expand(liveTime+1);
+            }
+            for (AsmSingleVReg svreg: writtenSVRegs)
+            {
+                size_t& ssaIdIdx = ssaIdIdxMap[svreg];
+                if (svreg.regVar != nullptr)
+                    ssaIdIdx++;
+                const SSAInfo& sinfo = binaryMapFind(cblock.ssaInfoMap.begin(),
+                            cblock.ssaInfoMap.end(), svreg)->second;
+                Liveness& lv = getLiveness(svreg, ssaIdIdx, sinfo, ls);
+                // works only with ISA where smallest instruction have 2 bytes!
+                // after previous read, but not after instruction.
+                // if var is not used anywhere then this liveness region
+                // blocks assignment for other vars
+                lv.insert(liveTime+1, liveTime+2);
+            }
+            
+            // collecting linear deps for instruction
+            std::vector<AsmRegVarLinearDep> instrLinDeps;
+            AsmRegVarLinearDep linDep = { 0, nullptr, 0, 0 };
+            bool haveLdep = false;
+            if (oldOffset == 0 && linearDepPos < linearDepSize)
+            {
+                // special case: if offset is zero, force get linear dep
+                linDep = linDepHandler.getLinearDep(linearDepPos++);
+                haveLdep = true;
+            }
+            while (linDep.offset < oldOffset && linearDepPos < linearDepSize)
+            {
+                linDep = linDepHandler.getLinearDep(linearDepPos++);
+                haveLdep = true;
+            }
+            // if found
+            if (haveLdep)
+                while (linDep.offset == oldOffset)
+                {
+                    // just put
+                    instrLinDeps.push_back(linDep);
+                    if (linearDepPos < linearDepSize)
+                        linDep = linDepHandler.getLinearDep(linearDepPos++);
+                    else // no data
+                        break;
+                }
+            // get linear deps and equal to
+            cxbyte lDeps[16];
+            usageHandler.getUsageDependencies(instrRVUs.size(),
+                        instrRVUs.data(), lDeps);
+            
+            if (!addUsageDeps(lDeps, instrRVUs, instrLinDeps, linearDepMaps,
+                    cblock.ssaInfoMap, ssaIdIdxMap,
+                    readSVRegs, writtenSVRegs, ls))
+                throw AsmException("Linear deps failed");
+            
+            readSVRegs.clear();
+            writtenSVRegs.clear();
+            if (!hasNext)
+                break;
+            oldOffset = rvu.offset;
+            instrRVUs.clear();
+        }
+        if (hasNext && oldOffset < cblock.end && !rvu.useRegMode)
+            instrRVUs.push_back(rvu);
+        if (oldOffset >= cblock.end)
+            break;
+        
+        for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
+        {
+            // per register/singlvreg
+            AsmSingleVReg svreg{ rvu.regVar, rindex };
+            if (checkWriteWithSSA(rvu))
+                writtenSVRegs.push_back(svreg);
+            else // read or treat as reading // expand previous region
+                readSVRegs.push_back(svreg);
+        }
+    }
+}
+
 void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
                 ISALinearDepHandler& linDepHandler)
 {
@@ -1257,8 +1384,8 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
         }
     
     // construct vreg liveness
-    std::deque<CallStackEntry> callStack;
-    std::deque<FlowStackEntry3> flowStack;
+    ArenaDeque<CallStackEntry> callStack;
+    ArenaDeque<FlowStackEntry3> flowStack;
     CBlockBitPool visited(codeBlocks.size(), false);
     // hold last vreg ssaId and position
     LastVRegMap lastVRegMap;
@@ -1269,8 +1396,8 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
     std::pair<size_t, size_t> lastCommonCacheWayPoint{ SIZE_MAX, SIZE_MAX };
     std::vector<bool> waysToCache(codeBlocks.size(), false);
     ResSecondPointsToCache cblocksToCache(codeBlocks.size());
-    std::unordered_set<BlockIndex> callBlocks;
-    std::unordered_set<size_t> recurseBlocks;
+    ArenaUnorderedSet<BlockIndex> callBlocks;
+    ArenaUnorderedSet<size_t> recurseBlocks;
     
     size_t rbwCount = 0;
     size_t wrCount = 0;
@@ -1281,10 +1408,6 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
     for (size_t i = 0; i < regTypesNum; i++)
         livenesses[i].resize(graphVregsCounts[i]);
     
-    // callLiveTime - call live time where routine will be called
-    // reverse counted, begin from SIZE_MAX, used for joining svreg from routines
-    // and svreg used in this time
-    size_t curLiveTime = 0;
     flowStack.push_back({ 0, 0 });
     
     // structure to pass many arguments in compact pack
@@ -1292,8 +1415,6 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
         prevWaysIndexMap, livenesses, vregIndexMaps, vidxCallMap, vidxRoutineMap,
         routineMap, regTypesNum, regRanges };
     
-    const size_t linearDepSize = linDepHandler.size();
-    
     while (!flowStack.empty())
     {
         FlowStackEntry3& entry = flowStack.back();
@@ -1301,7 +1422,6 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
         
         if (entry.nextIndex == 0)
         {
-            curLiveTime = cblock.start;
             // process current block
             if (!visited[entry.blockIndex])
             {
@@ -1326,125 +1446,8 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
                         wrCount++;
                 }
                 
-                // main routine to handle ssaInfos
-                SVRegMap ssaIdIdxMap;
-                std::vector<AsmRegVarUsage> instrRVUs;
-                
-                std::vector<AsmSingleVReg> readSVRegs;
-                std::vector<AsmSingleVReg> writtenSVRegs;
-                
-                ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
-                size_t oldOffset = usageHandler.hasNext(usagePos) ?
-                        cblock.start : cblock.end;
-                
-                size_t linearDepPos = linDepHandler.findPositionByOffset(cblock.start);
-                
-                // register in liveness
-                bool rvuFirst = true;
-                while (true)
-                {
-                    AsmRegVarUsage rvu = { 0U, nullptr, 0U, 0U };
-                    bool hasNext = false;
-                    if (usageHandler.hasNext(usagePos) && oldOffset < cblock.end)
-                    {
-                        hasNext = true;
-                        rvu = usageHandler.nextUsage(usagePos);
-                        if (rvuFirst)
-                        {
-                            oldOffset = rvu.offset;
-                            rvuFirst = false;
-                        }
-                    }
-                    const size_t liveTime = oldOffset;
-                    if ((!hasNext || rvu.offset > oldOffset) && oldOffset < cblock.end)
-                    {
-                        ARDOut << "apply to liveness. offset: " << oldOffset << "\n";
-                        // apply to liveness
-                        for (AsmSingleVReg svreg: readSVRegs)
-                        {
-                            auto svrres = ssaIdIdxMap.insert({ svreg, 0 });
-                            Liveness& lv = getLiveness(svreg, svrres.first->second,
-                                    binaryMapFind(cblock.ssaInfoMap.begin(),
-                                        cblock.ssaInfoMap.end(), svreg)->second, ls);
-                            if (svrres.second)
-                                // begin region from this block
-                                lv.insert(curLiveTime, liveTime+1);
-                            else
-                                lv.expand(liveTime+1);
-                        }
-                        for (AsmSingleVReg svreg: writtenSVRegs)
-                        {
-                            size_t& ssaIdIdx = ssaIdIdxMap[svreg];
-                            if (svreg.regVar != nullptr)
-                                ssaIdIdx++;
-                            SSAInfo& sinfo = binaryMapFind(cblock.ssaInfoMap.begin(),
-                                        cblock.ssaInfoMap.end(), svreg)->second;
-                            Liveness& lv = getLiveness(svreg, ssaIdIdx, sinfo, ls);
-                            // works only with ISA where smallest instruction have 2 bytes!
-                            // after previous read, but not after instruction.
-                            // if var is not used anywhere then this liveness region
-                            // blocks assignment for other vars
-                            lv.insert(liveTime+1, liveTime+2);
-                        }
-                        
-                        // collecting linear deps for instruction
-                        std::vector<AsmRegVarLinearDep> instrLinDeps;
-                        AsmRegVarLinearDep linDep = { 0, nullptr, 0, 0 };
-                        bool haveLdep = false;
-                        if (oldOffset == 0 && linearDepPos < linearDepSize)
-                        {
-                            // special case: if offset is zero, force get linear dep
-                            linDep = linDepHandler.getLinearDep(linearDepPos++);
-                            haveLdep = true;
-                        }
-                        while (linDep.offset < oldOffset && linearDepPos < linearDepSize)
-                        {
-                            linDep = linDepHandler.getLinearDep(linearDepPos++);
-                            haveLdep = true;
-                        }
-                        // if found
-                        if (haveLdep)
-                            while (linDep.offset == oldOffset)
-                            {
-                                // just put
-                                instrLinDeps.push_back(linDep);
-                                if (linearDepPos < linearDepSize)
-                                    linDep = linDepHandler.getLinearDep(linearDepPos++);
-                                else // no data
-                                    break;
-                            }
-                        // get linear deps and equal to
-                        cxbyte lDeps[16];
-                        usageHandler.getUsageDependencies(instrRVUs.size(),
-                                    instrRVUs.data(), lDeps);
-                        
-                        if (!addUsageDeps(lDeps, instrRVUs, instrLinDeps, linearDepMaps,
-                                cblock.ssaInfoMap, ssaIdIdxMap,
-                                readSVRegs, writtenSVRegs, ls))
-                            assembler.printError(nullptr, "Linear deps failed");
-                        
-                        readSVRegs.clear();
-                        writtenSVRegs.clear();
-                        if (!hasNext)
-                            break;
-                        oldOffset = rvu.offset;
-                        instrRVUs.clear();
-                    }
-                    if (hasNext && oldOffset < cblock.end && !rvu.useRegMode)
-                        instrRVUs.push_back(rvu);
-                    if (oldOffset >= cblock.end)
-                        break;
-                    
-                    for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
-                    {
-                        // per register/singlvreg
-                        AsmSingleVReg svreg{ rvu.regVar, rindex };
-                        if (checkWriteWithSSA(rvu))
-                            writtenSVRegs.push_back(svreg);
-                        else // read or treat as reading // expand previous region
-                            readSVRegs.push_back(svreg);
-                    }
-                }
+                createBlockLivenesses(ls, cblock, usageHandler, linDepHandler,
+                            linearDepMaps);
             }
             else
             {
@@ -1553,7 +1556,7 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
         {
             if (entry.nextIndex!=0) // if back from calls (just return from calls)
             {
-                std::unordered_set<AsmSingleVReg> regSVRegs;
+                ArenaUnorderedSet<AsmSingleVReg> regSVRegs;
                 // just add last access of svreg from call routines to lastVRegMap
                 // and join svregs from routine with svreg used at this time
                 for (const NextBlock& next: cblock.nexts)
@@ -1585,7 +1588,7 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
             flowStack.pop_back();
             
             // revert lastVRegs in call
-            std::unordered_set<AsmSingleVReg> revertedSVRegs;
+            ArenaUnorderedSet<AsmSingleVReg> revertedSVRegs;
             for (const NextBlock& next: cblock.nexts)
                 if (next.isCall)
                 {
@@ -1681,3 +1684,274 @@ void AsmRegAllocator::createLivenesses(ISAUsageHandler& usageHandler,
         livenesses2.clear();
     }
 }
+
+/*********
+ * updateBlockLivenesses stuff
+ *********/
+
+static bool outLivenessContain(const AsmRegAllocator::OutLiveness& outLv, size_t t)
+{
+    auto it = std::upper_bound(outLv.begin(), outLv.end(), std::make_pair(t, SIZE_MAX));
+    if (it == outLv.begin())
+        return false;
+    --it;
+    return t < it->second;
+}
+
+// replace intervals of liveness inside [start,end) by intervals from new liveness
+static void replaceOutLivenessRange(AsmRegAllocator::OutLiveness& outLv,
+            size_t start, size_t end, const Liveness& lv)
+{
+    std::vector<std::pair<size_t, size_t> > newLv;
+    auto addInterval = [&newLv](size_t k, size_t k2)
+    {
+        // join with previous (like Liveness::insert)
+        if (!newLv.empty() && newLv.back().second >= k)
+            newLv.back().second = std::max(newLv.back().second, k2);
+        else
+            newLv.push_back({ k, k2 });
+    };
+    for (const auto& interval: outLv)
+        if (interval.first < start)
+            addInterval(interval.first, std::min(interval.second, start));
+    for (const auto& interval: lv.l)
+        addInterval(interval.first, interval.second);
+    for (const auto& interval: outLv)
+        if (interval.second > end)
+            addInterval(std::max(interval.first, end), interval.second);
+    
+    outLv.resize(newLv.size());
+    std::copy(newLv.begin(), newLv.end(), outLv.begin());
+}
+
+// remove linear dependencies of variable and links to it from other variables
+static void removeLinearDeps(LinearDepMap& ldepMap, size_t vidx)
+{
+    auto it = ldepMap.find(vidx);
+    if (it == ldepMap.end())
+        return;
+    for (size_t prevVidx: it->second.prevVidxes)
+    {
+        auto pit = ldepMap.find(prevVidx);
+        if (pit == ldepMap.end())
+            continue;
+        pit->second.nextVidxes.eraseValue(vidx);
+        if (pit->second.prevVidxes.empty() && pit->second.nextVidxes.empty())
+            ldepMap.erase(pit);
+    }
+    for (size_t nextVidx: it->second.nextVidxes)
+    {
+        auto nit = ldepMap.find(nextVidx);
+        if (nit == ldepMap.end())
+            continue;
+        nit->second.prevVidxes.eraseValue(vidx);
+        if (nit->second.prevVidxes.empty() && nit->second.nextVidxes.empty())
+            ldepMap.erase(nit);
+    }
+    ldepMap.erase(vidx);
+}
+
+namespace CLRX
+{
+
+struct CLRX_INTERNAL BlockVarLiveness
+{
+    cxuint regType;
+    size_t vidx;
+    size_t lastPos;     // last usage position of variable in code block
+    bool liveOut;   // live after code block
+    
+    bool operator<(const BlockVarLiveness& b) const
+    { return regType < b.regType || (regType == b.regType && vidx < b.vidx); }
+    bool operator==(const BlockVarLiveness& b) const
+    { return regType == b.regType && vidx == b.vidx; }
+};
+
+};
+
+void AsmRegAllocator::recreateLivenesses(ISAUsageHandler& usageHandler,
+            ISALinearDepHandler& linDepHandler)
+{
+    ARDOut << "----- recreateLivenesses ------\n";
+    for (CodeBlock& cblock: codeBlocks)
+    {
+        cblock.ssaInfoMap.clear();
+        cblock.usagePos = usageHandler.findPositionByOffset(cblock.start);
+    }
+    ssaReplacesMap.clear();
+    for (size_t i = 0; i < MAX_REGTYPES_NUM; i++)
+    {
+        vregIndexMaps[i].clear();
+        linearDepMaps[i].clear();
+        outLivenesses[i].clear();
+    }
+    vidxRoutineMap.clear();
+    vidxCallMap.clear();
+    createSSAData(usageHandler, linDepHandler);
+    applySSAReplaces();
+    createLivenesses(usageHandler, linDepHandler);
+}
+
+bool AsmRegAllocator::updateBlockLivenesses(ISAUsageHandler& usageHandler,
+            ISALinearDepHandler& linDepHandler, size_t firstBlock, size_t lastBlock)
+{
+    ARDOut << "----- updateBlockLivenesses ------\n";
+    lastBlock = std::min(lastBlock, codeBlocks.size());
+    
+    /* SSA ids outside changed blocks stay unchanged if changed blocks read before
+     * write and write same variables (the same number of times) */
+    std::vector<Array<std::pair<AsmSingleVReg, SSAInfo> > > newSSAInfoMaps(
+                lastBlock > firstBlock ? lastBlock-firstBlock : 0);
+    for (size_t bi = firstBlock; bi < lastBlock; bi++)
+    {
+        const CodeBlock& cblock = codeBlocks[bi];
+        ArenaUnorderedMap<AsmSingleVReg, SSAInfo> ssaInfoMap;
+        ISAUsageHandler::ReadPos usagePos =
+                usageHandler.findPositionByOffset(cblock.start);
+        while (usageHandler.hasNext(usagePos))
+        {
+            const AsmRegVarUsage rvu = usageHandler.nextUsage(usagePos);
+            if (rvu.offset >= cblock.end)
+                break;
+            for (uint16_t rindex = rvu.rstart; rindex < rvu.rend; rindex++)
+            {
+                auto res = ssaInfoMap.insert(
+                        { AsmSingleVReg{ rvu.regVar, rindex }, SSAInfo() });
+                updateSSAInfoByUsage(res.first->second, res.second, rvu);
+            }
+        }
+        Array<std::pair<AsmSingleVReg, SSAInfo> >& newSSAInfoMap =
+                    newSSAInfoMaps[bi-firstBlock];
+        newSSAInfoMap.resize(ssaInfoMap.size());
+        std::copy(ssaInfoMap.begin(), ssaInfoMap.end(), newSSAInfoMap.begin());
+        mapSort(newSSAInfoMap.begin(), newSSAInfoMap.end());
+        
+        if (newSSAInfoMap.size() != cblock.ssaInfoMap.size())
+        {
+            ARDOut << "  SSA ids changed in block " << bi << "\n";
+            return false;
+        }
+        for (size_t i = 0; i < newSSAInfoMap.size(); i++)
+        {
+            const auto& newEntry = newSSAInfoMap[i];
+            const auto& oldEntry = cblock.ssaInfoMap[i];
+            if (newEntry.first != oldEntry.first ||
+                newEntry.second.readBeforeWrite != oldEntry.second.readBeforeWrite ||
+                newEntry.second.ssaIdChange != oldEntry.second.ssaIdChange)
+            {
+                ARDOut << "  SSA ids changed in block " << bi << "\n";
+                return false;
+            }
+        }
+    }
+    
+    // usage positions in new usage handler (places of code blocks are not changed)
+    for (CodeBlock& cblock: codeBlocks)
+        cblock.usagePos = usageHandler.findPositionByOffset(cblock.start);
+    
+    cxuint regRanges[MAX_REGTYPES_NUM*2];
+    size_t regTypesNum;
+    assembler.isaAssembler->getRegisterRanges(regTypesNum, regRanges);
+    
+    std::vector<Liveness> livenesses[MAX_REGTYPES_NUM];
+    for (size_t i = 0; i < regTypesNum; i++)
+        livenesses[i].resize(graphVregsCounts[i]);
+    
+    // flow data is not needed to create livenesses inside code block
+    ArenaDeque<FlowStackEntry3> flowStack;
+    std::vector<bool> waysToCache;
+    ResSecondPointsToCache cblocksToCache(0);
+    PrevWaysIndexMap prevWaysIndexMap;
+    RoutineLvMap routineMap;
+    LivenessState ls = { flowStack, codeBlocks, waysToCache, cblocksToCache,
+        prevWaysIndexMap, livenesses, vregIndexMaps, vidxCallMap, vidxRoutineMap,
+        routineMap, regTypesNum, regRanges };
+    
+    std::vector<std::vector<BlockVarLiveness> > blocksVars(lastBlock-firstBlock);
+    // unchanged code blocks where variables of changed blocks are used
+    std::vector<size_t> depBlocks;
+    for (size_t bi = firstBlock; bi < lastBlock; bi++)
+    {
+        CodeBlock& cblock = codeBlocks[bi];
+        ARDOut << "  update block " << bi << "\n";
+        // update only usage positions, SSA ids are not changed
+        const Array<std::pair<AsmSingleVReg, SSAInfo> >& newSSAInfoMap =
+                    newSSAInfoMaps[bi-firstBlock];
+        for (size_t i = 0; i < newSSAInfoMap.size(); i++)
+        {
+            cblock.ssaInfoMap[i].second.firstPos = newSSAInfoMap[i].second.firstPos;
+            cblock.ssaInfoMap[i].second.lastPos = newSSAInfoMap[i].second.lastPos;
+        }
+        
+        // collect variables used in this block
+        std::vector<BlockVarLiveness>& blockVars = blocksVars[bi-firstBlock];
+        for (const auto& entry: cblock.ssaInfoMap)
+        {
+            const SSAInfo& sinfo = entry.second;
+            const size_t firstIdx = (sinfo.readBeforeWrite ||
+                        entry.first.regVar==nullptr) ? 0 : 1;
+            const size_t lastIdx = (entry.first.regVar!=nullptr) ? sinfo.ssaIdChange : 0;
+            for (size_t ssaIdIdx = firstIdx; ssaIdIdx <= lastIdx; ssaIdIdx++)
+            {
+                BlockVarLiveness bvar{ 0, 0, sinfo.lastPos, false };
+                getVIdx(entry.first, ssaIdIdx, sinfo, ls, bvar.regType, bvar.vidx);
+                blockVars.push_back(bvar);
+            }
+        }
+        std::sort(blockVars.begin(), blockVars.end());
+        blockVars.resize(std::unique(blockVars.begin(), blockVars.end()) -
+                    blockVars.begin());
+        
+        for (BlockVarLiveness& bvar: blockVars)
+        {
+            const OutLiveness& outLv = outLivenesses[bvar.regType][bvar.vidx];
+            bvar.liveOut = outLivenessContain(outLv, cblock.end-1);
+            /* old code of changed block may have linear deps that no longer exist.
+             * remove all linear deps of variable and recreate them later from
+             * all code blocks where variable lives (and can be used) */
+            removeLinearDeps(linearDepMaps[bvar.regType], bvar.vidx);
+            for (const auto& interval: outLv)
+            {
+                auto it = std::lower_bound(codeBlocks.begin(), codeBlocks.end(),
+                        interval.first, [](const CodeBlock& c, size_t pos)
+                        { return c.end <= pos; });
+                for (; it != codeBlocks.end() && it->start < interval.second; ++it)
+                {
+                    const size_t depBlock = it - codeBlocks.begin();
+                    if (depBlock < firstBlock || depBlock >= lastBlock)
+                        depBlocks.push_back(depBlock);
+                }
+            }
+        }
+    }
+    
+    for (size_t bi = firstBlock; bi < lastBlock; bi++)
+    {
+        const CodeBlock& cblock = codeBlocks[bi];
+        createBlockLivenesses(ls, cblock, usageHandler, linDepHandler, linearDepMaps);
+        
+        for (const BlockVarLiveness& bvar: blocksVars[bi-firstBlock])
+        {
+            Liveness& lv = livenesses[bvar.regType][bvar.vidx];
+            if (bvar.liveOut)
+                // join with livenesses in next blocks
+                lv.insert(bvar.lastPos+1, cblock.end);
+            replaceOutLivenessRange(outLivenesses[bvar.regType][bvar.vidx],
+                        cblock.start, cblock.end, lv);
+            lv.clear();
+        }
+    }
+    
+    /* recreate removed linear deps from unchanged code blocks.
+     * livenesses created by these blocks are not used */
+    std::sort(depBlocks.begin(), depBlocks.end());
+    depBlocks.resize(std::unique(depBlocks.begin(), depBlocks.end()) -
+                depBlocks.begin());
+    for (size_t bi: depBlocks)
+    {
+        ARDOut << "  recreate linear deps from block " << bi << "\n";
+        createBlockLivenesses(ls, codeBlocks[bi], usageHandler, linDepHandler,
+                    linearDepMaps);
+    }
+    return true;
+}
@@ -147,9 +147,9 @@ static void addResSecCacheEntry(const RoutineMap& routineMap,
     ARDOut << "addResSecCacheEntry: " << nextBlock << "\n";
     //std::stack<CallStackEntry> callStack = prevCallStack;
     // traverse by graph from next block
-    std::deque<FlowStackEntry2> flowStack;
+    ArenaDeque<FlowStackEntry2> flowStack;
     flowStack.push_back({ nextBlock, 0 });
-    std::unordered_set<size_t> visited;
+    ArenaUnorderedSet<size_t> visited;
     
     // already read in current path
     // key - vreg, value - source block where vreg of conflict found
@@ -284,7 +284,7 @@ static void applyCallToStackVarMap(const CodeBlock& cblock, const RoutineMap& ro
 
 // main routine to resilve SSA conflicts in code
 // it emits SSA replaces from these conflicts
-static void resolveSSAConflicts(const std::deque<FlowStackEntry2>& prevFlowStack,
+static void resolveSSAConflicts(const ArenaDeque<FlowStackEntry2>& prevFlowStack,
         const RoutineMap& routineMap, const std::vector<CodeBlock>& codeBlocks,
         const PrevWaysIndexMap& prevWaysIndexMap,
         const CBlockBitPool& waysToCache, ResSecondPointsToCache& cblocksToCache,
@@ -357,9 +357,9 @@ static void resolveSSAConflicts(const std::deque<FlowStackEntry2>& prevFlowStack
     
     //std::stack<CallStackEntry> callStack = prevCallStack;
     // traverse by graph from next block
-    std::deque<FlowStackEntry2> flowStack;
+    ArenaDeque<FlowStackEntry2> flowStack;
     flowStack.push_back({ nextBlock, 0 });
-    std::unordered_set<size_t> visited;
+    ArenaUnorderedSet<size_t> visited;
     
     // already read in current path
     // key - vreg, value - source block where vreg of conflict found
@@ -627,8 +627,8 @@ static void reduceSSAIdsForCalls(FlowStackEntry& entry,
     if (retSSAIdMap.empty())
         return;
     LastSSAIdMap rbwSSAIdMap;
-    std::unordered_set<AsmSingleVReg> reduced;
-    std::unordered_set<AsmSingleVReg> changed;
+    ArenaUnorderedSet<AsmSingleVReg> reduced;
+    ArenaUnorderedSet<AsmSingleVReg> changed;
     const CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
     // collect rbw SSAIds
     for (const NextBlock next: cblock.nexts)
@@ -962,8 +962,8 @@ static bool tryAddLoopEnd(const FlowStackEntry& entry, BlockIndex routineBlock,
 
 
 static void createRoutineData(const std::vector<CodeBlock>& codeBlocks,
-        SVRegMap& curSSAIdMap, const std::unordered_set<BlockIndex>& loopBlocks,
-        const std::unordered_set<BlockIndex>& callBlocks,
+        SVRegMap& curSSAIdMap, const ArenaUnorderedSet<BlockIndex>& loopBlocks,
+        const ArenaUnorderedSet<BlockIndex>& callBlocks,
         const ResSecondPointsToCache& subroutToCache,
         SimpleCache<BlockIndex, RoutineData>& subroutinesCache,
         const RoutineMap& routineMap, RoutineData& rdata,
@@ -972,14 +972,14 @@ static void createRoutineData(const std::vector<CodeBlock>& codeBlocks,
 {
     bool fromSubroutine = noMainLoop;
     ARDOut << "--------- createRoutineData ----------------\n";
-    std::unordered_set<BlockIndex> visited;
-    std::unordered_set<BlockIndex> haveReturnBlocks;
+    ArenaUnorderedSet<BlockIndex> visited;
+    ArenaUnorderedSet<BlockIndex> haveReturnBlocks;
     
     VectorSet<BlockIndex> activeLoops;
     SubrLoopsMap subrLoopsMap;
     SubrLoopsMap loopSubrsMap;
     RoutineMap subrDataForLoopMap;
-    std::deque<FlowStackEntry> flowStack;
+    ArenaDeque<FlowStackEntry> flowStack;
     // last SSA ids map from returns
     RetSSAIdMap retSSAIdMap;
     flowStack.push_back({ routineBlock, 0 });
@@ -992,7 +992,7 @@ static void createRoutineData(const std::vector<CodeBlock>& codeBlocks,
         const CodeBlock& cblock = codeBlocks[entry.blockIndex.index];
         
         auto addSubroutine = [&](
-            std::unordered_map<BlockIndex, LoopSSAIdMap>::const_iterator loopsit2,
+            ArenaUnorderedMap<BlockIndex, LoopSSAIdMap>::const_iterator loopsit2,
             bool applyToMainRoutine)
         {
             if (subroutinesCache.hasKey(entry.blockIndex))
@@ -1232,9 +1232,9 @@ static void createRoutineData(const std::vector<CodeBlock>& codeBlocks,
             if (!calledRoutines.empty())
             {
                 // toNotClear - regvar to no keep (because is used in called routines)
-                std::unordered_set<AsmSingleVReg> toNotClear;
+                ArenaUnorderedSet<AsmSingleVReg> toNotClear;
                 // if regvar any called routine (used)
-                std::unordered_set<AsmSingleVReg> allInCalls;
+                ArenaUnorderedSet<AsmSingleVReg> allInCalls;
                 for (BlockIndex rblock: calledRoutines)
                 {
                     const RoutineData& srcRdata = routineMap.find(rblock)->second;
@@ -1393,7 +1393,7 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
         return;
     auto cbit = codeBlocks.begin();
     AsmRegVarUsage rvu;
-    ISAUsageHandler::ReadPos usagePos{ 0, 0 };
+    ISAUsageHandler::ReadPos usagePos{ 0, 0, 0 };
     
     if (!usageHandler.hasNext(usagePos))
         return; // do nothing if no regusages
@@ -1424,7 +1424,7 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
             break;
         
         cbit->usagePos = oldReadPos;
-        std::unordered_map<AsmSingleVReg, SSAInfo> ssaInfoMap;
+        ArenaUnorderedMap<AsmSingleVReg, SSAInfo> ssaInfoMap;
         while (rvu.offset < cbit->end)
         {
             // process rvu
@@ -1433,24 +1433,7 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
             {
                 auto res = ssaInfoMap.insert(
                         { AsmSingleVReg{ rvu.regVar, rindex }, SSAInfo() });
-                
-                SSAInfo& sinfo = res.first->second;
-                if (res.second)
-                    sinfo.firstPos = rvu.offset;
-                sinfo.lastPos = rvu.offset;
-                
-                const bool writeWithSSA = checkWriteWithSSA(rvu);
-                if (!writeWithSSA && (sinfo.ssaIdChange == 0 ||
-                    // if first write RVU instead read RVU
-                    (sinfo.ssaIdChange == 1 && sinfo.firstPos==rvu.offset)))
-                    sinfo.readBeforeWrite = true;
-                /* change SSA id only for write-only regvars -
-                 *   read-write place can not have two different variables */
-                if (writeWithSSA)
-                    sinfo.ssaIdChange++;
-                if (rvu.regVar==nullptr)
-                    sinfo.ssaIdBefore = sinfo.ssaIdFirst =
-                            sinfo.ssaId = sinfo.ssaIdLast = 0;
+                updateSSAInfoByUsage(res.first->second, res.second, rvu);
             }
             
             // get next rvusage
@@ -1476,8 +1459,8 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
     
     SimpleCache<BlockIndex, RoutineData> subroutinesCache(codeBlocks.size()<<3);
     
-    std::deque<CallStackEntry> callStack;
-    std::deque<FlowStackEntry> flowStack;
+    ArenaDeque<CallStackEntry> callStack;
+    ArenaDeque<FlowStackEntry> flowStack;
     // total SSA count
     SVRegMap totalSSACountMap;
     // last SSA ids map from returns
@@ -1504,14 +1487,14 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
     CBlockBitPool visited(codeBlocks.size(), false);
     flowStack.push_back({ 0, 0 });
     flowStackBlocks[0] = true;
-    std::unordered_set<BlockIndex> callBlocks;
-    std::unordered_set<BlockIndex> loopBlocks;
-    std::unordered_set<size_t> recurseBlocks;
+    ArenaUnorderedSet<BlockIndex> callBlocks;
+    ArenaUnorderedSet<BlockIndex> loopBlocks;
+    ArenaUnorderedSet<size_t> recurseBlocks;
     
     /** INFO if you want to get code changedRegVars between recursions you get 3984
      * this stuff has been deleted */
     
-    std::unordered_map<size_t, SVRegMap > curSSAIdMapStateMap;
+    ArenaUnorderedMap<size_t, SVRegMap > curSSAIdMapStateMap;
     
     /*
      * main loop to fill up ssaInfos
@@ -1785,7 +1768,7 @@ void AsmRegAllocator::createSSAData(ISAUsageHandler& usageHandler,
      * after that, we find points to resolve conflicts
      **********/
     flowStack.clear();
-    std::deque<FlowStackEntry2> flowStack2;
+    ArenaDeque<FlowStackEntry2> flowStack2;
     
     std::fill(visited.begin(), visited.end(), false);
     flowStack2.push_back({ 0, 0 });
@@ -25,6 +25,13 @@
 #include <memory>
 #include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <cstring>
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/amdasm/Assembler.h>
 #include "AsmInternals.h"
@@ -112,6 +119,155 @@ void AsmMacro::addLine(RefPtr<const AsmMacroSubst> macro, RefPtr<const AsmSource
     contentLineNo++;
 }
 
+/* compile macro content. compiled content will be used by macro input filter
+ * in non-altmacro mode. substitutions and column translations must be same as
+ * in AsmMacroInputFilter::readLine */
+void AsmMacro::compile()
+{
+    segments.clear();
+    colTransEvents.clear();
+    compiledLines.clear();
+    // sorted arguments (same order as argument map in macro input filter)
+    AsmMacroInputFilter::MacroArgMap argMap(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+        argMap[i].first = args[i].name;
+    mapSort(argMap.begin(), argMap.end());
+    
+    const char* contentPtr = content.data();
+    const size_t contentSize = content.size();
+    const LineTrans* curColTrans = colTranslations.data();
+    const LineTrans* colTransEnd = colTranslations.data() + colTranslations.size();
+    size_t pos = 0;
+    size_t toCopyPos = 0;
+    size_t lineSegmentsStart = 0;
+    
+    // add text from content to segments (join with previous text if possible)
+    auto addText = [&](size_t start, size_t end)
+    {
+        if (start == end)
+            return;
+        if (segments.size() > lineSegmentsStart &&
+            segments.back().type == SegmentType::TEXT &&
+            segments.back().index + segments.back().size == start)
+            segments.back().size += end-start;
+        else
+            segments.push_back({ SegmentType::TEXT, start, end-start });
+    };
+    // add column translation event at current position
+    auto addEvent = [&](LineNo lineNo, bool put, bool lineStart)
+    {
+        // text between toCopyPos and pos will be joined with previous text
+        if (segments.size() > lineSegmentsStart &&
+            segments.back().type == SegmentType::TEXT &&
+            segments.back().index + segments.back().size == toCopyPos)
+            colTransEvents.push_back({ segments.size()-1,
+                    segments.back().size + pos-toCopyPos, lineNo, put, lineStart });
+        else
+            colTransEvents.push_back({ segments.size(), pos-toCopyPos,
+                    lineNo, put, lineStart });
+    };
+    
+    while (pos < contentSize)
+    {
+        size_t nextLinePos = pos;
+        while (nextLinePos < contentSize && contentPtr[nextLinePos] != '\n')
+            nextLinePos++;
+        
+        lineSegmentsStart = segments.size();
+        CompiledLine cline = { segments.size(), colTransEvents.size(),
+                    curColTrans->lineNo, 0, LineEndMode::NONE };
+        const size_t linePos = pos;
+        toCopyPos = pos;
+        size_t colTransThreshold = (curColTrans+1 != colTransEnd) ?
+                (curColTrans[1].position>0 ? curColTrans[1].position + linePos :
+                        nextLinePos) : SIZE_MAX;
+        
+        while (pos < contentSize && contentPtr[pos] != '\n')
+        {
+            if (pos >= colTransThreshold)
+            {
+                // put column translation
+                curColTrans++;
+                addEvent(curColTrans->lineNo, true, curColTrans->position >= 0);
+                colTransThreshold = (curColTrans+1 != colTransEnd) ?
+                        (curColTrans[1].position>0 ? curColTrans[1].position + linePos :
+                                nextLinePos) : SIZE_MAX;
+            }
+            if (contentPtr[pos] != '\\')
+            {
+                pos++;
+                continue;
+            }
+            // backslash
+            addText(toCopyPos, pos);
+            toCopyPos = pos;
+            pos++;
+            bool skipColTransBetweenMacroArg = true;
+            if (pos < contentSize)
+            {
+                if (contentPtr[pos] == '(' && pos+1 < contentSize &&
+                    contentPtr[pos+1]==')')
+                    pos += 2;   // skip this separator
+                else
+                {
+                    // extract argName
+                    const char* thisPos = contentPtr + pos;
+                    const CString symName = extractSymName(
+                                thisPos, contentPtr+contentSize, false);
+                    auto it = argMap.end();
+                    if (!symName.empty())
+                        it = binaryMapFind(argMap.begin(), argMap.end(), symName);
+                    if (it != argMap.end())
+                    {
+                        segments.push_back({ SegmentType::ARG,
+                                size_t(it-argMap.begin()), 0 });
+                        pos = thisPos-contentPtr;
+                    }
+                    else if (contentPtr[pos] == '@')
+                    {
+                        segments.push_back({ SegmentType::COUNTER, 0, 0 });
+                        pos++;
+                    }
+                    else
+                    {
+                        // keep backslash
+                        addText(pos-1, pos);
+                        // do not skip column translation, because no substitution!
+                        skipColTransBetweenMacroArg = false;
+                    }
+                }
+            }
+            toCopyPos = pos;
+            // skip colTrans between macroarg or separator
+            if (skipColTransBetweenMacroArg)
+                while (pos > colTransThreshold)
+                {
+                    curColTrans++;
+                    if (curColTrans->position >= 0)
+                        addEvent(curColTrans->lineNo, false, true);
+                    colTransThreshold = (curColTrans+1 != colTransEnd) ?
+                            curColTrans[1].position : SIZE_MAX;
+                }
+        }
+        addText(toCopyPos, pos);
+        if (pos < contentSize)
+        {
+            if (curColTrans+1 != colTransEnd)
+            {
+                curColTrans++;
+                cline.endMode = (curColTrans->position >= 0) ?
+                        LineEndMode::NEWLINE : LineEndMode::JOINED;
+            }
+            pos++; // skip newline
+        }
+        cline.lineNo = curColTrans->lineNo;
+        compiledLines.push_back(cline);
+    }
+    // end of content
+    compiledLines.push_back({ segments.size(), colTransEvents.size(), 0, 0,
+                LineEndMode::NONE });
+}
+
 /* Asm Repeat */
 AsmRepeat::AsmRepeat(const AsmSourcePos& _pos, uint64_t _repeatsNum)
         : contentLineNo(0), sourcePos(_pos), repeatsNum(_repeatsNum)
@@ -178,36 +334,155 @@ LineCol AsmInputFilter::translatePos(size_t position) const
     return { found->lineNo, position-found->position+1 };
 }
 
+/*
+ * AsmIncludeCache
+ */
+
+RefPtr<const AsmFilteredContent> AsmIncludeCache::getContent(const CString& filename,
+            uint64_t timestamp, uint64_t fileSize)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(filename);
+    if (it == entries.end() || it->second->timestamp != timestamp ||
+        it->second->fileSize != fileSize)
+        return RefPtr<const AsmFilteredContent>();
+    return it->second;
+}
+
+void AsmIncludeCache::putContent(const CString& filename,
+            RefPtr<const AsmFilteredContent> content)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[filename] = content;
+}
+
+void AsmIncludeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
 /*
  * AsmStreamInputFilter
  */
 
 static const size_t AsmParserLineMaxSize = 200;
 
-AsmStreamInputFilter::AsmStreamInputFilter(const CString& filename)
-    : AsmInputFilter(AsmInputFilterType::STREAM), managed(true),
-        stream(nullptr), mode(LineMode::NORMAL), stmtPos(0)
+/* characters that stop copying of regular characters in normal mode:
+ * spaces and control characters, ';', '\\', '*', '#', '"', '\'' */
+static const bool lineSpecialCharTable[256] =
 {
-    try
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true,
+    true, true, true, true, true, true, true, true,
+    true, false, true, true, false, false, false, true, // ' ', '"', '#', '\''
+    false, false, true, false, false, false, false, false, // '*'
+    false, false, false, false, false, false, false, false,
+    false, false, false, true, false, false, false, false, // ';'
+    false, false, false, false, false, false, false, false,
+    false, false, false, false, false, false, false, false,
+    false, false, false, false, false, false, false, false,
+    false, false, false, false, true, false, false, false // '\\'
+};
+
+// find first special character in [s, end) (16 or 32 characters at once)
+// if withSpace is false, then space (' ') is not special character
+template<bool withSpace>
+static inline const char* findLineSpecialChar(const char* s, const char* end)
+{
+#ifdef __AVX2__
+    const __m256i spaceMax = _mm256_set1_epi8(withSpace ? 0x20 : 0x1f);
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i asterisk = _mm256_set1_epi8('*');
+    const __m256i hash = _mm256_set1_epi8('#');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i lquote = _mm256_set1_epi8('\'');
+    for (; end-s >= 32; s += 32)
     {
-        source = RefPtr<const AsmSource>(new AsmFile(filename));
-        stream = new std::ifstream(filename.c_str(), std::ios::binary);
-        if (!*stream)
-            throw AsmException(std::string("Can't open source file '")+
-                    filename.c_str()+"'");
-        stream->exceptions(std::ios::badbit);
-        buffer.reserve(AsmParserLineMaxSize);
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        // unsigned v <= spaceMax - spaces and control characters
+        __m256i m = _mm256_cmpeq_epi8(_mm256_min_epu8(v, spaceMax), v);
+        m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, semicolon),
+                _mm256_cmpeq_epi8(v, backslash)));
+        m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, asterisk),
+                _mm256_cmpeq_epi8(v, hash)));
+        m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                _mm256_cmpeq_epi8(v, lquote)));
+        const uint32_t mask = _mm256_movemask_epi8(m);
+        if (mask != 0)
+            return s + CTZ32(mask);
     }
-    catch(...)
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i spaceMax = _mm_set1_epi8(withSpace ? 0x20 : 0x1f);
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i asterisk = _mm_set1_epi8('*');
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lquote = _mm_set1_epi8('\'');
+    for (; end-s >= 16; s += 16)
     {
-        delete stream;
-        throw;
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        // unsigned v <= spaceMax - spaces and control characters
+        __m128i m = _mm_cmpeq_epi8(_mm_min_epu8(v, spaceMax), v);
+        m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, semicolon),
+                _mm_cmpeq_epi8(v, backslash)));
+        m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, asterisk),
+                _mm_cmpeq_epi8(v, hash)));
+        m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                _mm_cmpeq_epi8(v, lquote)));
+        const uint32_t mask = _mm_movemask_epi8(m);
+        if (mask != 0)
+            return s + CTZ32(mask);
     }
+#endif
+    while (s != end && (!lineSpecialCharTable[(unsigned char)*s] ||
+                (!withSpace && *s == ' ')))
+        s++;
+    return s;
+}
+
+void AsmStreamInputFilter::openFile(const CString& filename)
+{
+    try
+    { mappedFile.reset(new MappedFileData(filename.c_str())); }
+    catch(const Exception&)
+    {
+        throw AsmException(std::string("Can't open source file '")+
+                filename.c_str()+"'");
+    }
+    buffer.reserve(AsmParserLineMaxSize);
+}
+
+size_t AsmStreamInputFilter::readMapped(size_t pos, size_t maxSize)
+{
+    const char* data = reinterpret_cast<const char*>(mappedFile->data());
+    size_t toRead = std::min(maxSize, mappedFile->size()-mappedPos);
+    // only to end of line, next lines can be returned directly from mapped file
+    const char* nlPtr = reinterpret_cast<const char*>(
+                ::memchr(data+mappedPos, '\n', toRead));
+    if (nlPtr != nullptr)
+        toRead = nlPtr+1 - (data+mappedPos);
+    std::copy(data+mappedPos, data+mappedPos+toRead, buffer.begin()+pos);
+    mappedPos += toRead;
+    return toRead;
+}
+
+AsmStreamInputFilter::AsmStreamInputFilter(const CString& filename)
+    : AsmInputFilter(AsmInputFilterType::STREAM), managed(true),
+        stream(nullptr), mappedPos(0), recordedContent(nullptr),
+        mode(LineMode::NORMAL), stmtPos(0)
+{
+    source = RefPtr<const AsmSource>(new AsmFile(filename));
+    openFile(filename);
 }
 
 AsmStreamInputFilter::AsmStreamInputFilter(std::istream& is, const CString& filename)
     : AsmInputFilter(AsmInputFilterType::STREAM),
-      managed(false), stream(&is), mode(LineMode::NORMAL), stmtPos(0)
+      managed(false), stream(&is), mappedPos(0), recordedContent(nullptr),
+      mode(LineMode::NORMAL), stmtPos(0)
 {
     source = RefPtr<const AsmSource>(new AsmFile(filename));
     stream->exceptions(std::ios::badbit);
@@ -217,36 +492,23 @@ AsmStreamInputFilter::AsmStreamInputFilter(std::istream& is, const CString& file
 AsmStreamInputFilter::AsmStreamInputFilter(const AsmSourcePos& pos,
            const CString& filename)
     : AsmInputFilter(AsmInputFilterType::STREAM),
-      managed(true), stream(nullptr), mode(LineMode::NORMAL), stmtPos(0)
+      managed(true), stream(nullptr), mappedPos(0), recordedContent(nullptr),
+        mode(LineMode::NORMAL), stmtPos(0)
 {
-    try
-    {
-        if (!pos.macro)
-            source = RefPtr<const AsmSource>(new AsmFile(pos.source, pos.lineNo,
-                             pos.colNo, filename));
-        else // if inside macro
-            source = RefPtr<const AsmSource>(new AsmFile(
-                RefPtr<const AsmSource>(new AsmMacroSource(pos.macro, pos.source)),
-                     pos.lineNo, pos.colNo, filename));
-        
-        // open file
-        stream = new std::ifstream(filename.c_str(), std::ios::binary);
-        if (!*stream)
-            throw AsmException(std::string("Can't open source file '")+
-                        filename.c_str()+"'");
-        stream->exceptions(std::ios::badbit);
-        buffer.reserve(AsmParserLineMaxSize);
-    }
-    catch(...)
-    {
-        delete stream;
-        throw;
-    }
+    if (!pos.macro)
+        source = RefPtr<const AsmSource>(new AsmFile(pos.source, pos.lineNo,
+                         pos.colNo, filename));
+    else // if inside macro
+        source = RefPtr<const AsmSource>(new AsmFile(
+            RefPtr<const AsmSource>(new AsmMacroSource(pos.macro, pos.source)),
+                 pos.lineNo, pos.colNo, filename));
+    openFile(filename);
 }
 
 AsmStreamInputFilter::AsmStreamInputFilter(const AsmSourcePos& pos, std::istream& is,
         const CString& filename) : AsmInputFilter(AsmInputFilterType::STREAM),
-        managed(false), stream(&is), mode(LineMode::NORMAL), stmtPos(0)
+        managed(false), stream(&is), mappedPos(0), recordedContent(nullptr),
+      mode(LineMode::NORMAL), stmtPos(0)
 {
     if (!pos.macro)
         source = RefPtr<const AsmSource>(new AsmFile(pos.source, pos.lineNo,
@@ -259,15 +521,121 @@ AsmStreamInputFilter::AsmStreamInputFilter(const AsmSourcePos& pos, std::istream
     buffer.reserve(AsmParserLineMaxSize);
 }
 
+AsmStreamInputFilter::AsmStreamInputFilter(const AsmSourcePos& pos,
+           const CString& filename, RefPtr<const AsmFilteredContent> content)
+    : AsmInputFilter(AsmInputFilterType::STREAM),
+      managed(true), stream(nullptr), mappedPos(0), filteredContent(content),
+      recordedContent(nullptr), mode(LineMode::NORMAL), stmtPos(0)
+{
+    if (!pos.macro)
+        source = RefPtr<const AsmSource>(new AsmFile(pos.source, pos.lineNo,
+                         pos.colNo, filename));
+    else // if inside macro
+        source = RefPtr<const AsmSource>(new AsmFile(
+            RefPtr<const AsmSource>(new AsmMacroSource(pos.macro, pos.source)),
+                 pos.lineNo, pos.colNo, filename));
+}
+
 AsmStreamInputFilter::~AsmStreamInputFilter()
 {
     if (managed)
         delete stream;
 }
 
+void AsmStreamInputFilter::printMessage(Assembler& assembler, LineCol lineCol,
+            bool warning, const char* message)
+{
+    if (recordedContent != nullptr)
+        recordedContent->messages.push_back({ lineCol, warning, message });
+    else if (warning)
+        assembler.printWarning(lineCol, message);
+    else
+        assembler.printError(lineCol, message);
+}
+
+RefPtr<const AsmFilteredContent> AsmStreamInputFilter::filterFile(Assembler& assembler,
+            const CString& filename, uint64_t timestamp, uint64_t fileSize)
+{
+    AsmStreamInputFilter filter(filename);
+    RefPtr<AsmFilteredContent> content(new AsmFilteredContent);
+    content->timestamp = timestamp;
+    content->fileSize = fileSize;
+    filter.recordedContent = content.get();
+    while (true)
+    {
+        const size_t messagePos = content->messages.size();
+        size_t lineSize;
+        const char* line = filter.readLine(assembler, lineSize);
+        content->lines.push_back({ content->text.size(), lineSize,
+                    content->colTranslations.size(), messagePos, filter.lineNo });
+        if (line == nullptr)
+            break; // end of file
+        content->text.insert(content->text.end(), line, line + lineSize);
+        content->colTranslations.insert(content->colTranslations.end(),
+                    filter.colTranslations.begin(), filter.colTranslations.end());
+    }
+    return content.constCast<const AsmFilteredContent>();
+}
+
+const char* AsmStreamInputFilter::readFilteredLine(Assembler& assembler,
+            size_t& lineSize)
+{
+    const AsmFilteredContent& content = *filteredContent.get();
+    if (pos >= content.lines.size())
+    {
+        // after end of content
+        lineSize = 0;
+        return nullptr;
+    }
+    const AsmFilteredContent::Line& line = content.lines[pos];
+    const bool endOfContent = (pos+1 == content.lines.size());
+    // print messages from filtering of this line
+    const size_t messageEnd = (!endOfContent) ?
+                content.lines[pos+1].messagePos : content.messages.size();
+    for (size_t i = line.messagePos; i < messageEnd; i++)
+    {
+        const AsmFilteredContent::Message& msg = content.messages[i];
+        if (msg.warning)
+            assembler.printWarning(msg.lineCol, msg.message);
+        else
+            assembler.printError(msg.lineCol, msg.message);
+    }
+    lineNo = line.lineNo;
+    pos++;
+    if (endOfContent)
+    {
+        lineSize = 0;
+        return nullptr;
+    }
+    colTranslations.assign(content.colTranslations.begin() + line.colTransPos,
+                content.colTranslations.begin() + content.lines[pos].colTransPos);
+    lineSize = line.size;
+    return (lineSize != 0) ? content.text.data() + line.textPos : "";
+}
+
 const char* AsmStreamInputFilter::readLine(Assembler& assembler, size_t& lineSize)
 {
+    if (filteredContent)
+        return readFilteredLine(assembler, lineSize);
     colTranslations.clear();
+    if (mappedFile && pos >= buffer.size() && mode == LineMode::NORMAL &&
+        stmtPos == 0 && mappedPos < mappedFile->size())
+    {
+        // return line directly from mapped file if it doesn't need any change
+        const char* line = reinterpret_cast<const char*>(mappedFile->data()) + mappedPos;
+        const char* end = reinterpret_cast<const char*>(mappedFile->data()) +
+                    mappedFile->size();
+        const char* lineEnd = findLineSpecialChar<false>(line, end);
+        // last line without newline will be read by slow path
+        if (lineEnd != end && *lineEnd == '\n')
+        {
+            colTranslations.push_back({0, lineNo});
+            lineSize = lineEnd-line;
+            mappedPos += lineSize+1;
+            lineNo++;
+            return line;
+        }
+    }
     bool endOfLine = false;
     size_t lineStart = pos;
     size_t joinStart = pos; // join Start - physical line start
@@ -286,6 +654,21 @@ const char* AsmStreamInputFilter::readLine(Assembler& assembler, size_t& lineSiz
                 {
                     // putting regular string (no spaces)
                     do {
+                        // copy regular characters at once
+                        const size_t regEnd = findLineSpecialChar<true>(buffer.data()+pos,
+                                    buffer.data()+buffer.size()) - buffer.data();
+                        if (regEnd != pos)
+                        {
+                            if (destPos != pos)
+                                ::memmove(buffer.data()+destPos, buffer.data()+pos,
+                                          regEnd-pos);
+                            destPos += regEnd-pos;
+                            pos = regEnd;
+                            backslash = false;
+                            if (pos >= buffer.size() || isSpace(buffer[pos]) ||
+                                buffer[pos] == ';')
+                                break;
+                        }
                         backslash = (buffer[pos] == '\\');
                         if (buffer[pos] == '*' &&
                             destPos > 0 && buffer[destPos-1] == '/')
@@ -377,12 +760,18 @@ const char* AsmStreamInputFilter::readLine(Assembler& assembler, size_t& lineSiz
             }
             case LineMode::LINE_COMMENT:
             {
-                while (pos < buffer.size() && buffer[pos] != '\n')
+                // skipping bytes until newline or buffer end
+                const char* nlPtr = reinterpret_cast<const char*>(::memchr(
+                            buffer.data()+pos, '\n', buffer.size()-pos));
+                const size_t commentEnd = (nlPtr != nullptr) ?
+                            nlPtr - buffer.data() : buffer.size();
+                if (commentEnd != pos)
                 {
-                    // skipping bytes until newline or buffer end
-                    backslash = (buffer[pos] == '\\');
-                    pos++;
-                    buffer[destPos++] = ' ';
+                    backslash = (buffer[commentEnd-1] == '\\');
+                    std::fill(buffer.begin()+destPos, buffer.begin()+destPos+
+                                (commentEnd-pos), ' ');
+                    destPos += commentEnd-pos;
+                    pos = commentEnd;
                 }
                 if (pos < buffer.size())
                 {
@@ -487,8 +876,8 @@ const char* AsmStreamInputFilter::readLine(Assembler& assembler, size_t& lineSiz
                                 {ssize_t(destPos-lineStart), lineNo});
                         }
                         else
-                            assembler.printWarning({lineNo, pos-joinStart+stmtPos+1},
-                                        "Unterminated string: newline inserted");
+                            printMessage(assembler, {lineNo, pos-joinStart+stmtPos+1},
+                                        true, "Unterminated string: newline inserted");
                         pos++;
                         joinStart = pos;
                         stmtPos = 0;
@@ -520,15 +909,21 @@ const char* AsmStreamInputFilter::readLine(Assembler& assembler, size_t& lineSiz
             if (pos == buffer.size())
                 buffer.resize(std::max(AsmParserLineMaxSize, (pos>>1)+pos));
             
-            stream->read(buffer.data()+pos, buffer.size()-pos);
-            const size_t readed = stream->gcount();
+            size_t readed;
+            if (mappedFile)
+                readed = readMapped(pos, buffer.size()-pos);
+            else
+            {
+                stream->read(buffer.data()+pos, buffer.size()-pos);
+                readed = stream->gcount();
+            }
             buffer.resize(pos+readed);
             if (readed == 0)
             {
                 // end of file. check comments
                 if (mode == LineMode::LONG_COMMENT && lineStart!=pos)
-                    assembler.printError({lineNo, pos-joinStart+stmtPos+1},
-                           "Unterminated multi-line comment");
+                    printMessage(assembler, {lineNo, pos-joinStart+stmtPos+1},
+                           false, "Unterminated multi-line comment");
                 if (destPos-lineStart == 0)
                 {
                     lineSize = 0;
@@ -579,8 +974,86 @@ AsmMacroInputFilter::AsmMacroInputFilter(RefPtr<const AsmMacro> _macro,
         realLinePos = -curColTrans[0].position;
 }
 
+const char* AsmMacroInputFilter::readCompiledLine(size_t& lineSize)
+{
+    buffer.clear();
+    colTranslations.clear();
+    const std::vector<AsmMacro::CompiledLine>& compiledLines = macro->getCompiledLines();
+    if (contentLineNo+1 >= compiledLines.size())
+    {
+        lineSize = 0;
+        return nullptr;
+    }
+    const AsmMacro::CompiledLine& cline = compiledLines[contentLineNo];
+    const AsmMacro::CompiledLine& nextCLine = compiledLines[contentLineNo+1];
+    const char* content = macro->getContent().data();
+    const AsmMacro::Segment* segments = macro->getSegments().data();
+    const AsmMacro::ColTransEvent* event = macro->getColTransEvents().data() +
+                cline.eventsStart;
+    const AsmMacro::ColTransEvent* eventsEnd = macro->getColTransEvents().data() +
+                nextCLine.eventsStart;
+    
+    colTranslations.push_back({ ssize_t(-realLinePos), cline.firstLineNo });
+    size_t destLineStart = 0;
+    for (size_t i = cline.segmentsStart; ; i++)
+    {
+        const size_t destPos = buffer.size();
+        // put column translations before or inside this segment
+        for (; event != eventsEnd && event->segment == i; ++event)
+        {
+            if (event->put)
+                colTranslations.push_back({ ssize_t(destPos + event->offset),
+                            event->lineNo });
+            if (event->lineStart)
+            {
+                /// real new line, reset real line position
+                realLinePos = 0;
+                destLineStart = destPos + event->offset;
+            }
+        }
+        if (i == nextCLine.segmentsStart)
+            break;
+        const AsmMacro::Segment& segment = segments[i];
+        if (segment.type == AsmMacro::SegmentType::TEXT)
+            buffer.insert(buffer.end(), content + segment.index,
+                        content + segment.index + segment.size);
+        else if (segment.type == AsmMacro::SegmentType::ARG)
+        {
+            const CString& value = argMap[segment.index].second;
+            buffer.insert(buffer.end(), value.begin(), value.begin() + value.size());
+        }
+        else
+        {
+            // macro counter
+            char numBuf[32];
+            const size_t numLen = itocstrCStyle(macroCount, numBuf, 32);
+            buffer.insert(buffer.end(), numBuf, numBuf+numLen);
+        }
+    }
+    lineSize = buffer.size();
+    if (cline.endMode == AsmMacro::LineEndMode::NEWLINE)
+        realLinePos = 0;
+    else if (cline.endMode == AsmMacro::LineEndMode::JOINED)
+        realLinePos += lineSize - destLineStart+1;
+    lineNo = cline.lineNo;
+    // move to next source translation
+    if (sourceTransIndex+1 < macro->getSourceTransSize())
+    {
+        const AsmMacro::SourceTrans& fpos = macro->getSourceTrans(sourceTransIndex+1);
+        if (fpos.lineNo == contentLineNo)
+        {
+            source = fpos.source;
+            sourceTransIndex++;
+        }
+    }
+    contentLineNo++;
+    return (!buffer.empty()) ? buffer.data() : "";
+}
+
 const char* AsmMacroInputFilter::readLine(Assembler& assembler, size_t& lineSize)
 {
+    if (!alternateMacro)
+        return readCompiledLine(lineSize);
     buffer.clear();
     colTranslations.clear();
     const std::vector<LineTrans>& macroColTrans = macro->getColTranslations();
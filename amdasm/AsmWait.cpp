@@ -41,7 +41,7 @@ ISAWaitHandler* ISAWaitHandler::copy() const
 }
 
 bool ISAWaitHandler::nextInstr(ReadPos& readPos,
-                AsmDelayedOp& delOp, AsmWaitInstr& waitInstr)
+                AsmDelayedOp& delOp, AsmWaitInstr& waitInstr) const
 {
     size_t delResOffset = SIZE_MAX;
     size_t waitInstrOffset = SIZE_MAX;
@@ -93,7 +93,7 @@ struct QueueEntry1
     { }
     
     bool empty() const
-    { return haveDelayedOp || !regs.empty(); }
+    { return !haveDelayedOp && regs.empty(); }
     
     void join(const QueueEntry1& b)
     {
@@ -293,8 +293,10 @@ struct CLRX_INTERNAL QueueState1
             
             cxuint nextReqQSize = std::min(next.requestedQueueSize, requestedQueueSize);
             const cxuint oldOrderedSize = ordered.size();
-            const cxuint prevOrderedSize = (nextReqQSize!=ordered.size() ?
-                    nextReqQSize-ordered.size() : next.ordered.size());
+            // keep no more entries than current queue has
+            const cxuint prevOrderedSize = std::min(oldOrderedSize,
+                    cxuint(nextReqQSize!=ordered.size() ?
+                    nextReqQSize-ordered.size() : next.ordered.size()));
             ordered.erase(ordered.begin(), ordered.end()-prevOrderedSize);
             ordered.insert(ordered.end(), next.ordered.begin(), next.ordered.end());
             orderedStartPos += ordered.size()-oldOrderedSize;
@@ -498,14 +500,16 @@ static cxuint getRRegFromSVReg(const AsmSingleVReg& svreg, size_t outSSAIdIdx,
     return rreg;
 }
 
+// simulate queues in single code block (only reads handlers and codeblock)
 static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
-        ISAWaitHandler& waitHandler, ISAWaitHandler::ReadPos& waitPos,
-        ISAUsageHandler& usageHandler, const AsmWaitConfig& waitConfig,
-        const VarIndexMap* vregIndexMaps, const Array<cxuint>* graphColorMaps,
-        size_t regTypesNum, const cxuint* regRanges, bool onlyWarnings)
+        const ISAWaitHandler& waitHandler, const ISAUsageHandler& usageHandler,
+        const AsmWaitConfig& waitConfig, const VarIndexMap* vregIndexMaps,
+        const Array<cxuint>* graphColorMaps, size_t regTypesNum, const cxuint* regRanges,
+        bool onlyWarnings)
 {
     // fill usage of registers (real access) to wCblock
     ISAUsageHandler::ReadPos usagePos = cblock.usagePos;
+    ISAWaitHandler::ReadPos waitPos = waitHandler.findPositionByOffset(cblock.start);
     
     SVRegMap ssaIdIdxMap;
     SVRegMap svregWriteOffsets;
@@ -530,9 +534,14 @@ static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
     std::fill(curQueueSizes, curQueueSizes + waitConfig.waitQueuesNum, UINT16_MAX);
     
     cxuint flushedQueues = 0;
-    while (usageHandler.hasNext(usagePos))
+    AsmRegVarUsage rvu;
+    // true if rvu has been read, but not processed (it is after wait instr)
+    bool rvuPending = false;
+    while (rvuPending || usageHandler.hasNext(usagePos))
     {
-        const AsmRegVarUsage rvu = usageHandler.nextUsage(usagePos);
+        if (!rvuPending)
+            rvu = usageHandler.nextUsage(usagePos);
+        rvuPending = false;
         if (rvu.offset >= cblock.end && instrOffset >= cblock.end)
             break;
         
@@ -621,6 +630,9 @@ static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
                     wblock.queues[w].flushTo(gwaitI.waits[w]);
             }
         }
+        else if (rvu.offset < cblock.end)
+            // process this rvu after wait instr or delayed op
+            rvuPending = true;
         
         if (instrOffset < cblock.end && rvu.offset >= instrOffset && isWaitInstr)
         {
@@ -676,8 +688,8 @@ static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
                 const AsmDelayedOpTypeEntry& delOpEntry = waitConfig.delayOpTypes[
                                 delayedOp.delayedOpType];
                 const cxuint queue1Idx = delOpEntry.waitType;
-                const cxuint queue2Idx = delayedOp.delayedOpType!=ASMDELOP_NONE ?
-                        waitConfig.delayOpTypes[delayedOp.delayedOpType].waitType :
+                const cxuint queue2Idx = delayedOp.delayedOpType2!=ASMDELOP_NONE ?
+                        waitConfig.delayOpTypes[delayedOp.delayedOpType2].waitType :
                         UINT_MAX;
                 // next entry
                 wblock.queues[queue1Idx].nextEntry();
@@ -734,7 +746,7 @@ static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
                         }
                         // do next queue entry if registered per element
                         rcount2 += 4;
-                        if (delOpEntry2.counting!=255 && delOpEntry2.counting <= rcount)
+                        if (delOpEntry2.counting!=255 && delOpEntry2.counting <= rcount2)
                         {
                             // new entry
                             wblock.queues[queue2Idx].nextEntry();
@@ -793,12 +805,12 @@ static void processQueueBlock(const CodeBlock& cblock, WaitCodeBlock& wblock,
                 instrOffset = (isWaitInstr ? waitInstr.offset : delayedOp.offset);
             }
         }
-        
-        // copy to wblock as array
-        wblock.firstRegs.resize(firstRegs.size());
-        std::copy(firstRegs.begin(), firstRegs.end(), wblock.firstRegs.begin());
-        mapSort(wblock.firstRegs.begin(), wblock.firstRegs.end());
     }
+    
+    // copy to wblock as array
+    wblock.firstRegs.resize(firstRegs.size());
+    std::copy(firstRegs.begin(), firstRegs.end(), wblock.firstRegs.begin());
+    mapSort(wblock.firstRegs.begin(), wblock.firstRegs.end());
 }
 
 static void optimizeWaitInstrs(const AsmWaitConfig& waitConfig,
@@ -880,16 +892,33 @@ static void generateWaitInstrsWhileJoining(const AsmWaitConfig& waitConfig,
     optimizeWaitInstrs(waitConfig, waitInstrs);
 }
 
+// get queue state in form with sorted registers
+static void getQueueState(const QueueState1& queue, AsmWaitScheduler::QueueState& out)
+{
+    out.ordered.resize(queue.ordered.size());
+    for (size_t i = 0; i < queue.ordered.size(); i++)
+    {
+        const QueueEntry1& entry = queue.ordered[i];
+        out.ordered[i].assign(entry.regs.begin(), entry.regs.end());
+        std::sort(out.ordered[i].begin(), out.ordered[i].end());
+    }
+    out.random.assign(queue.random.regs.begin(), queue.random.regs.end());
+    std::sort(out.random.begin(), out.random.end());
+    out.requestedQueueSize = queue.requestedQueueSize;
+    out.reallyFlushed = queue.reallyFlushed;
+}
+
 AsmWaitScheduler::AsmWaitScheduler(const AsmWaitConfig& _asmWaitConfig,
         Assembler& _assembler, const std::vector<CodeBlock>& _codeBlocks,
         const VarIndexMap* _vregIndexMaps, const Array<cxuint>* _graphColorMaps,
         bool _onlyWarnings)
         : waitConfig(_asmWaitConfig), assembler(_assembler), codeBlocks(_codeBlocks),
           vregIndexMaps(_vregIndexMaps), graphColorMaps(_graphColorMaps),
-          onlyWarnings(_onlyWarnings)
+          onlyWarnings(_onlyWarnings), collectBlockStates(false)
 { }
 
-void AsmWaitScheduler::schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& waitHandler)
+void AsmWaitScheduler::schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& waitHandler,
+                cxuint threadsNum)
 {
     if (codeBlocks.empty())
         return;
@@ -902,12 +931,25 @@ void AsmWaitScheduler::schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& w
     
     assembler.isaAssembler->getRegisterRanges(regTypesNum, regRanges);
     
-    // fill queue states
-    ISAWaitHandler::ReadPos waitPos{ 0, 0 };
-    for (size_t i = 0; i < codeBlocks.size(); i++)
-        processQueueBlock(codeBlocks[i], waitCodeBlocks[i], waitHandler, waitPos,
-                usageHandler, waitConfig, vregIndexMaps, graphColorMaps, regTypesNum,
-                regRanges, onlyWarnings);
+    // fill queue states. blocks are simulated independently,
+    // only joining (in main loop) depends on code flow
+    runParallelJobs(codeBlocks.size(), threadsNum, [&](size_t i)
+    {
+        processQueueBlock(codeBlocks[i], waitCodeBlocks[i], waitHandler, usageHandler,
+                waitConfig, vregIndexMaps, graphColorMaps, regTypesNum, regRanges,
+                onlyWarnings);
+    });
+    blockStates.clear();
+    if (collectBlockStates)
+    {
+        blockStates.resize(codeBlocks.size());
+        for (size_t i = 0; i < codeBlocks.size(); i++)
+        {
+            blockStates[i].waitInstrs = waitCodeBlocks[i].waitInstrs;
+            for (cxuint q = 0; q < waitConfig.waitQueuesNum; q++)
+                getQueueState(waitCodeBlocks[i].queues[q], blockStates[i].queues[q]);
+        }
+    }
     
     // key - current res first key, value - previous first key and its flowStack pos
     PrevWaysIndexMap prevWaysIndexMap;
@@ -953,6 +995,9 @@ void AsmWaitScheduler::schedule(ISAUsageHandler& usageHandler, ISAWaitHandler& w
                             size_t(entry.queues[q].requestedQueueSize),
                             minExtraQueueSizes[q] + wblock.queues[q].ordered.size());
                     entry.queues[q].joinNext(wblock.queues[q]);
+                    if (collectBlockStates)
+                        getQueueState(entry.queues[q],
+                                blockStates[entry.blockIndex].joinedQueues[q]);
                 }
             }
             else
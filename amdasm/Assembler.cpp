@@ -20,6 +20,7 @@
 #include <CLRX/Config.h>
 #include <string>
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <vector>
 #include <stack>
@@ -677,6 +678,51 @@ struct CLRX_INTERNAL ScopeStackElem0
 };
 
 
+/*
+ * AsmSymbolMap
+ */
+
+AsmSymbolMap::AsmSymbolMap(std::initializer_list<value_type> list) : slotsBits(0)
+{
+    for (const value_type& entry: list)
+        insert(entry);
+}
+
+size_t AsmSymbolMap::findIndex(const char* name, size_t hash) const
+{
+    if (slots.empty())
+        return SIZE_MAX;
+    const size_t mask = slots.size()-1;
+    for (size_t i = slotForHash(hash); slots[i].index != SIZE_MAX; i = (i+1) & mask)
+        if (slots[i].hash == hash && ::strcmp(entries[slots[i].index].first.c_str(),
+                        name) == 0)
+            return slots[i].index;
+    return SIZE_MAX;
+}
+
+void AsmSymbolMap::putSlot(size_t hash, size_t index)
+{
+    if ((entries.size()<<1) > slots.size())
+    {
+        // rehash: keep load factor not greater than 1/2
+        slotsBits = std::max(slotsBits+1, cxuint(4));
+        std::vector<Slot> oldSlots(size_t(1)<<slotsBits, Slot{ 0, SIZE_MAX });
+        oldSlots.swap(slots);
+        const size_t mask = slots.size()-1;
+        for (const Slot& slot: oldSlots)
+            if (slot.index != SIZE_MAX)
+            {
+                size_t i = slotForHash(slot.hash);
+                for (; slots[i].index != SIZE_MAX; i = (i+1) & mask);
+                slots[i] = slot;
+            }
+    }
+    const size_t mask = slots.size()-1;
+    size_t i = slotForHash(hash);
+    for (; slots[i].index != SIZE_MAX; i = (i+1) & mask);
+    slots[i] = Slot{ hash, index };
+}
+
 AsmScope::~AsmScope()
 {
     std::stack<ScopeStackElem0> scopeStack;
@@ -761,7 +807,7 @@ Assembler::Assembler(const CString& filename, std::istream& input, Flags _flags,
           driverVersion(0), llvmVersion(0),
           _64bit(false), newROCmBinFormat(false),
           llvm10BinFormat(false), rocmMetadataV3(false),
-          policyVersion(ASM_POLICY_DEFAULT),
+          policyVersion(ASM_POLICY_DEFAULT), regAllocOccupancy(0),
           isaAssembler(nullptr),
           // initialize global scope: adds '.' to symbols
           globalScope({nullptr,{std::make_pair(".", AsmSymbol(0, uint64_t(0)))}}),
@@ -775,11 +821,13 @@ Assembler::Assembler(const CString& filename, std::istream& input, Flags _flags,
           currentSection(globalScope.symbolMap.begin()->second.sectionId),
           currentOutPos(globalScope.symbolMap.begin()->second.value)
 {
+    initializeAsmPseudoOps();
     filenameIndex = 0;
     alternateMacro = (flags & ASM_ALTMACRO)!=0;
     buggyFPLit = (flags & ASM_BUGGYFPLIT)!=0;
     macroCase = (flags & ASM_MACRONOCASE)==0;
     oldModParam = (flags & ASM_OLDMODPARAM)!=0;
+    linearScan = (flags & ASM_LINEARSCAN)!=0;
     codeFlags = ((flags & ASM_WAVE32)!=0)?ASM_CODE_WAVE32:0;
     localCount = macroCount = inclusionLevel = 0;
     macroSubstLevel = repetitionLevel = 0;
@@ -803,7 +851,7 @@ Assembler::Assembler(const Array<CString>& _filenames, Flags _flags,
           driverVersion(0), llvmVersion(0),
           _64bit(false), newROCmBinFormat(false),
           llvm10BinFormat(false), rocmMetadataV3(false),
-          policyVersion(ASM_POLICY_DEFAULT),
+          policyVersion(ASM_POLICY_DEFAULT), regAllocOccupancy(0),
           isaAssembler(nullptr),
           // initialize global scope: adds '.' to symbols
           globalScope({nullptr,{std::make_pair(".", AsmSymbol(0, uint64_t(0)))}}),
@@ -817,12 +865,14 @@ Assembler::Assembler(const Array<CString>& _filenames, Flags _flags,
           currentSection(globalScope.symbolMap.begin()->second.sectionId),
           currentOutPos(globalScope.symbolMap.begin()->second.value)
 {
+    initializeAsmPseudoOps();
     filenameIndex = 0;
     filenames = _filenames;
     alternateMacro = (flags & ASM_ALTMACRO)!=0;
     buggyFPLit = (flags & ASM_BUGGYFPLIT)!=0;
     macroCase = (flags & ASM_MACRONOCASE)==0;
     oldModParam = (flags & ASM_OLDMODPARAM)!=0;
+    linearScan = (flags & ASM_LINEARSCAN)!=0;
     codeFlags = ((flags & ASM_WAVE32)!=0)?ASM_CODE_WAVE32:0;
     localCount = macroCount = inclusionLevel = 0;
     macroSubstLevel = repetitionLevel = 0;
@@ -2256,8 +2306,15 @@ AsmScope* Assembler::getRecurScope(const CString& scopePlace, bool ignoreLast,
 
 // internal routine to find symbol in scope (only traversing by '.using's)
 AsmSymbolEntry* Assembler::findSymbolInScopeInt(AsmScope* scope,
-                    const CString& symName, std::unordered_set<AsmScope*>& scopeSet)
+                    const CString& symName, size_t symHash,
+                    std::unordered_set<AsmScope*>& scopeSet)
 {
+    if (scope->usedScopes.empty())
+    {
+        // fast path: no '.using's, repeated finding in same scope gives same result
+        AsmSymbolMap::iterator it = scope->symbolMap.find(symName, symHash);
+        return (it != scope->symbolMap.end()) ? &*it : nullptr;
+    }
     if (!scopeSet.insert(scope).second)
         return nullptr;
     std::stack<ScopeUsingStackElem> usingStack;
@@ -2269,7 +2326,7 @@ AsmSymbolEntry* Assembler::findSymbolInScopeInt(AsmScope* scope,
         if (current.usingIt == curScope->usedScopes.begin())
         {
             // first we found in this scope
-            AsmSymbolMap::iterator it = curScope->symbolMap.find(symName);
+            AsmSymbolMap::iterator it = curScope->symbolMap.find(symName, symHash);
             if (it != curScope->symbolMap.end())
                 return &*it;
         }
@@ -2294,8 +2351,11 @@ AsmSymbolEntry* Assembler::findSymbolInScope(const CString& symName, AsmScope*&
     const char* lastStep = nullptr;
     scope = getRecurScope(symName, true, &lastStep);
     std::unordered_set<AsmScope*> scopeSet;
-    AsmSymbolEntry* foundSym = findSymbolInScopeInt(scope, lastStep, scopeSet);
     sameSymName = lastStep;
+    // hash of name computed once for all scopes
+    const size_t symHash = AsmSymbolMap::hashName(lastStep);
+    AsmSymbolEntry* foundSym = findSymbolInScopeInt(scope, sameSymName,
+                symHash, scopeSet);
     if (foundSym != nullptr)
         return foundSym;
     if (lastStep != symName)
@@ -2307,7 +2367,7 @@ AsmSymbolEntry* Assembler::findSymbolInScope(const CString& symName, AsmScope*&
     
     for (AsmScope* scope2 = scope; scope2 != nullptr; scope2 = scope2->parent)
     {  // find this scope
-        foundSym = findSymbolInScopeInt(scope2, lastStep, scopeSet);
+        foundSym = findSymbolInScopeInt(scope2, sameSymName, symHash, scopeSet);
         if (foundSym != nullptr)
             return foundSym;
     }
@@ -2457,11 +2517,30 @@ bool Assembler::includeFile(const char* pseudoOpPlace, const std::string& filena
 {
     if (inclusionLevel == 500)
         THIS_FAIL_BY_ERROR(pseudoOpPlace, "Inclusion level is greater than 500")
-    std::unique_ptr<AsmInputFilter> newInputFilter(new AsmStreamInputFilter(
-                getSourcePos(pseudoOpPlace), filename));
+    std::unique_ptr<AsmInputFilter> newInputFilter;
+    if (includeCache)
+    {
+        // get filtered content from cache or filter file and put it to cache
+        const uint64_t timestamp = getFileTimestamp(filename.c_str());
+        const uint64_t fileSize = getFileSize(filename.c_str());
+        RefPtr<const AsmFilteredContent> content = includeCache->getContent(
+                    filename.c_str(), timestamp, fileSize);
+        if (!content)
+        {
+            content = AsmStreamInputFilter::filterFile(*this, filename.c_str(),
+                        timestamp, fileSize);
+            includeCache->putContent(filename.c_str(), content);
+        }
+        newInputFilter.reset(new AsmStreamInputFilter(getSourcePos(pseudoOpPlace),
+                    filename.c_str(), content));
+    }
+    else
+        newInputFilter.reset(new AsmStreamInputFilter(getSourcePos(pseudoOpPlace),
+                    filename.c_str()));
     asmInputFilters.push(newInputFilter.release());
     currentInputFilter = asmInputFilters.top();
     inclusionLevel++;
+    includedFiles.push_back(filename.c_str());
     return true;
 }
 
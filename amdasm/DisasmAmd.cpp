@@ -22,6 +22,7 @@
 #include <cstdio>
 #include <string>
 #include <ostream>
+#include <sstream>
 #include <memory>
 #include <inttypes.h>
 #include <unordered_map>
@@ -1512,8 +1513,39 @@ static void dumpAmdKernelConfig(std::ostream& output, const AmdKernelConfig& con
     }
 }
 
+// disassemble single kernel (its configuration and code)
+static void disassembleAmdKernel(std::ostream& output, const AmdDisasmInput* amdInput,
+       const AmdDisasmKernelInput& kinput, ISADisassembler* isaDisassembler,
+       size_t& sectionCount, Flags flags)
+{
+    output.write(".kernel ", 8);
+    output.write(kinput.kernelName.c_str(), kinput.kernelName.size());
+    output.put('\n');
+    if ((flags & DISASM_CONFIG) == 0) // if not config
+        dumpAmdKernelDatas(output, kinput, flags);
+    else
+    {
+        // dump in human readable configuration
+        AmdKernelConfig config = getAmdKernelConfig(kinput.metadataSize,
+                kinput.metadata, kinput.calNotes, amdInput->driverInfo,
+                kinput.header, getGPUArchitectureFromDeviceType(amdInput->deviceType));
+        dumpAmdKernelConfig(output, config);
+    }
+    
+    if ((flags & DISASM_DUMPCODE) != 0 && kinput.code != nullptr && kinput.codeSize != 0)
+    {
+        // input kernel code (main disassembly)
+        output.write("    .text\n", 10);
+        isaDisassembler->setInput(kinput.codeSize, kinput.code);
+        isaDisassembler->beforeDisassemble();
+        isaDisassembler->disassemble();
+        sectionCount++;
+    }
+}
+
 void CLRX::disassembleAmd(std::ostream& output, const AmdDisasmInput* amdInput,
-       ISADisassembler* isaDisassembler, size_t& sectionCount, Flags flags)
+       ISADisassembler* isaDisassembler, size_t& sectionCount, Flags flags,
+       cxuint threadsNum)
 {
     if (amdInput->is64BitMode)
         output.write(".64bit\n", 7);
@@ -1522,7 +1554,6 @@ void CLRX::disassembleAmd(std::ostream& output, const AmdDisasmInput* amdInput,
     
     const bool doMetadata = ((flags & DISASM_METADATA) != 0);
     const bool doDumpData = ((flags & DISASM_DUMPDATA) != 0);
-    const bool doDumpCode = ((flags & DISASM_DUMPCODE) != 0);
     
     if (doMetadata)
     {
@@ -1544,30 +1575,42 @@ void CLRX::disassembleAmd(std::ostream& output, const AmdDisasmInput* amdInput,
         printDisasmData(amdInput->globalDataSize, amdInput->globalData, output);
     }
     
-    for (const AmdDisasmKernelInput& kinput: amdInput->kernels)
+    const size_t kernelsNum = amdInput->kernels.size();
+    if (threadsNum == 1 || kernelsNum < 2)
     {
-        output.write(".kernel ", 8);
-        output.write(kinput.kernelName.c_str(), kinput.kernelName.size());
-        output.put('\n');
-        if ((flags & DISASM_CONFIG) == 0) // if not config
-            dumpAmdKernelDatas(output, kinput, flags);
-        else
-        {
-            // dump in human readable configuration
-            AmdKernelConfig config = getAmdKernelConfig(kinput.metadataSize,
-                    kinput.metadata, kinput.calNotes, amdInput->driverInfo,
-                    kinput.header, getGPUArchitectureFromDeviceType(amdInput->deviceType));
-            dumpAmdKernelConfig(output, config);
-        }
-        
-        if (doDumpCode && kinput.code != nullptr && kinput.codeSize != 0)
-        {
-            // input kernel code (main disassembly)
-            output.write("    .text\n", 10);
-            isaDisassembler->setInput(kinput.codeSize, kinput.code);
-            isaDisassembler->beforeDisassemble();
-            isaDisassembler->disassemble();
+        for (const AmdDisasmKernelInput& kinput: amdInput->kernels)
+            disassembleAmdKernel(output, amdInput, kinput, isaDisassembler,
+                        sectionCount, flags);
+        return;
+    }
+    
+    /* concurrent disassembling: every kernel is disassembled by own disassembler
+     * to own output. numbered labels depends on section count, hence
+     * section counts must be computed before */
+    std::vector<size_t> kernelSectionCounts(kernelsNum);
+    for (size_t i = 0; i < kernelsNum; i++)
+    {
+        const AmdDisasmKernelInput& kinput = amdInput->kernels[i];
+        kernelSectionCounts[i] = sectionCount;
+        if ((flags & DISASM_DUMPCODE) != 0 && kinput.code != nullptr &&
+            kinput.codeSize != 0)
             sectionCount++;
-        }
     }
+    
+    std::vector<std::string> kernelOutputs(kernelsNum);
+    runParallelJobs(kernelsNum, threadsNum, [&](size_t i)
+    {
+        std::ostringstream kernelOutput;
+        kernelOutput.exceptions(std::ios::failbit | std::ios::badbit);
+        Disassembler kernelDisasm(amdInput, kernelOutput, flags);
+        size_t& kernelSectionCount = DisasmParallelUtils::getSectionCount(kernelDisasm);
+        kernelSectionCount = kernelSectionCounts[i];
+        disassembleAmdKernel(kernelOutput, amdInput, amdInput->kernels[i],
+                DisasmParallelUtils::getISADisassembler(kernelDisasm),
+                kernelSectionCount, flags);
+        kernelOutputs[i] = kernelOutput.str();
+    });
+    // write outputs in original order
+    for (const std::string& kernelOutput: kernelOutputs)
+        output.write(kernelOutput.c_str(), kernelOutput.size());
 }
@@ -35,6 +35,15 @@
 namespace CLRX
 {
 
+// helpers for concurrent disassembling (access to private Disassembler fields)
+struct CLRX_INTERNAL DisasmParallelUtils
+{
+    static ISADisassembler* getISADisassembler(Disassembler& disasm)
+    { return disasm.isaDisassembler.get(); }
+    static size_t& getSectionCount(Disassembler& disasm)
+    { return disasm.sectionCount; }
+};
+
 // print data in bytes in assembler format (secondAlign add extra align)
 extern CLRX_INTERNAL void printDisasmData(size_t size, const cxbyte* data,
               std::ostream& output, bool secondAlign = false);
@@ -50,7 +59,7 @@ extern CLRX_INTERNAL void printDisasmLongString(size_t size, const char* data,
 // disassemble Amd OpenCL 1.0 binary input
 extern CLRX_INTERNAL void disassembleAmd(std::ostream& output,
        const AmdDisasmInput* amdInput, ISADisassembler* isaDisassembler,
-       size_t& sectionCount, Flags flags);
+       size_t& sectionCount, Flags flags, cxuint threadsNum = 1);
 
 // disassemble Amd OpenCL 2.0 binary input
 extern CLRX_INTERNAL void disassembleAmdCL2(std::ostream& output,
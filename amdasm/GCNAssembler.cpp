@@ -35,6 +35,139 @@ using namespace CLRX;
 static OnceFlag clrxGCNAssemblerOnceFlag;
 static Array<GCNAsmInstruction> gcnInstrSortedTable;
 
+/* minimal perfect hash of mnemonics (hash and displace method).
+ * bucket is choosen by high part of mnemonic hash, slot is choosen by low part of
+ * hash mixed with displacement of bucket. slot holds indices of instructions
+ * (in gcnInstrSortedTable) for every GPU architecture */
+
+static const cxuint gcnArchsNum = cxuint(GPUArchitecture::GPUARCH_MAX)+1;
+
+struct CLRX_INTERNAL GCNMnemonicHashSlot
+{
+    const char* mnemonic;
+    uint16_t archInstrs[gcnArchsNum];  // UINT16_MAX - no instruction for architecture
+};
+
+static Array<uint32_t> gcnMnemHashDisps;
+static Array<GCNMnemonicHashSlot> gcnMnemHashSlots;
+
+// FNV-1a hash
+static inline uint64_t gcnMnemonicHash(const char* mnemonic)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (; *mnemonic!=0; mnemonic++)
+        hash = (hash ^ cxbyte(*mnemonic)) * 0x100000001b3ULL;
+    return hash;
+}
+
+static inline size_t gcnMnemonicHashSlot(uint64_t hash, uint32_t disp, size_t slotsNum)
+{
+    uint32_t x = uint32_t(hash) ^ (disp * 0x9e3779b9U);
+    x = (x ^ (x>>16)) * 0x85ebca6bU;
+    x = (x ^ (x>>13)) * 0xc2b2ae35U;
+    return (x ^ (x>>16)) % slotsNum;
+}
+
+static void initializeGCNMnemonicHash()
+{
+    const size_t tableSize = gcnInstrSortedTable.size();
+    if (tableSize >= UINT16_MAX)
+        throw Exception("GCN instruction table is too big for mnemonic hash");
+    // collect distinct mnemonics (table is sorted by mnemonic)
+    std::vector<size_t> mnemStarts;
+    for (size_t i = 0; i < tableSize; i++)
+        if (i == 0 || ::strcmp(gcnInstrSortedTable[i-1].mnemonic,
+                        gcnInstrSortedTable[i].mnemonic)!=0)
+            mnemStarts.push_back(i);
+    const size_t mnemsNum = mnemStarts.size();
+    mnemStarts.push_back(tableSize);
+    
+    const size_t bucketsNum = (mnemsNum+3)>>2;
+    std::vector<uint64_t> hashes(mnemsNum);
+    std::vector<std::vector<size_t> > buckets(bucketsNum);
+    for (size_t i = 0; i < mnemsNum; i++)
+    {
+        hashes[i] = gcnMnemonicHash(gcnInstrSortedTable[mnemStarts[i]].mnemonic);
+        buckets[(hashes[i]>>32) % bucketsNum].push_back(i);
+    }
+    // place biggest buckets first
+    std::vector<size_t> bucketOrder(bucketsNum);
+    for (size_t i = 0; i < bucketsNum; i++)
+        bucketOrder[i] = i;
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets]
+            (size_t b1, size_t b2)
+            { return buckets[b1].size() > buckets[b2].size(); });
+    
+    gcnMnemHashDisps.resize(bucketsNum);
+    std::fill(gcnMnemHashDisps.begin(), gcnMnemHashDisps.end(), 0);
+    std::vector<size_t> slotMnems(mnemsNum, SIZE_MAX);
+    std::vector<size_t> bucketSlots;
+    for (size_t b: bucketOrder)
+    {
+        const std::vector<size_t>& bucket = buckets[b];
+        if (bucket.empty())
+            break;
+        uint32_t disp = 0;
+        for (; disp < UINT32_MAX; disp++)
+        {
+            // check whether all mnemonics of bucket go to distinct free slots
+            bucketSlots.clear();
+            bool good = true;
+            for (size_t m: bucket)
+            {
+                const size_t slot = gcnMnemonicHashSlot(hashes[m], disp, mnemsNum);
+                if (slotMnems[slot] != SIZE_MAX || std::find(bucketSlots.begin(),
+                            bucketSlots.end(), slot) != bucketSlots.end())
+                {
+                    good = false;
+                    break;
+                }
+                bucketSlots.push_back(slot);
+            }
+            if (good)
+                break;
+        }
+        if (disp == UINT32_MAX)
+            throw Exception("Can't create GCN mnemonic hash");
+        gcnMnemHashDisps[b] = disp;
+        for (size_t k = 0; k < bucket.size(); k++)
+            slotMnems[bucketSlots[k]] = bucket[k];
+    }
+    
+    // fill slots
+    gcnMnemHashSlots.resize(mnemsNum);
+    for (size_t slot = 0; slot < mnemsNum; slot++)
+    {
+        const size_t m = slotMnems[slot];
+        GCNMnemonicHashSlot& hslot = gcnMnemHashSlots[slot];
+        hslot.mnemonic = gcnInstrSortedTable[mnemStarts[m]].mnemonic;
+        for (cxuint arch = 0; arch < gcnArchsNum; arch++)
+        {
+            // first instruction that matches to architecture
+            hslot.archInstrs[arch] = UINT16_MAX;
+            for (size_t i = mnemStarts[m]; i < mnemStarts[m+1]; i++)
+                if ((gcnInstrSortedTable[i].archMask & (1U<<arch)) != 0)
+                {
+                    hslot.archInstrs[arch] = i;
+                    break;
+                }
+        }
+    }
+}
+
+// find instruction by mnemonic for architecture, returns null if not found
+static inline const GCNAsmInstruction* findGCNInstruction(const char* mnemonic,
+            cxuint arch)
+{
+    const uint64_t hash = gcnMnemonicHash(mnemonic);
+    const uint32_t disp = gcnMnemHashDisps[(hash>>32) % gcnMnemHashDisps.size()];
+    const GCNMnemonicHashSlot& hslot = gcnMnemHashSlots[gcnMnemonicHashSlot(
+                hash, disp, gcnMnemHashSlots.size())];
+    if (::strcmp(hslot.mnemonic, mnemonic)!=0 || hslot.archInstrs[arch]==UINT16_MAX)
+        return nullptr;
+    return gcnInstrSortedTable.data() + hslot.archInstrs[arch];
+}
+
 static void initializeGCNAssembler()
 {
     size_t tableSize = 0;
@@ -117,6 +250,7 @@ static void initializeGCNAssembler()
         }
     }
     gcnInstrSortedTable.resize(j); // final size
+    initializeGCNMnemonicHash();
 }
 
 // GCN Usage handler
@@ -233,20 +367,10 @@ void GCNAssembler::assemble(const CString& inMnemonic, const char* mnemPlace,
     else
         mnemonic = inMnemonic;
     
-    // find instruction by mnemonic
-    auto it = binaryFind(gcnInstrSortedTable.begin(), gcnInstrSortedTable.end(),
-               GCNAsmInstruction{mnemonic.c_str()},
-               [](const GCNAsmInstruction& instr1, const GCNAsmInstruction& instr2)
-               { return ::strcmp(instr1.mnemonic, instr2.mnemonic)<0; });
-    
-    // find matched entry
-    if (it != gcnInstrSortedTable.end() && (it->archMask & curArchMask)==0)
-        // if not match current arch mask
-        for (++it ;it != gcnInstrSortedTable.end() &&
-               ::strcmp(it->mnemonic, mnemonic.c_str())==0 &&
-               (it->archMask & curArchMask)==0; ++it);
-
-    if (it == gcnInstrSortedTable.end() || ::strcmp(it->mnemonic, mnemonic.c_str())!=0)
+    // find instruction by mnemonic (entry matched to current architecture)
+    const GCNAsmInstruction* it = findGCNInstruction(mnemonic.c_str(),
+                CTZ32(curArchMask));
+    if (it == nullptr)
     {
         // unrecognized mnemonic
         printError(mnemPlace, "Unknown instruction");
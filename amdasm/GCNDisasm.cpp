@@ -26,6 +26,8 @@
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/GPUId.h>
 #include <CLRX/amdasm/Disassembler.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/amdasm/GCNDefs.h>
 #include <CLRX/utils/MemAccess.h>
 #include "GCNInternals.h"
 #include "GCNDisasmInternals.h"
@@ -144,6 +146,8 @@ enum: cxuint {
     GCN_GFX10_ENCSPACE_IDX = 44
 };
 
+static void initializeGCNEncodingClassTables();
+
 // create main instruction table
 static void initializeGCNDisassembler()
 {
@@ -230,6 +234,8 @@ static void initializeGCNDisassembler()
             }
         }
     }
+    
+    initializeGCNEncodingClassTables();
 }
 
 GCNDisassembler::GCNDisassembler(Disassembler& disassembler)
@@ -311,22 +317,115 @@ static const cxbyte gcnSize15Table[16] =
     GCNENCSCH_1DWORD // GCNENC_NONE   // 1111 - illegal
 };
 
-void GCNDisassembler::analyzeBeforeDisassemble()
+static const cxbyte gcnEncoding11Table[16] =
 {
-    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(input);
-    const size_t codeWordsNum = (inputSize>>2);
+    GCNENC_SMRD, // 0000
+    GCNENC_SMRD, // 0001
+    GCNENC_VINTRP, // 0010
+    GCNENC_NONE, // 0011 - illegal
+    GCNENC_VOP3A, // 0100
+    GCNENC_NONE, // 0101 - illegal
+    GCNENC_DS,   // 0110
+    GCNENC_FLAT, // 0111
+    GCNENC_MUBUF, // 1000
+    GCNENC_NONE,  // 1001 - illegal
+    GCNENC_MTBUF, // 1010
+    GCNENC_NONE,  // 1011 - illegal
+    GCNENC_MIMG,  // 1100
+    GCNENC_NONE,  // 1101 - illegal
+    GCNENC_EXP,   // 1110
+    GCNENC_NONE   // 1111 - illegal
+};
 
-    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
-                disassembler.getDeviceType());
+static const cxbyte gcnEncoding12Table[16] =
+{
+    GCNENC_SMEM, // 0000
+    GCNENC_EXP, // 0001
+    GCNENC_NONE, // 0010 - illegal
+    GCNENC_NONE, // 0011 - illegal
+    GCNENC_VOP3A, // 0100
+    GCNENC_VINTRP, // 0101
+    GCNENC_DS,   // 0110
+    GCNENC_FLAT, // 0111
+    GCNENC_MUBUF, // 1000
+    GCNENC_NONE,  // 1001 - illegal
+    GCNENC_MTBUF, // 1010
+    GCNENC_NONE,  // 1011 - illegal
+    GCNENC_MIMG,  // 1100
+    GCNENC_NONE,  // 1101 - illegal
+    GCNENC_NONE,  // 1110 - illegal
+    GCNENC_NONE   // 1111 - illegal
+};
+
+static const cxbyte gcnEncoding15Table[16] =
+{
+    GCNENC_NONE, // 0000
+    GCNENC_NONE, // 0001
+    GCNENC_VINTRP, // 0010
+    GCNENC_VOP3P, // 0011
+    GCNENC_NONE, // 0100
+    GCNENC_VOP3A, // 0101
+    GCNENC_DS,   // 0110
+    GCNENC_FLAT, // 0111
+    GCNENC_MUBUF, // 1000
+    GCNENC_NONE, // 1001 - illegal
+    GCNENC_MTBUF, // 1010
+    GCNENC_NONE,  // 1011 - illegal
+    GCNENC_MIMG,  // 1100
+    GCNENC_SMEM,  // 1101
+    GCNENC_EXP,   // 1110
+    GCNENC_NONE   // 1111 - illegal
+};
+
+// literal (extra words) predicates for GCN encoding classifier
+enum : cxbyte
+{
+    GCNCLSLIT_NONE = 0,
+    GCNCLSLIT_SSRC0,    // SOP1: literal if SSRC0 is literal
+    GCNCLSLIT_SSRC01,   // SOP2/SOPC: literal if SSRC0 or SSRC1 is literal
+    GCNCLSLIT_VSRC0,    // VOP1/VOP2/VOPC: literal if SRC0 is literal
+    GCNCLSLIT_VSRC0_SDWA,   // VOP1/VOP2/VOPC: SRC0 is literal, SDWA or DPP (GCN1.2/1.4)
+    GCNCLSLIT_VSRC0_SDWA15, // VOP1/VOP2/VOPC: SRC0 is literal, SDWA or DPP (GCN1.5)
+    GCNCLSLIT_SMRD,     // SMRD (GCN1.1): literal if offset is literal
+    GCNCLSLIT_VOP3,     // VOP3 (GCN1.5): literal if any source in second word is literal
+    GCNCLSLIT_MIMG      // MIMG (GCN1.5): NSA extra words
+};
+
+enum : cxbyte
+{
+    GCNCLS_BRANCH = 1   // SOPK instruction with jump address
+};
+
+// entry of GCN encoding classifier
+struct CLRX_INTERNAL GCNEncodingClassEntry
+{
+    cxbyte encoding;    // GCN encoding
+    cxbyte wordsNum;    // base words number (with constant 32-bit immediate)
+    cxbyte literal;     // literal predicate
+    cxbyte flags;
+};
+
+/* classifier tables for all architectures,
+ * indexed by 9 highest bits of first instruction word */
+static GCNEncodingClassEntry gcnEncodingClassTable[
+            cxuint(GPUArchitecture::GPUARCH_MAX)+1][512];
+
+static void initializeGCNEncodingClassTable(GPUArchitecture arch,
+            GCNEncodingClassEntry* table)
+{
     const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
-    const bool isGCN12 = (arch >= GPUArchitecture::GCN1_2);
-    const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 || arch == GPUArchitecture::GCN1_4_1);
-    const bool isGCN15 = (arch >= GPUArchitecture::GCN1_5 || arch == GPUArchitecture::GCN1_5_1);
-    size_t pos;
-    for (pos = 0; pos < codeWordsNum; pos++)
+    const bool isGCN124 = (arch >= GPUArchitecture::GCN1_2);
+    const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 ||
+                arch == GPUArchitecture::GCN1_4_1);
+    const bool isGCN15 = (arch >= GPUArchitecture::GCN1_5);
+    const cxbyte vsrc0Literal = isGCN15 ? GCNCLSLIT_VSRC0_SDWA15 :
+                (isGCN124 ? GCNCLSLIT_VSRC0_SDWA : GCNCLSLIT_VSRC0);
+    
+    for (cxuint index = 0; index < 512; index++)
     {
-        /* scan all instructions and get jump addresses */
-        const uint32_t insnCode = ULEV(codeWords[pos]);
+        GCNEncodingClassEntry& entry = table[index];
+        entry = { GCNENC_NONE, 1, GCNCLSLIT_NONE, 0 };
+        const uint32_t insnCode = uint32_t(index)<<23;
         if ((insnCode & 0x80000000U) != 0)
         {
             if ((insnCode & 0x40000000U) == 0)
@@ -337,51 +436,29 @@ void GCNDisassembler::analyzeBeforeDisassemble()
                     // SOP1/SOPK/SOPC/SOPP
                     const uint32_t encPart = (insnCode & 0x0f800000U);
                     if (encPart == 0x0e800000U)
-                    {
-                        // SOP1
-                        if ((insnCode&0xff) == 0xff) // literal
-                            pos++;
-                    }
+                        entry = { GCNENC_SOP1, 1, GCNCLSLIT_SSRC0, 0 };
                     else if (encPart == 0x0f000000U)
-                    {
-                        // SOPC
-                        if ((insnCode&0xff) == 0xff ||
-                            (insnCode&0xff00) == 0xff00) // literal
-                            pos++;
-                    }
+                        entry = { GCNENC_SOPC, 1, GCNCLSLIT_SSRC01, 0 };
                     else if (encPart == 0x0f800000U)
-                    {
-                        // SOPP
-                        const cxuint opcode = (insnCode>>16)&0x7f;
-                        if (opcode == 2 || (opcode >= 4 && opcode <= 9) ||
-                            // GCN1.1 and GCN1.2 opcodes
-                            ((isGCN11 || isGCN12) &&
-                                    (opcode >= 23 && opcode <= 26))) // if jump
-                            labels.push_back(startOffset +
-                                    ((pos+int16_t(insnCode&0xffff)+1)<<2));
-                    }
+                        entry = { GCNENC_SOPP, 1, GCNCLSLIT_NONE, 0 };
                     else
                     {
                         // SOPK
+                        entry = { GCNENC_SOPK, 1, GCNCLSLIT_NONE, 0 };
                         const cxuint opcode = (insnCode>>23)&0x1f;
-                        if ((!isGCN12 && opcode == 17) ||
-                            (isGCN12 && opcode == 16) || // if branch fork
+                        if ((!isGCN124 && opcode == 17) ||
+                            (isGCN124 && opcode == 16) || // if branch fork
                             (isGCN14 && opcode == 21) || // if s_call_b64
                             (isGCN15 && (opcode == 22 ||
                                 opcode == 27 || opcode == 28))) // if s_subvector_loop_*
-                            labels.push_back(startOffset +
-                                    ((pos+int16_t(insnCode&0xffff)+1)<<2));
-                        else if (((!isGCN12 || isGCN15) && opcode == 21) ||
-                            (isGCN12 && !isGCN15 && opcode == 20))
-                            pos++; // additional literal
+                            entry.flags = GCNCLS_BRANCH;
+                        else if (((!isGCN124 || isGCN15) && opcode == 21) ||
+                            (isGCN124 && !isGCN15 && opcode == 20))
+                            entry.wordsNum = 2; // additional literal
                     }
                 }
-                else
-                {
-                    // SOP2
-                    if ((insnCode&0xff) == 0xff || (insnCode&0xff00) == 0xff00)
-                        pos++;  // literal
-                }
+                else // SOP2
+                    entry = { GCNENC_SOP2, 1, GCNCLSLIT_SSRC01, 0 };
             }
             else
             {
@@ -389,130 +466,145 @@ void GCNDisassembler::analyzeBeforeDisassemble()
                 const uint32_t encPart = (insnCode&0x3c000000U)>>26;
                 if (isGCN15)
                 {
-                    if (gcnSize15Table[encPart]==GCNENCSCH_MIMG_DWORDS)
-                        pos += ((insnCode>>1)&3) + 1;
+                    entry.encoding = gcnEncoding15Table[encPart];
+                    if (gcnSize15Table[encPart] == GCNENCSCH_MIMG_DWORDS)
+                    {
+                        entry.wordsNum = 2;
+                        entry.literal = GCNCLSLIT_MIMG;
+                    }
                     else if (gcnSize15Table[encPart])
-                        pos++;
+                        entry.wordsNum = 2;
+                    if (encPart==3 || encPart==5)
+                        entry.literal = GCNCLSLIT_VOP3; // include VOP3 literal
                 }
-                else if (isGCN11 && encPart==0 && (insnCode&0x1ff)==0xff)
-                    pos++;
-                else if ((!isGCN12 && gcnSize11Table[encPart] && (encPart != 7 || isGCN11)) ||
-                    (isGCN12 && gcnSize12Table[encPart]))
-                    pos++;
-                if (isGCN15 && (encPart==3 || encPart==5))
+                else
                 {
-                    // include VOP3 literal
-                    const uint32_t insnCode2 = ULEV(codeWords[pos]);
-                    if ((insnCode2 & 0x1ff) == 0xff || ((insnCode2>>9) & 0x1ff) == 0xff ||
-                        ((insnCode2>>18) & 0x1ff) == 0xff)
-                        pos++;
+                    entry.encoding = isGCN124 ? gcnEncoding12Table[encPart] :
+                                gcnEncoding11Table[encPart];
+                    if (entry.encoding == GCNENC_FLAT && !isGCN11 && !isGCN124)
+                        entry.encoding = GCNENC_NONE; // illegal if not GCN1.1
+                    if (isGCN11 && encPart==0)
+                        entry.literal = GCNCLSLIT_SMRD;
+                    else if ((!isGCN124 && gcnSize11Table[encPart] &&
+                                (encPart != 7 || isGCN11)) ||
+                            (isGCN124 && gcnSize12Table[encPart]))
+                        entry.wordsNum = 2;
                 }
             }
         }
         else
         {
-            uint32_t src0 = (insnCode&0x1ff);
             // some vector instructions
             if ((insnCode & 0x7e000000U) == 0x7c000000U)
-            {
-                // VOPC
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                    pos++;
-            }
+                entry = { GCNENC_VOPC, 1, vsrc0Literal, 0 };
             else if ((insnCode & 0x7e000000U) == 0x7e000000U)
-            {
-                // VOP1
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                    pos++;
-            }
+                entry = { GCNENC_VOP1, 1, vsrc0Literal, 0 };
             else
             {
                 // VOP2
+                entry = { GCNENC_VOP2, 1, vsrc0Literal, 0 };
                 const cxuint opcode = (insnCode >> 25)&0x3f;
-                if ((!isGCN12 && (opcode == 32 || opcode == 33)) ||
-                    (isGCN12 && !isGCN15 && (opcode == 23 || opcode == 24 ||
+                if ((!isGCN124 && (opcode == 32 || opcode == 33)) ||
+                    (isGCN124 && !isGCN15 && (opcode == 23 || opcode == 24 ||
                     opcode == 36 || opcode == 37)) ||
                     (isGCN15 && (opcode == 32 || opcode == 33 || // V_MADMK and V_MADAK
                         opcode == 44 || opcode == 45 || // V_FMAMK_F32, V_FMAAK_F32
                         opcode == 55 || opcode == 56))) // V_FMAMK_F16, V_FMAAK_F16
-                    pos++;  // inline 32-bit constant
-                else if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN12 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                    pos++;  // literal
+                {
+                    // inline 32-bit constant
+                    entry.wordsNum = 2;
+                    entry.literal = GCNCLSLIT_NONE;
+                }
             }
         }
     }
-    
-    instrOutOfCode = (pos != codeWordsNum);
 }
 
-static const cxbyte gcnEncoding11Table[16] =
+static void initializeGCNEncodingClassTables()
 {
-    GCNENC_SMRD, // 0000
-    GCNENC_SMRD, // 0001
-    GCNENC_VINTRP, // 0010
-    GCNENC_NONE, // 0011 - illegal
-    GCNENC_VOP3A, // 0100
-    GCNENC_NONE, // 0101 - illegal
-    GCNENC_DS,   // 0110
-    GCNENC_FLAT, // 0111
-    GCNENC_MUBUF, // 1000
-    GCNENC_NONE,  // 1001 - illegal
-    GCNENC_MTBUF, // 1010
-    GCNENC_NONE,  // 1011 - illegal
-    GCNENC_MIMG,  // 1100
-    GCNENC_NONE,  // 1101 - illegal
-    GCNENC_EXP,   // 1110
-    GCNENC_NONE   // 1111 - illegal
-};
+    for (cxuint i = 0; i <= cxuint(GPUArchitecture::GPUARCH_MAX); i++)
+        initializeGCNEncodingClassTable(GPUArchitecture(i), gcnEncodingClassTable[i]);
+}
 
-static const cxbyte gcnEncoding12Table[16] =
+// classify instruction: returns its encoding and words number (with literals)
+static inline cxuint classifyGCNInstruction(const GCNEncodingClassEntry* classTable,
+            const uint32_t* codeWords, size_t pos, size_t codeWordsNum,
+            cxbyte& encoding, cxbyte& flags)
 {
-    GCNENC_SMEM, // 0000
-    GCNENC_EXP, // 0001
-    GCNENC_NONE, // 0010 - illegal
-    GCNENC_NONE, // 0011 - illegal
-    GCNENC_VOP3A, // 0100
-    GCNENC_VINTRP, // 0101
-    GCNENC_DS,   // 0110
-    GCNENC_FLAT, // 0111
-    GCNENC_MUBUF, // 1000
-    GCNENC_NONE,  // 1001 - illegal
-    GCNENC_MTBUF, // 1010
-    GCNENC_NONE,  // 1011 - illegal
-    GCNENC_MIMG,  // 1100
-    GCNENC_NONE,  // 1101 - illegal
-    GCNENC_NONE,  // 1110 - illegal
-    GCNENC_NONE   // 1111 - illegal
-};
+    const uint32_t insnCode = ULEV(codeWords[pos]);
+    const GCNEncodingClassEntry& entry = classTable[insnCode>>23];
+    encoding = entry.encoding;
+    flags = entry.flags;
+    const uint32_t src0 = insnCode&0x1ff;
+    switch(entry.literal)
+    {
+        case GCNCLSLIT_NONE:
+            return entry.wordsNum;
+        case GCNCLSLIT_SSRC0:
+            return entry.wordsNum + ((insnCode&0xff) == 0xff);
+        case GCNCLSLIT_SSRC01:
+            return entry.wordsNum + ((insnCode&0xff) == 0xff ||
+                        (insnCode&0xff00) == 0xff00);
+        case GCNCLSLIT_VSRC0:
+        case GCNCLSLIT_SMRD:
+            return entry.wordsNum + (src0 == 0xff);
+        case GCNCLSLIT_VSRC0_SDWA:
+            return entry.wordsNum + (src0 == 0xff || src0 == 0xf9 || src0 == 0xfa);
+        case GCNCLSLIT_VSRC0_SDWA15:
+            return entry.wordsNum + (src0 == 0xff || src0 == 0xf9 || src0 == 0xfa ||
+                        src0 == 0xe9 || src0 == 0xea);
+        case GCNCLSLIT_VOP3:
+        {
+            if (pos+1 >= codeWordsNum)
+                return entry.wordsNum;
+            const uint32_t insnCode2 = ULEV(codeWords[pos+1]);
+            return entry.wordsNum + ((insnCode2 & 0x1ff) == 0xff ||
+                    ((insnCode2>>9) & 0x1ff) == 0xff ||
+                    ((insnCode2>>18) & 0x1ff) == 0xff);
+        }
+        case GCNCLSLIT_MIMG:
+            return entry.wordsNum + ((insnCode>>1)&3);
+        default:
+            return entry.wordsNum;
+    }
+}
 
-static const cxbyte gcnEncoding15Table[16] =
+void GCNDisassembler::analyzeBeforeDisassemble()
 {
-    GCNENC_NONE, // 0000
-    GCNENC_NONE, // 0001
-    GCNENC_VINTRP, // 0010
-    GCNENC_VOP3P, // 0011
-    GCNENC_NONE, // 0100
-    GCNENC_VOP3A, // 0101
-    GCNENC_DS,   // 0110
-    GCNENC_FLAT, // 0111
-    GCNENC_MUBUF, // 1000
-    GCNENC_NONE, // 1001 - illegal
-    GCNENC_MTBUF, // 1010
-    GCNENC_NONE,  // 1011 - illegal
-    GCNENC_MIMG,  // 1100
-    GCNENC_SMEM,  // 1101
-    GCNENC_EXP,   // 1110
-    GCNENC_NONE   // 1111 - illegal
-};
+    const uint32_t* codeWords = reinterpret_cast<const uint32_t*>(input);
+    const size_t codeWordsNum = (inputSize>>2);
+
+    const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
+                disassembler.getDeviceType());
+    const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
+    const bool isGCN12 = (arch >= GPUArchitecture::GCN1_2);
+    const GCNEncodingClassEntry* classTable = gcnEncodingClassTable[cxuint(arch)];
+    size_t pos;
+    for (pos = 0; pos < codeWordsNum; )
+    {
+        /* scan all instructions and get jump addresses */
+        cxbyte encoding, flags;
+        const cxuint wordsNum = classifyGCNInstruction(classTable, codeWords, pos,
+                    codeWordsNum, encoding, flags);
+        if (encoding == GCNENC_SOPP)
+        {
+            const uint32_t insnCode = ULEV(codeWords[pos]);
+            const cxuint opcode = (insnCode>>16)&0x7f;
+            if (opcode == 2 || (opcode >= 4 && opcode <= 9) ||
+                // GCN1.1 and GCN1.2 opcodes
+                ((isGCN11 || isGCN12) &&
+                        (opcode >= 23 && opcode <= 26))) // if jump
+                labels.push_back(startOffset +
+                        ((pos+int16_t(insnCode&0xffff)+1)<<2));
+        }
+        else if ((flags & GCNCLS_BRANCH) != 0)
+            labels.push_back(startOffset +
+                    ((pos+int16_t(ULEV(codeWords[pos])&0xffff)+1)<<2));
+        pos += wordsNum;
+    }
+    
+    instrOutOfCode = (pos != codeWordsNum);
+}
 
 
 struct CLRX_INTERNAL GCNEncodingOpcodeBits
@@ -596,6 +688,110 @@ static const GCNEncodingOpcodeBits gcnEncodingOpcode15Table[GCNENC_MAXVAL+2] =
     { 16, 7 } /* GCNENC_VOP3P, opcode = (7bit)<<16 */
 };
 
+// find instruction by encoding and opcode (returns null if instruction is illegal)
+// baseEncoding - encoding of instruction from main table (used for illegal instructions)
+static const GCNInstruction* findGCNInstrByCode(GPUArchitecture arch, cxbyte gcnEncoding,
+            uint32_t insnCode, uint32_t insnCode2, cxuint& opcode, cxbyte& baseEncoding)
+{
+    const bool isGCN124 = (arch >= GPUArchitecture::GCN1_2);
+    const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 ||
+                arch == GPUArchitecture::GCN1_4_1);
+    const bool isGCN15 = (arch >= GPUArchitecture::GCN1_5);
+    const GPUArchMask curArchMask = 1U<<int(arch);
+    
+    const GCNEncodingOpcodeBits* encodingOpcodeTable =
+            (isGCN15) ? gcnEncodingOpcode15Table :
+            ((isGCN124) ? gcnEncodingOpcode12Table : gcnEncodingOpcodeTable);
+    opcode = (insnCode>>encodingOpcodeTable[gcnEncoding].bitPos) & 
+            ((1U<<encodingOpcodeTable[gcnEncoding].bits)-1U);
+    if (encodingOpcodeTable[gcnEncoding].bitPos2!=0)
+    {
+        // next bits in opcode
+        cxuint val = 0;
+        if (encodingOpcodeTable[gcnEncoding].bitPos2>=32)
+            val = (insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2-32));
+        else
+            val = insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2);
+        opcode |= (val&((1U<<encodingOpcodeTable[gcnEncoding].bits2)-1U)) <<
+                    encodingOpcodeTable[gcnEncoding].bits;
+    }
+    
+    const GCNEncodingSpace& encSpace =
+        (isGCN15) ? gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + gcnEncoding] :
+        ((isGCN124) ? gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+3 + gcnEncoding] :
+          gcnInstrTableByCodeSpaces[gcnEncoding]);
+    const GCNInstruction* gcnInsn = gcnInstrTableByCode.get() +
+            encSpace.offset + opcode;
+    
+    baseEncoding = gcnInsn->encoding;
+    
+    // try to replace by FMA_MIX for VEGA20
+    if ((curArchMask&ARCH_VEGA20) != 0 && gcnInsn->code>=928 && gcnInsn->code<=930)
+    {
+        const GCNEncodingSpace& encSpace4 =
+            gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 + 1];
+        const GCNInstruction* thisGCNInstr =
+                gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (thisGCNInstr->mnemonic != nullptr)
+            // replace
+            gcnInsn = thisGCNInstr;
+    }
+    
+    bool isIllegal = false;
+    if (!isGCN124 && gcnInsn->mnemonic != nullptr &&
+        (curArchMask & gcnInsn->archMask) == 0 &&
+        gcnEncoding == GCNENC_VOP3A)
+    {    /* new overrides (VOP3A) */
+        const GCNEncodingSpace& encSpace2 =
+                gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+1];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace2.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (isGCN14 && gcnInsn->mnemonic != nullptr &&
+        (curArchMask & gcnInsn->archMask) == 0 &&
+        (gcnEncoding == GCNENC_VOP3A || gcnEncoding == GCNENC_VOP2 ||
+            gcnEncoding == GCNENC_VOP1))
+    {
+        /* new overrides (VOP1/VOP3A/VOP2 for GCN 1.4) */
+        const GCNEncodingSpace& encSpace4 =
+                gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 +
+                        (gcnEncoding != GCNENC_VOP2) +
+                        (gcnEncoding == GCNENC_VOP1)];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (isGCN14 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
+    {
+        // GLOBAL_/SCRATCH_* instructions
+        const GCNEncodingSpace& encSpace4 =
+            gcnInstrTableByCodeSpaces[2*(GCNENC_MAXVAL+1)+2+3 +
+                ((insnCode>>14)&3)-1];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (isGCN15 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
+    {
+        // GLOBAL_/SCRATCH_* instructions
+        const GCNEncodingSpace& encSpace4 =
+            gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + GCNENC_VOP3P +
+                ((insnCode>>14)&3)];
+        gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
+        if (gcnInsn->mnemonic == nullptr ||
+                (curArchMask & gcnInsn->archMask) == 0)
+            isIllegal = true; // illegal
+    }
+    else if (gcnInsn->mnemonic == nullptr ||
+        (curArchMask & gcnInsn->archMask) == 0)
+        isIllegal = true;
+    return isIllegal ? nullptr : gcnInsn;
+}
+
 /* main routine */
 
 void GCNDisassembler::disassemble()
@@ -616,12 +812,11 @@ void GCNDisassembler::disassemble()
     const GPUArchitecture arch = getGPUArchitectureFromDeviceType(
                 disassembler.getDeviceType());
     // set up GCN indicators
-    const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
     const bool isGCN124 = (arch >= GPUArchitecture::GCN1_2);
-    const bool isGCN14 = (arch == GPUArchitecture::GCN1_4 || arch == GPUArchitecture::GCN1_4_1);
     const bool isGCN15 = (arch == GPUArchitecture::GCN1_5 || arch >= GPUArchitecture::GCN1_5_1);
     const GPUArchMask curArchMask = 
             1U<<int(getGPUArchitectureFromDeviceType(disassembler.getDeviceType()));
+    const GCNEncodingClassEntry* classTable = gcnEncodingClassTable[cxuint(arch)];
     const size_t codeWordsNum = (inputSize>>2);
     
     if ((inputSize&3) != 0)
@@ -665,170 +860,19 @@ void GCNDisassembler::disassemble()
         uint32_t insnCode5 = 0;
         
         /* determine GCN encoding */
-        if ((insnCode & 0x80000000U) != 0)
-        {
-            if ((insnCode & 0x40000000U) == 0)
-            {
-                // SOP???
-                if  ((insnCode & 0x30000000U) == 0x30000000U)
-                {
-                    // SOP1/SOPK/SOPC/SOPP
-                    const uint32_t encPart = (insnCode & 0x0f800000U);
-                    if (encPart == 0x0e800000U)
-                    {
-                        // SOP1
-                        if ((insnCode&0xff) == 0xff) // literal
-                        {
-                            if (pos < codeWordsNum)
-                                insnCode2 = ULEV(codeWords[pos++]);
-                        }
-                        gcnEncoding = GCNENC_SOP1;
-                    }
-                    else if (encPart == 0x0f000000U)
-                    {
-                        // SOPC
-                        if ((insnCode&0xff) == 0xff ||
-                            (insnCode&0xff00) == 0xff00) // literal
-                        {
-                            if (pos < codeWordsNum)
-                                insnCode2 = ULEV(codeWords[pos++]);
-                        }
-                        gcnEncoding = GCNENC_SOPC;
-                    }
-                    else if (encPart == 0x0f800000U) // SOPP
-                        gcnEncoding = GCNENC_SOPP;
-                    else // SOPK
-                    {
-                        gcnEncoding = GCNENC_SOPK;
-                        const uint32_t opcode = ((insnCode>>23)&0x1f);
-                        if (((!isGCN124 || isGCN15) && opcode == 21) ||
-                            (isGCN124 && !isGCN15 && opcode == 20))
-                        {
-                            if (pos < codeWordsNum)
-                                insnCode2 = ULEV(codeWords[pos++]);
-                        }
-                    }
-                }
-                else
-                {
-                    // SOP2
-                    if ((insnCode&0xff) == 0xff || (insnCode&0xff00) == 0xff00)
-                    {
-                        // literal
-                        if (pos < codeWordsNum)
-                            insnCode2 = ULEV(codeWords[pos++]);
-                    }
-                    gcnEncoding = GCNENC_SOP2;
-                }
-            }
-            else
-            {
-                // SMRD and others
-                const uint32_t encPart = (insnCode&0x3c000000U)>>26;
-                if (isGCN15)
-                {
-                    if (gcnSize15Table[encPart]==GCNENCSCH_MIMG_DWORDS)
-                    {
-                        cxuint extraDwords = ((insnCode>>1)&3) + 1;
-                        if (pos+extraDwords <= codeWordsNum)
-                        {
-                            if (extraDwords>=1)
-                                insnCode2 = ULEV(codeWords[pos]);
-                            if (extraDwords>=2)
-                                insnCode3 = ULEV(codeWords[pos+1]);
-                            if (extraDwords>=3)
-                                insnCode4 = ULEV(codeWords[pos+2]);
-                            if (extraDwords>=4)
-                                insnCode5 = ULEV(codeWords[pos+3]);
-                            pos += extraDwords;
-                        }
-                    }
-                    if (gcnSize15Table[encPart] && pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                    if (isGCN15 && (encPart==3 || encPart==5))
-                    {
-                        // include VOP3 literal
-                        if ((insnCode2 & 0x1ff) == 0xff || ((insnCode2>>9) & 0x1ff) == 0xff ||
-                            ((insnCode2>>18) & 0x1ff) == 0xff)
-                            insnCode3 = ULEV(codeWords[pos++]);
-                    }
-                }
-                else if (isGCN11 && encPart==0 && (insnCode&0x1ff)==0xff)
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                else if ((!isGCN124 && gcnSize11Table[encPart] && (encPart != 7 || isGCN11)) ||
-                    (isGCN124 && gcnSize12Table[encPart]))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                if (isGCN15)
-                    gcnEncoding = gcnEncoding15Table[encPart];
-                else if (isGCN124)
-                    gcnEncoding = gcnEncoding12Table[encPart];
-                else
-                    gcnEncoding = gcnEncoding11Table[encPart];
-                if (gcnEncoding == GCNENC_FLAT && !isGCN11 && !isGCN124)
-                    gcnEncoding = GCNENC_NONE; // illegal if not GCN1.1
-            }
-        }
-        else
-        {
-            // some vector instructions
-            const uint32_t src0 = (insnCode&0x1ff);
-            if ((insnCode & 0x7e000000U) == 0x7c000000U)
-            {
-                // VOPC
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN124 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                gcnEncoding = GCNENC_VOPC;
-            }
-            else if ((insnCode & 0x7e000000U) == 0x7e000000U)
-            {
-                // VOP1
-                if (src0 == 0xff || // literal
-                    // SDWA, DPP
-                    (isGCN124 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                gcnEncoding = GCNENC_VOP1;
-            }
-            else
-            {
-                // VOP2
-                const cxuint opcode = (insnCode >> 25)&0x3f;
-                if ((!isGCN124 && (opcode == 32 || opcode == 33)) ||
-                    (isGCN124 && !isGCN15 && (opcode == 23 || opcode == 24 ||
-                    opcode == 36 || opcode == 37)) ||
-                    (isGCN15 && (opcode == 32 || opcode == 33 || // V_MADMK and V_MADAK
-                        opcode == 44 || opcode == 45 || // V_FMAMK_F32, V_FMAAK_F32
-                        opcode == 55 || opcode == 56))) // V_MADMK and V_MADAK
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                else if (src0 == 0xff || // literal
-                    // SDWA, DDP
-                    (isGCN124 && (src0 == 0xf9 || src0 == 0xfa)) ||
-                    (isGCN15 && (src0 == 0xe9 || src0 == 0xea)))
-                {
-                    if (pos < codeWordsNum)
-                        insnCode2 = ULEV(codeWords[pos++]);
-                }
-                gcnEncoding = GCNENC_VOP2;
-            }
-        }
+        cxbyte classFlags;
+        const cxuint wordsNum = classifyGCNInstruction(classTable, codeWords, oldPos,
+                    codeWordsNum, gcnEncoding, classFlags);
+        // get rest of instruction words (if they are in code)
+        const size_t endPos = std::min(oldPos + wordsNum, codeWordsNum);
+        if (pos < endPos)
+            insnCode2 = ULEV(codeWords[pos++]);
+        if (pos < endPos)
+            insnCode3 = ULEV(codeWords[pos++]);
+        if (pos < endPos)
+            insnCode4 = ULEV(codeWords[pos++]);
+        if (pos < endPos)
+            insnCode5 = ULEV(codeWords[pos++]);
         
         prevIsTwoWord = (oldPos+2 == pos);
         
@@ -904,101 +948,15 @@ void GCNDisassembler::disassemble()
         }
         else
         {
-            const GCNEncodingOpcodeBits* encodingOpcodeTable =
-                    (isGCN15) ? gcnEncodingOpcode15Table :
-                    ((isGCN124) ? gcnEncodingOpcode12Table : gcnEncodingOpcodeTable);
-            cxuint opcode =
-                    (insnCode>>encodingOpcodeTable[gcnEncoding].bitPos) & 
-                    ((1U<<encodingOpcodeTable[gcnEncoding].bits)-1U);
-            if (encodingOpcodeTable[gcnEncoding].bitPos2!=0)
-            {
-                // next bits in opcode
-                cxuint val = 0;
-                if (encodingOpcodeTable[gcnEncoding].bitPos2>=32)
-                    val = (insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2-32));
-                else
-                    val = insnCode2>>(encodingOpcodeTable[gcnEncoding].bitPos2);
-                opcode |= (val&((1U<<encodingOpcodeTable[gcnEncoding].bits2)-1U)) <<
-                            encodingOpcodeTable[gcnEncoding].bits;
-            }
-            
-            /* decode instruction and put to output */
-            const GCNEncodingSpace& encSpace =
-                (isGCN15) ? gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + gcnEncoding] :
-                ((isGCN124) ? gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+3 + gcnEncoding] :
-                  gcnInstrTableByCodeSpaces[gcnEncoding]);
-            const GCNInstruction* gcnInsn = gcnInstrTableByCode.get() +
-                    encSpace.offset + opcode;
-            
-            const GCNInstruction defaultInsn = { nullptr, gcnInsn->encoding, GCN_STDMODE,
+            cxuint opcode;
+            cxbyte baseEncoding;
+            const GCNInstruction* gcnInsn = findGCNInstrByCode(arch, gcnEncoding,
+                        insnCode, insnCode2, opcode, baseEncoding);
+            const GCNInstruction defaultInsn = { nullptr, baseEncoding, GCN_STDMODE,
                         0, 0 };
             
-            // try to replace by FMA_MIX for VEGA20
-            if ((curArchMask&ARCH_VEGA20) != 0 && gcnInsn->code>=928 && gcnInsn->code<=930)
-            {
-                const GCNEncodingSpace& encSpace4 =
-                    gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 + 1];
-                const GCNInstruction* thisGCNInstr =
-                        gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (thisGCNInstr->mnemonic != nullptr)
-                    // replace
-                    gcnInsn = thisGCNInstr;
-            }
-            
             cxuint spacesToAdd = 16;
-            bool isIllegal = false;
-            if (!isGCN124 && gcnInsn->mnemonic != nullptr &&
-                (curArchMask & gcnInsn->archMask) == 0 &&
-                gcnEncoding == GCNENC_VOP3A)
-            {    /* new overrides (VOP3A) */
-                const GCNEncodingSpace& encSpace2 =
-                        gcnInstrTableByCodeSpaces[GCNENC_MAXVAL+1];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace2.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (isGCN14 && gcnInsn->mnemonic != nullptr &&
-                (curArchMask & gcnInsn->archMask) == 0 &&
-                (gcnEncoding == GCNENC_VOP3A || gcnEncoding == GCNENC_VOP2 ||
-                    gcnEncoding == GCNENC_VOP1))
-            {
-                /* new overrides (VOP1/VOP3A/VOP2 for GCN 1.4) */
-                const GCNEncodingSpace& encSpace4 =
-                        gcnInstrTableByCodeSpaces[2*GCNENC_MAXVAL+4 +
-                                (gcnEncoding != GCNENC_VOP2) +
-                                (gcnEncoding == GCNENC_VOP1)];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (isGCN14 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
-            {
-                // GLOBAL_/SCRATCH_* instructions
-                const GCNEncodingSpace& encSpace4 =
-                    gcnInstrTableByCodeSpaces[2*(GCNENC_MAXVAL+1)+2+3 +
-                        ((insnCode>>14)&3)-1];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (isGCN15 && gcnEncoding == GCNENC_FLAT && ((insnCode>>14)&3)!=0)
-            {
-                // GLOBAL_/SCRATCH_* instructions
-                const GCNEncodingSpace& encSpace4 =
-                    gcnInstrTableByCodeSpaces[GCN_GFX10_ENCSPACE_IDX + GCNENC_VOP3P +
-                        ((insnCode>>14)&3)];
-                gcnInsn = gcnInstrTableByCode.get() + encSpace4.offset + opcode;
-                if (gcnInsn->mnemonic == nullptr ||
-                        (curArchMask & gcnInsn->archMask) == 0)
-                    isIllegal = true; // illegal
-            }
-            else if (gcnInsn->mnemonic == nullptr ||
-                (curArchMask & gcnInsn->archMask) == 0)
-                isIllegal = true;
-            
+            const bool isIllegal = (gcnInsn == nullptr);
             if (!isIllegal)
             {
                 // put spaces between mnemonic and operands
@@ -1135,3 +1093,317 @@ void GCNDisassembler::disassemble()
     output.flush();
     disassembler.getOutput().flush();
 }
+
+/*
+ * streaming GCN instruction decoder
+ */
+
+GCNInstrDecoder::GCNInstrDecoder(GPUDeviceType deviceType, size_t codeSize,
+            const cxbyte* code, size_t _startOffset)
+        : arch(getGPUArchitectureFromDeviceType(deviceType)),
+          codeWords(reinterpret_cast<const uint32_t*>(code)),
+          codeWordsNum(codeSize>>2), pos(0), startOffset(_startOffset)
+{
+    callOnce(clrxGCNDisasmOnceFlag, initializeGCNDisassembler);
+}
+
+static inline void addGCNDecodedOperand(GCNDecodedInstr& instr, cxbyte field,
+            cxuint code)
+{
+    GCNDecodedOperand& operand = instr.operands[instr.operandsNum++];
+    operand.field = field;
+    operand.code = code;
+}
+
+// decode source of VOP1/VOP2/VOPC (with SDWA and DPP)
+static void decodeGCNVOPSrc0(GCNDecodedInstr& instr, bool isGCN14, uint32_t insnCode,
+            uint32_t insnCode2, cxuint wordsNum)
+{
+    const cxuint src0 = insnCode&0x1ff;
+    if (src0 == 0xf9 && wordsNum == 2)
+    {
+        // SDWA
+        instr.modifiers |= GCNDECMOD_SDWA;
+        const cxuint sdwaSrc0 = insnCode2&0xff;
+        addGCNDecodedOperand(instr, GCNFIELD_DPPSDWA_SRC0,
+                (isGCN14 && (insnCode2 & (1U<<23))!=0) ? sdwaSrc0 : 256+sdwaSrc0);
+        instr.modifiers |= (((insnCode2>>20)&1) ? GCNDECMOD_NEG0 : 0) |
+                (((insnCode2>>21)&1) ? GCNDECMOD_ABS0 : 0) |
+                (((insnCode2>>28)&1) ? GCNDECMOD_NEG1 : 0) |
+                (((insnCode2>>29)&1) ? GCNDECMOD_ABS1 : 0) |
+                (((insnCode2>>13)&1) ? GCNDECMOD_CLAMP : 0);
+        instr.haveLiteral = false;
+    }
+    else if ((src0 == 0xfa || src0 == 0xe9 || src0 == 0xea) && wordsNum == 2)
+    {
+        // DPP
+        instr.modifiers |= GCNDECMOD_DPP;
+        addGCNDecodedOperand(instr, GCNFIELD_DPPSDWA_SRC0, 256 + (insnCode2&0xff));
+        if (src0 == 0xfa)
+            instr.modifiers |= (((insnCode2>>20)&1) ? GCNDECMOD_NEG0 : 0) |
+                    (((insnCode2>>21)&1) ? GCNDECMOD_ABS0 : 0) |
+                    (((insnCode2>>22)&1) ? GCNDECMOD_NEG1 : 0) |
+                    (((insnCode2>>23)&1) ? GCNDECMOD_ABS1 : 0);
+        instr.haveLiteral = false;
+    }
+    else
+        addGCNDecodedOperand(instr, GCNFIELD_VOP_SRC0, src0);
+}
+
+bool GCNInstrDecoder::next(GCNDecodedInstr& instr)
+{
+    if (pos >= codeWordsNum)
+        return false;
+    const bool isGCN11 = (arch == GPUArchitecture::GCN1_1);
+    const bool isGCN124 = (arch >= GPUArchitecture::GCN1_2);
+    const bool isGCN14 = (arch >= GPUArchitecture::GCN1_4);
+    const bool isGCN15 = (arch >= GPUArchitecture::GCN1_5);
+    
+    cxbyte gcnEncoding, classFlags;
+    cxuint wordsNum = classifyGCNInstruction(gcnEncodingClassTable[cxuint(arch)],
+                codeWords, pos, codeWordsNum, gcnEncoding, classFlags);
+    wordsNum = std::min(size_t(wordsNum), codeWordsNum - pos);
+    const uint32_t insnCode = ULEV(codeWords[pos]);
+    const uint32_t insnCode2 = (wordsNum >= 2) ? ULEV(codeWords[pos+1]) : 0;
+    const uint32_t insnCode3 = (wordsNum >= 3) ? ULEV(codeWords[pos+2]) : 0;
+    
+    if (isGCN15 && gcnEncoding == GCNENC_VOP3P && (insnCode & 0x3000000U)!=0)
+    {
+        // unknown encoding (same as in disassembler)
+        gcnEncoding = GCNENC_NONE;
+        wordsNum--;
+    }
+    
+    instr.offset = startOffset + (pos<<2);
+    instr.words = codeWords + pos;
+    instr.wordsNum = wordsNum;
+    instr.encoding = GCNEncoding(gcnEncoding);
+    instr.opcode = 0;
+    instr.mnemonic = nullptr;
+    instr.operandsNum = 0;
+    instr.haveLiteral = false;
+    instr.literal = 0;
+    instr.imm = 0;
+    instr.modifiers = 0;
+    instr.omod = 0;
+    pos += wordsNum;
+    
+    if (gcnEncoding == GCNENC_NONE)
+    {
+        instr.modifiers = GCNDECMOD_ILLEGAL;
+        return true;
+    }
+    
+    cxuint opcode;
+    cxbyte baseEncoding;
+    const GCNInstruction* gcnInsn = findGCNInstrByCode(arch, gcnEncoding,
+                insnCode, insnCode2, opcode, baseEncoding);
+    instr.opcode = opcode;
+    if (gcnInsn != nullptr)
+    {
+        instr.mnemonic = gcnInsn->mnemonic;
+        if (gcnInsn->encoding == GCNENC_VOP3B)
+            instr.encoding = GCNEncoding::VOP3B;
+    }
+    else
+        instr.modifiers |= GCNDECMOD_ILLEGAL;
+    
+    // literal or 32-bit constant in second word
+    if (wordsNum == 2 && gcnEncoding <= GCNENC_VOP2 &&
+        (gcnEncoding != GCNENC_SMRD || !isGCN124))
+    {
+        instr.haveLiteral = true;
+        instr.literal = insnCode2;
+    }
+    
+    switch(gcnEncoding)
+    {
+        case GCNENC_SOPC:
+            addGCNDecodedOperand(instr, GCNFIELD_SSRC0, insnCode&0xff);
+            addGCNDecodedOperand(instr, GCNFIELD_SSRC1, (insnCode>>8)&0xff);
+            break;
+        case GCNENC_SOPP:
+            instr.imm = int16_t(insnCode&0xffff);
+            break;
+        case GCNENC_SOP1:
+            addGCNDecodedOperand(instr, GCNFIELD_SDST, (insnCode>>16)&0x7f);
+            addGCNDecodedOperand(instr, GCNFIELD_SSRC0, insnCode&0xff);
+            break;
+        case GCNENC_SOP2:
+            addGCNDecodedOperand(instr, GCNFIELD_SDST, (insnCode>>16)&0x7f);
+            addGCNDecodedOperand(instr, GCNFIELD_SSRC0, insnCode&0xff);
+            addGCNDecodedOperand(instr, GCNFIELD_SSRC1, (insnCode>>8)&0xff);
+            break;
+        case GCNENC_SOPK:
+            addGCNDecodedOperand(instr, GCNFIELD_SDST, (insnCode>>16)&0x7f);
+            instr.imm = int16_t(insnCode&0xffff);
+            break;
+        case GCNENC_SMRD:
+            if (!isGCN124)
+            {
+                addGCNDecodedOperand(instr, GCNFIELD_SMRD_SDST, (insnCode>>15)&0x7f);
+                addGCNDecodedOperand(instr, GCNFIELD_SMRD_SBASE, (insnCode>>8)&0x7e);
+                if ((insnCode & 0x100) != 0)
+                {
+                    instr.modifiers |= GCNDECMOD_IMM;
+                    instr.imm = insnCode&0xff;
+                }
+                else
+                    addGCNDecodedOperand(instr, GCNFIELD_SMRD_SOFFSET, insnCode&0xff);
+                instr.haveLiteral = isGCN11 && (insnCode&0x1ff) == 0xff && wordsNum == 2;
+            }
+            else
+            {
+                // SMEM
+                addGCNDecodedOperand(instr, GCNFIELD_SMRD_SDST, (insnCode>>6)&0x7f);
+                addGCNDecodedOperand(instr, GCNFIELD_SMRD_SBASE, (insnCode<<1)&0x7e);
+                if ((insnCode & 0x10000) != 0)
+                    instr.modifiers |= GCNDECMOD_GLC;
+                // soffset in second word (SOE or GCN 1.5)
+                const bool soe = isGCN15 || (isGCN14 && (insnCode & 0x4000) != 0);
+                if ((!isGCN15 && (insnCode & 0x20000) != 0) ||
+                    (isGCN15 && (insnCode2>>25) == 0x7d))
+                {
+                    instr.modifiers |= GCNDECMOD_IMM;
+                    instr.imm = insnCode2 & (isGCN14 ? 0x1fffff : 0xfffff);
+                    if (soe && !isGCN15)
+                        addGCNDecodedOperand(instr, GCNFIELD_SMRD_SOFFSET, insnCode2>>25);
+                }
+                else if (soe)
+                {
+                    addGCNDecodedOperand(instr, GCNFIELD_SMRD_SOFFSET, insnCode2>>25);
+                    instr.imm = insnCode2 & 0x1fffff;
+                }
+                else
+                    addGCNDecodedOperand(instr, GCNFIELD_SMRD_SOFFSET, insnCode2&0xff);
+            }
+            break;
+        case GCNENC_VOPC:
+            decodeGCNVOPSrc0(instr, isGCN14, insnCode, insnCode2, wordsNum);
+            addGCNDecodedOperand(instr, GCNFIELD_VOP_VSRC1, 256 + ((insnCode>>9)&0xff));
+            break;
+        case GCNENC_VOP1:
+            addGCNDecodedOperand(instr, GCNFIELD_VOP_VDST, 256 + ((insnCode>>17)&0xff));
+            decodeGCNVOPSrc0(instr, isGCN14, insnCode, insnCode2, wordsNum);
+            break;
+        case GCNENC_VOP2:
+            addGCNDecodedOperand(instr, GCNFIELD_VOP_VDST, 256 + ((insnCode>>17)&0xff));
+            decodeGCNVOPSrc0(instr, isGCN14, insnCode, insnCode2, wordsNum);
+            addGCNDecodedOperand(instr, GCNFIELD_VOP_VSRC1, 256 + ((insnCode>>9)&0xff));
+            break;
+        case GCNENC_VOP3A:
+        case GCNENC_VOP3P:
+            if (instr.encoding == GCNEncoding::VOP3B)
+            {
+                addGCNDecodedOperand(instr, GCNFIELD_VOP3_VDST, 256 + (insnCode&0xff));
+                addGCNDecodedOperand(instr, GCNFIELD_VOP3_SDST1, (insnCode>>8)&0x7f);
+            }
+            else
+            {
+                addGCNDecodedOperand(instr, GCNFIELD_VOP3_VDST, 256 + (insnCode&0xff));
+                if (gcnEncoding != GCNENC_VOP3P)
+                    instr.modifiers |= (insnCode>>8)&7; // abs flags
+            }
+            addGCNDecodedOperand(instr, GCNFIELD_VOP3_SRC0, insnCode2&0x1ff);
+            addGCNDecodedOperand(instr, GCNFIELD_VOP3_SRC1, (insnCode2>>9)&0x1ff);
+            addGCNDecodedOperand(instr, GCNFIELD_VOP3_SRC2, (insnCode2>>18)&0x1ff);
+            instr.modifiers |= ((insnCode2>>29)&7)<<3; // neg flags
+            if ((!isGCN124 && instr.encoding != GCNEncoding::VOP3B &&
+                    (insnCode&0x800) != 0) || (isGCN124 && (insnCode&0x8000) != 0))
+                instr.modifiers |= GCNDECMOD_CLAMP;
+            if (gcnEncoding != GCNENC_VOP3P)
+                instr.omod = (insnCode2>>27)&3;
+            if (wordsNum == 3)
+            {
+                instr.haveLiteral = true;
+                instr.literal = insnCode3;
+            }
+            break;
+        case GCNENC_VINTRP:
+            addGCNDecodedOperand(instr, GCNFIELD_VINTRP_VDST, 256 + ((insnCode>>18)&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_VINTRP_VSRC0, 256 + (insnCode&0xff));
+            instr.imm = (insnCode>>8)&0xff; // attribute<<2 | channel
+            break;
+        case GCNENC_DS:
+            addGCNDecodedOperand(instr, GCNFIELD_DS_ADDR, 256 + (insnCode2&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_DS_DATA0, 256 + ((insnCode2>>8)&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_DS_DATA1, 256 + ((insnCode2>>16)&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_DS_VDST, 256 + (insnCode2>>24));
+            instr.imm = insnCode&0xffff;
+            if (((!isGCN124 || isGCN15) && (insnCode&0x20000)!=0) ||
+                (isGCN124 && !isGCN15 && (insnCode&0x10000)!=0))
+                instr.modifiers |= GCNDECMOD_GDS;
+            break;
+        case GCNENC_MUBUF:
+        case GCNENC_MTBUF:
+            addGCNDecodedOperand(instr, GCNFIELD_M_VADDR, 256 + (insnCode2&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_M_VDATA, 256 + ((insnCode2>>8)&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_M_SRSRC, ((insnCode2>>16)&0x1f)<<2);
+            addGCNDecodedOperand(instr, GCNFIELD_M_SOFFSET, insnCode2>>24);
+            instr.imm = insnCode&0xfff;
+            instr.modifiers |= ((insnCode & 0x1000U) ? GCNDECMOD_OFFEN : 0) |
+                ((insnCode & 0x2000U) ? GCNDECMOD_IDXEN : 0) |
+                ((insnCode & 0x4000U) ? GCNDECMOD_GLC : 0) |
+                ((!isGCN124 && (insnCode & 0x8000U)) ? GCNDECMOD_ADDR64 : 0) |
+                ((gcnEncoding == GCNENC_MUBUF && (insnCode & 0x10000U)) ?
+                        GCNDECMOD_LDS : 0) |
+                ((insnCode2 & 0x800000U) ? GCNDECMOD_TFE : 0);
+            if (((!isGCN124 || isGCN15 || gcnEncoding == GCNENC_MTBUF) &&
+                    (insnCode2 & 0x400000U)!=0) ||
+                ((isGCN124 && !isGCN15 && gcnEncoding != GCNENC_MTBUF) &&
+                    (insnCode & 0x20000)!=0))
+                instr.modifiers |= GCNDECMOD_SLC;
+            break;
+        case GCNENC_MIMG:
+            addGCNDecodedOperand(instr, GCNFIELD_M_VADDR, 256 + (insnCode2&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_M_VDATA, 256 + ((insnCode2>>8)&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_M_SRSRC, (insnCode2>>14)&0x7c);
+            addGCNDecodedOperand(instr, GCNFIELD_MIMG_SSAMP, ((insnCode2>>21)&0x1f)<<2);
+            if (isGCN15 && gcnInsn != nullptr && ((insnCode>>1)&3) != 0)
+            {
+                // NSA addresses (first address in VADDR), skip padding bytes
+                const cxuint vaddrsNum = std::min(
+                        GCNDisasmUtils::getMIMGVAddrsNumGFX10(*gcnInsn, insnCode),
+                        ((insnCode>>1)&3)*4 + 1);
+                for (cxuint i = 1; i < vaddrsNum && 2 + ((i-1)>>2) < wordsNum &&
+                            instr.operandsNum < GCNDECINSTR_MAX_OPERANDS; i++)
+                    addGCNDecodedOperand(instr, GCNFIELD_M_VADDR_MULTI + i,
+                            256 + ((ULEV(instr.words[2 + ((i-1)>>2)])>>
+                                    (((i-1)&3)<<3))&0xff));
+            }
+            instr.imm = (insnCode>>8)&15; // dmask
+            instr.modifiers |= ((insnCode & 0x2000U) ? GCNDECMOD_GLC : 0) |
+                ((insnCode & 0x2000000U) ? GCNDECMOD_SLC : 0) |
+                ((insnCode & 0x10000U) ? GCNDECMOD_TFE : 0);
+            break;
+        case GCNENC_EXP:
+            for (cxuint i = 0; i < 4; i++)
+                addGCNDecodedOperand(instr, GCNFIELD_EXP_VSRC0 + i,
+                        256 + ((insnCode2>>(i<<3))&0xff));
+            instr.imm = (insnCode>>4)&63; // target
+            break;
+        case GCNENC_FLAT:
+        {
+            addGCNDecodedOperand(instr, GCNFIELD_FLAT_ADDR, 256 + (insnCode2&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_FLAT_DATA, 256 + ((insnCode2>>8)&0xff));
+            addGCNDecodedOperand(instr, GCNFIELD_FLAT_VDST, 256 + (insnCode2>>24));
+            const cxuint saddr = (insnCode2>>16)&0x7f;
+            if ((isGCN14 && !isGCN15 && saddr != 0x7f) || (isGCN15 && saddr != 0x7d))
+                addGCNDecodedOperand(instr, GCNFIELD_FLAT_SADDR, saddr);
+            if (isGCN14)
+            {
+                const cxuint offsetMask = isGCN15 ? 0x7ff : 0xfff;
+                instr.imm = (((insnCode>>14)&3) != 0 && (insnCode&0x1000) != 0 &&
+                        !isGCN15) ? -4096+int32_t(insnCode&offsetMask) :
+                        int32_t(insnCode&offsetMask);
+            }
+            instr.modifiers |= ((insnCode & 0x10000U) ? GCNDECMOD_GLC : 0) |
+                ((insnCode & 0x20000U) ? GCNDECMOD_SLC : 0) |
+                ((!isGCN14 && (insnCode2 & 0x800000U)) ? GCNDECMOD_TFE : 0);
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
+}
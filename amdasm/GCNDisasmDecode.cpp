@@ -2426,6 +2426,22 @@ static const GFX10MIMGDimEntry gfx10MImgDimEntryTbl[8] =
     { "2d_msaa_array", 4, 4 }
 };
 
+cxuint GCNDisasmUtils::getMIMGVAddrsNumGFX10(const GCNInstruction& gcnInsn,
+        uint32_t insnCode)
+{
+    const cxuint dim = (insnCode>>3)&7;
+    cxuint daddrsNum = gfx10MImgDimEntryTbl[dim].dwordsNum;
+    if ((gcnInsn.mode & GCN_MIMG_VADERIV)!=0)
+        daddrsNum += gfx10MImgDimEntryTbl[dim].derivsNum;
+    daddrsNum += ((gcnInsn.mode & GCN_MIMG_VA_MIP)!=0) +
+                ((gcnInsn.mode & GCN_MIMG_VA_C)!=0) +
+                ((gcnInsn.mode & GCN_MIMG_VA_CL)!=0) +
+                ((gcnInsn.mode & GCN_MIMG_VA_L)!=0) +
+                ((gcnInsn.mode & GCN_MIMG_VA_B)!=0) +
+                ((gcnInsn.mode & GCN_MIMG_VA_O)!=0);
+    return daddrsNum;
+}
+
 void GCNDisasmUtils::decodeMIMGEncodingGFX10(GCNDisassembler& dasm, cxuint spacesToAdd,
         GPUArchMask arch, const GCNInstruction& gcnInsn, uint32_t insnCode,
         uint32_t insnCode2, uint32_t insnCode3, uint32_t insnCode4, uint32_t insnCode5)
@@ -2455,15 +2471,7 @@ void GCNDisasmUtils::decodeMIMGEncodingGFX10(GCNDisassembler& dasm, cxuint space
     putCommaSpace(bufPtr);
     
     // calculate VADDR registers number
-    cxuint daddrsNum = gfx10MImgDimEntryTbl[dim].dwordsNum;
-    if ((gcnInsn.mode & GCN_MIMG_VADERIV)!=0)
-        daddrsNum += gfx10MImgDimEntryTbl[dim].derivsNum;
-    daddrsNum += ((gcnInsn.mode & GCN_MIMG_VA_MIP)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_C)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_CL)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_L)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_B)!=0) +
-                ((gcnInsn.mode & GCN_MIMG_VA_O)!=0);
+    cxuint daddrsNum = getMIMGVAddrsNumGFX10(gcnInsn, insnCode);
     // print VADDR
     if (extraCodes==0)
         decodeGCNVRegOperand(insnCode2&0xff, daddrsNum, bufPtr);
@@ -118,6 +118,9 @@ struct CLRX_INTERNAL GCNDisasmUtils
     static void decodeMIMGEncoding(GCNDisassembler& dasm, cxuint spacesToAdd,
              GPUArchMask arch, const GCNInstruction& gcnInsn, uint32_t insnCode,
              uint32_t insnCode2);
+    // get number of VADDR registers for GFX10 MIMG instruction
+    static cxuint getMIMGVAddrsNumGFX10(const GCNInstruction& gcnInsn,
+             uint32_t insnCode);
     static void decodeMIMGEncodingGFX10(GCNDisassembler& dasm, cxuint spacesToAdd,
              GPUArchMask arch, const GCNInstruction& gcnInsn, uint32_t insnCode,
              uint32_t insnCode2, uint32_t insnCode3, uint32_t insnCode4,
@@ -0,0 +1,184 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#ifdef HAVE_WINDOWS
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <CLRX/utils/Utilities.h>
+#include "BenchUtils.h"
+
+using namespace CLRX;
+
+/* allocation tracking. every block has header that holds its size.
+ * header size is equal to maximal fundamental alignment */
+
+static const size_t allocHeaderSize = 16;
+static std::atomic<size_t> allocatedMemory(0);
+static std::atomic<size_t> peakMemory(0);
+static std::atomic<uint64_t> allocationsCount(0);
+
+static void* trackedAlloc(size_t size)
+{
+    void* ptr = ::malloc(size + allocHeaderSize);
+    if (ptr == nullptr)
+        return nullptr;
+    *reinterpret_cast<size_t*>(ptr) = size;
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    const size_t current = allocatedMemory.fetch_add(size,
+                std::memory_order_relaxed) + size;
+    size_t peak = peakMemory.load(std::memory_order_relaxed);
+    while (current > peak && !peakMemory.compare_exchange_weak(peak, current,
+                std::memory_order_relaxed));
+    return reinterpret_cast<char*>(ptr) + allocHeaderSize;
+}
+
+static void trackedFree(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+    void* block = reinterpret_cast<char*>(ptr) - allocHeaderSize;
+    allocatedMemory.fetch_sub(*reinterpret_cast<size_t*>(block),
+                std::memory_order_relaxed);
+    ::free(block);
+}
+
+static void* trackedNew(size_t size)
+{
+    while (true)
+    {
+        void* ptr = trackedAlloc(size);
+        if (ptr != nullptr)
+            return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new(size_t size)
+{ return trackedNew(size); }
+
+void* operator new[](size_t size)
+{ return trackedNew(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{ return trackedAlloc(size); }
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{ return trackedAlloc(size); }
+
+void operator delete(void* ptr) noexcept
+{ trackedFree(ptr); }
+
+void operator delete[](void* ptr) noexcept
+{ trackedFree(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{ trackedFree(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{ trackedFree(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept
+{ trackedFree(ptr); }
+
+void operator delete[](void* ptr, size_t) noexcept
+{ trackedFree(ptr); }
+
+namespace CLRX
+{
+
+size_t getBenchAllocatedMemory()
+{ return allocatedMemory.load(std::memory_order_relaxed); }
+
+size_t getBenchPeakMemory()
+{ return peakMemory.load(std::memory_order_relaxed); }
+
+void resetBenchPeakMemory()
+{ peakMemory.store(allocatedMemory.load(std::memory_order_relaxed),
+            std::memory_order_relaxed); }
+
+uint64_t getBenchAllocationsCount()
+{ return allocationsCount.load(std::memory_order_relaxed); }
+
+void listBenchDirectory(const char* dirName, std::vector<std::string>& files)
+{
+    const size_t firstFile = files.size();
+#ifdef HAVE_WINDOWS
+    WIN32_FIND_DATAA findData;
+    const std::string pattern = joinPaths(dirName, "*");
+    HANDLE handle = FindFirstFileA(pattern.c_str(), &findData);
+    if (handle == INVALID_HANDLE_VALUE)
+        throw Exception(std::string("Can't open directory '") + dirName + "'");
+    do {
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+            files.push_back(joinPaths(dirName, findData.cFileName));
+    } while (FindNextFileA(handle, &findData));
+    FindClose(handle);
+#else
+    DIR* dir = ::opendir(dirName);
+    if (dir == nullptr)
+        throw Exception(std::string("Can't open directory '") + dirName + "'");
+    while (const struct dirent* entry = ::readdir(dir))
+    {
+        const std::string path = joinPaths(dirName, entry->d_name);
+        if (!isDirectory(path.c_str()))
+            files.push_back(path);
+    }
+    ::closedir(dir);
+#endif
+    std::sort(files.begin() + firstFile, files.end());
+}
+
+void printBenchResults(std::ostream& os, const char* itemsName,
+            const std::vector<BenchPhaseResult>& results)
+{
+    char buf[200];
+    snprintf(buf, sizeof buf, "%-16s %-20s %12s %14s %10s %12s %12s\n", "Workload",
+             "Phase", "Time [ms]", itemsName, "MB/s", "Peak [KB]", "Allocs");
+    os << buf;
+    for (const BenchPhaseResult& result: results)
+    {
+        char itemsBuf[20] = "-";
+        char bytesBuf[20] = "-";
+        if (result.items != 0 && result.time > 0.0)
+            snprintf(itemsBuf, sizeof itemsBuf, "%.0f", result.items / result.time);
+        if (result.bytes != 0 && result.time > 0.0)
+            snprintf(bytesBuf, sizeof bytesBuf, "%.2f",
+                     result.bytes / result.time / 1048576.0);
+        snprintf(buf, sizeof buf, "%-16s %-20s %12.3f %14s %10s %12zu %12llu\n",
+                 result.workload, result.phase, result.time*1000.0, itemsBuf, bytesBuf,
+                 (result.peakMemory+1023)>>10, (unsigned long long)result.allocations);
+        os << buf;
+    }
+    os.flush();
+}
+
+};
@@ -0,0 +1,114 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __CLRX_BENCHUTILS_H__
+#define __CLRX_BENCHUTILS_H__
+
+#include <CLRX/Config.h>
+#include <cstdint>
+#include <chrono>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace CLRX
+{
+
+/* memory statistics - collected by replaced global operator new/delete */
+
+// get number of bytes currently allocated by operator new
+size_t getBenchAllocatedMemory();
+// get peak of allocated memory since last resetBenchPeakMemory
+size_t getBenchPeakMemory();
+// set peak of allocated memory to current allocated memory
+void resetBenchPeakMemory();
+// get number of all allocations made by operator new
+uint64_t getBenchAllocationsCount();
+
+// simple timer (in seconds)
+class BenchTimer
+{
+private:
+    std::chrono::steady_clock::time_point start;
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now())
+    { }
+    
+    void reset()
+    { start = std::chrono::steady_clock::now(); }
+    
+    double elapsed() const
+    {
+        return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// output stream that discards all data
+class BenchNullStream: public std::ostream
+{
+private:
+    class NullStreamBuf: public std::streambuf
+    {
+    protected:
+        int_type overflow(int_type c)
+        { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char*, std::streamsize n)
+        { return n; }
+    };
+    NullStreamBuf nullBuf;
+public:
+    BenchNullStream() : std::ostream(nullptr)
+    { rdbuf(&nullBuf); }
+};
+
+// list regular files in directory (paths are sorted)
+void listBenchDirectory(const char* dirName, std::vector<std::string>& files);
+
+// result of single phase of workload (the best of all repeats)
+struct BenchPhaseResult
+{
+    const char* workload;   // workload name
+    const char* phase;      // phase name
+    double time;        // the best time in seconds
+    uint64_t items;     // number of processed items (lines, instructions), 0 - none
+    uint64_t bytes;     // number of processed bytes, 0 - none
+    size_t peakMemory;  // peak of allocated memory during phase
+    uint64_t allocations;   // number of allocations during phase
+    
+    // update result by new measure
+    void update(double newTime, size_t newPeakMemory, uint64_t newAllocations = 0)
+    {
+        if (newTime < time)
+            time = newTime;
+        if (newPeakMemory > peakMemory)
+            peakMemory = newPeakMemory;
+        if (newAllocations > allocations)
+            allocations = newAllocations;
+    }
+};
+
+// print table of results, itemsName is name of items column (for example 'lines/s')
+void printBenchResults(std::ostream& os, const char* itemsName,
+            const std::vector<BenchPhaseResult>& results);
+
+};
+
+#endif
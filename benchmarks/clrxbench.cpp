@@ -0,0 +1,588 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdio>
+#include <cstdarg>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/CLIParser.h>
+#include <CLRX/amdasm/Assembler.h>
+#include "BenchUtils.h"
+
+using namespace CLRX;
+
+static const CLIOption programOptions[] =
+{
+    { "repeats", 'r', CLIArgType::UINT, false, false,
+        "set number of repeats (the best time will be reported)", "NUMBER" },
+    { "scale", 's', CLIArgType::UINT, false, false,
+        "set scale of workloads (multiplies workload size)", "SCALE" },
+    { "workload", 'W', CLIArgType::TRIMMED_STRING_ARRAY, false, true,
+        "run only specified workload", "WORKLOAD" },
+    { "list", 'l', CLIArgType::NONE, false, false, "list workloads", nullptr },
+    { "threads", 'j', CLIArgType::UINT, false, false,
+        "set number of threads for register allocation and wait scheduling "
+        "(0 - all hardware threads)",
+        "NUMBER" },
+    { "dump", 'd', CLIArgType::TRIMMED_STRING, false, false,
+        "dump generated source of workloads to directory", "DIR" },
+    CLRX_CLI_AUTOHELP
+    { nullptr, 0 }
+};
+
+// generated workload
+struct BenchWorkload
+{
+    const char* name;
+    const char* description;
+    BinaryFormat format;
+    GPUDeviceType deviceType;
+    Flags flags;
+    bool regAlloc;  // run AsmRegAllocator after assembling
+    bool waitSched; // run AsmWaitScheduler after register allocation
+    void (*generate)(std::string& source, cxuint scale);
+};
+
+static void appendFormat(std::string& source, const char* fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    const int len = vsnprintf(buf, sizeof buf, fmt, ap);
+    va_end(ap);
+    source.append(buf, std::min(size_t(len), sizeof buf - 1));
+}
+
+// long straight-line code with various encodings, literals and forward labels
+static void generateStraightLine(std::string& source, cxuint scale)
+{
+    const cxuint linesNum = 100000*scale;
+    for (cxuint i = 0; i < linesNum; i++)
+    {
+        const cxuint r = i*7;
+        switch (i & 15)
+        {
+            case 0:
+                appendFormat(source, "L%u:\n", i);
+                break;
+            case 1:
+                appendFormat(source, "        s_add_u32 s%u, s%u, s%u\n",
+                            r%100, (r+3)%100, (r+5)%100);
+                break;
+            case 2:
+                appendFormat(source, "        v_add_f32 v%u, v%u, v%u\n",
+                            r&255, (r+1)&255, (r+2)&255);
+                break;
+            case 3:
+                appendFormat(source, "        v_mad_f32 v%u, v%u, -v%u, s%u\n",
+                            r&255, (r+1)&255, (r+2)&255, r%100);
+                break;
+            case 4:
+                appendFormat(source, "        v_mov_b32 v%u, 0x%x\n", r&255, i*0x10001U);
+                break;
+            case 5:
+                appendFormat(source, "        s_load_dwordx4 s[%u:%u], s[0:1], 0x%x\n",
+                            (r%24)*4, (r%24)*4+3, (i&255)*4);
+                break;
+            case 6:
+                appendFormat(source, "        buffer_load_dword v%u, v%u, s[4:7], 0 "
+                            "offen offset:%u\n", r&255, (r+1)&255, i&4095);
+                break;
+            case 7:
+                appendFormat(source, "        ds_read_b32 v%u, v%u offset:%u\n",
+                            r&255, (r+1)&255, (i*4)&0xffff);
+                break;
+            case 8:
+                appendFormat(source, "        s_waitcnt vmcnt(0) & lgkmcnt(0)\n");
+                break;
+            case 9:
+                appendFormat(source, "        v_cmp_lt_f32 vcc, v%u, v%u\n",
+                            r&255, (r+9)&255);
+                break;
+            case 10:
+                appendFormat(source, "        s_cbranch_vccz L%u\n", (i&~15U) + 16);
+                break;
+            case 11:
+                appendFormat(source, "        v_cvt_f32_i32 v%u, %d\n", r&255,
+                            int(i&63)-16);
+                break;
+            case 12:
+                appendFormat(source, "        v_fma_f32 v%u, v%u, s%u, v%u clamp\n",
+                            r&255, (r+1)&255, r%100, (r+2)&255);
+                break;
+            case 13:
+                appendFormat(source, "        s_and_b64 s[%u:%u], vcc, exec\n",
+                            (r%50)*2, (r%50)*2+1);
+                break;
+            case 14:
+                appendFormat(source, "        v_add_u32 v%u, vcc, s%u, v%u\n",
+                            r&255, r%100, (r+4)&255);
+                break;
+            default:
+                appendFormat(source, "        ds_write2_b32 v%u, v%u, v%u "
+                            "offset0:%u offset1:%u\n", r&255, (r+1)&255, (r+2)&255,
+                            i&255, (i+1)&255);
+                break;
+        }
+    }
+    appendFormat(source, "L%u:\n        s_endpgm\n", (linesNum+15)&~15U);
+}
+
+// heavy macro, .rept, .irp and .for expansion
+static void generateMacros(std::string& source, cxuint scale)
+{
+    source +=
+        ".macro addloop dst, src, count\n"
+        "    .rept \\count\n"
+        "        v_add_f32 \\dst, \\src, \\dst\n"
+        "    .endr\n"
+        ".endm\n"
+        ".macro madset base, first, second\n"
+        "    .irp r, 0, 1, 2, 3\n"
+        "        v_mad_f32 v\\r, v\\r, \\first, \\second\n"
+        "    .endr\n"
+        "    s_add_u32 s\\base, s\\base, \\base\n"
+        ".endm\n"
+        ".macro nested level\n"
+        "    .if \\level > 0\n"
+        "        s_mov_b32 s1, \\level\n"
+        "        nested (\\level-1)\n"
+        "    .endif\n"
+        ".endm\n";
+    const cxuint blocksNum = 2000*scale;
+    for (cxuint i = 0; i < blocksNum; i++)
+    {
+        appendFormat(source, "    addloop v%u, v%u, 4\n", (i*3)&255, (i*5)&255);
+        appendFormat(source, "    madset %u, v%u, s%u\n", i%64, (i*7)&255, i%100);
+        appendFormat(source, "    nested %u\n", 1+(i%8));
+        appendFormat(source, ".for x = 0, x < 8, x+1\n"
+                    "    s_add_u32 s%u, s%u, x*%u\n"
+                    ".endr\n", i%100, (i+1)%100, i);
+    }
+    source += "    s_endpgm\n";
+}
+
+// huge symbol table: labels, assignments and expressions with forward references
+static void generateSymbols(std::string& source, cxuint scale)
+{
+    const cxuint symbolsNum = 50000*scale;
+    for (cxuint i = 0; i < symbolsNum; i++)
+    {
+        switch (i & 3)
+        {
+            case 0:
+                appendFormat(source, "label_%u:\n        s_mov_b32 s%u, sym_%u\n",
+                            i, i%100, i+5);
+                break;
+            case 1:
+                appendFormat(source, "sym_%u = sym_%u + %u*2\n", i, i+4, i);
+                break;
+            case 2:
+                appendFormat(source, "        .set sym_%u, %u\n", i, i*3);
+                break;
+            default:
+                appendFormat(source, "sym_%u = %u\n        .int sym_%u+(.-label_%u)\n",
+                            i, i, i-1, i&~3U);
+                break;
+        }
+    }
+    for (cxuint i = symbolsNum; i < symbolsNum+8; i++)
+        appendFormat(source, "sym_%u = %u\n", i, i);
+    source += "        s_endpgm\n";
+}
+
+// regvar-heavy code with branches (for AsmRegAllocator)
+// generate regvar-heavy code (sa, va, vb regvars) with labels prefixed by name
+static void generateRegVarsCode(std::string& source, const char* name, cxuint blocksNum)
+{
+    appendFormat(source, ".regvar %ssa:s:24, %sva:v:64, %svb:v:32\n", name, name, name);
+    for (cxuint i = 0; i < blocksNum; i++)
+    {
+        appendFormat(source, "%sB%u:\n", name, i);
+        for (cxuint k = 0; k < 12; k++)
+        {
+            const cxuint r = i*13 + k*5;
+            appendFormat(source, "        v_add_f32 %sva[%u], %sva[%u], %svb[%u]\n",
+                        name, r&63, name, (r+7)&63, name, (r+3)&31);
+            appendFormat(source, "        s_add_u32 %ssa[%u], %ssa[%u], %ssa[%u]\n",
+                        name, r%24, name, (r+5)%24, name, (r+11)%24);
+            if ((k&3) == 0)
+                appendFormat(source, "        v_mul_f32 %svb[%u], %sva[%u], %ssa[%u]\n",
+                            name, (r+1)&31, name, (r+2)&63, name, r%24);
+        }
+        appendFormat(source, "        v_cmp_lt_f32 vcc, %sva[%u], %svb[%u]\n",
+                    name, (i*3)&63, name, (i*5)&31);
+        if (i+2 < blocksNum)
+            appendFormat(source, "        s_cbranch_vccz %sB%u\n", name, i+2);
+    }
+    source += "        s_endpgm\n";
+}
+
+// long regvar-heavy code with many basic blocks
+static void generateRegVars(std::string& source, cxuint scale)
+{
+    generateRegVarsCode(source, "", 200*scale);
+}
+
+// regvar code with memory loads and wait instructions in many basic blocks
+static void generateWaitSched(std::string& source, cxuint scale)
+{
+    source += ".regvar sa:s:16, va:v:32\n";
+    const cxuint blocksNum = 200*scale;
+    for (cxuint i = 0; i < blocksNum; i++)
+    {
+        // wait instruction at start of block
+        appendFormat(source, "B%u:     s_waitcnt vmcnt(0) lgkmcnt(0)\n", i);
+        // addresses in static registers (delayed ops on regvars)
+        for (cxuint k = 0; k < 4; k++)
+        {
+            appendFormat(source, "        s_load_dword sa[%u], s[4:5], %u\n",
+                        (i+k)&15, k*4);
+            appendFormat(source, "        buffer_load_dword va[%u], v%u, s[0:3], 0 offen\n",
+                        (i*4+k)&31, k);
+        }
+        for (cxuint k = 0; k < 4; k++)
+            appendFormat(source, "        v_add_f32 va[%u], va[%u], sa[%u]\n",
+                        (i*4+k+16)&31, (i*4+k)&31, (i+k)&15);
+        appendFormat(source, "        s_cmp_eq_u32 s6, %u\n", i&63);
+        if (i+2 < blocksNum)
+            appendFormat(source, "        s_cbranch_scc0 B%u\n", i+2);
+    }
+    source += "        s_endpgm\n";
+}
+
+// many AMD kernels (separate code sections) with regvar-heavy code
+static void generateRegVarsKernels(std::string& source, cxuint scale)
+{
+    source += ".amd\n.gpu CapeVerde\n";
+    const cxuint kernelsNum = 16*scale;
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        char name[20];
+        snprintf(name, sizeof name, "k%u", i);
+        appendFormat(source, ".kernel kernel%u\n    .config\n        .dims x\n    .text\n", i);
+        generateRegVarsCode(source, name, 50);
+    }
+}
+
+// generate kernel code (for metadata workloads)
+static void generateKernelCode(std::string& source, cxuint i)
+{
+    appendFormat(source, "kernel%u:\n", i);
+    for (cxuint k = 0; k < 8; k++)
+        appendFormat(source, "        v_add_f32 v%u, v%u, s%u\n", k, k+1, (i+k)%16);
+    source += "        s_endpgm\n";
+}
+
+// many ROCm kernels with configs and metadata
+static void generateROCmMetadata(std::string& source, cxuint scale)
+{
+    source += ".rocm\n.gpu Fiji\n.arch_minor 0\n.arch_stepping 4\n"
+        ".newbinfmt\n.md_version 1, 0\n";
+    const cxuint kernelsNum = 300*scale;
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        appendFormat(source, ".kernel kernel%u\n", i);
+        appendFormat(source, "    .config\n"
+            "        .dims xyz\n"
+            "        .codeversion 1, 0\n"
+            "        .sgprsnum %u\n"
+            "        .vgprsnum %u\n"
+            "        .localsize %u\n"
+            "        .use_kernarg_segment_ptr\n"
+            "        .use_dispatch_ptr\n"
+            "        .md_symname \"kernel%u@kd\"\n"
+            "        .md_language \"OpenCL C\", 1, 2\n"
+            "        .reqd_work_group_size %u, 1, 1\n"
+            "        .md_kernarg_segment_size 64\n"
+            "        .md_kernarg_segment_align 8\n"
+            "        .md_group_segment_fixed_size 0\n"
+            "        .md_private_segment_fixed_size 0\n"
+            "        .md_wavefront_size 64\n"
+            "        .md_sgprsnum 24\n"
+            "        .md_vgprsnum 16\n"
+            "        .spilledsgprs 0\n"
+            "        .spilledvgprs 0\n"
+            "        .max_flat_work_group_size 256\n",
+            16+(i%32), 8+(i%64), (i%64)*16, i, 64+(i%4)*64);
+        for (cxuint k = 0; k < 6; k++)
+            appendFormat(source, "        .arg in%u, \"float*\", 8, 8, globalbuf, f32, "
+                        "global, default const\n", k);
+        source += "        .arg n, \"uint\", 4, 4, value, u32\n"
+            "        .arg , \"\", 8, 8, gox, i64\n"
+            "        .arg , \"\", 8, 8, goy, i64\n"
+            "        .arg , \"\", 8, 8, goz, i64\n";
+    }
+    source += ".text\n";
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        source += "        .p2align 8\n";
+        appendFormat(source, "kernel%u:\n        .skip 256\n", i);
+        for (cxuint k = 0; k < 8; k++)
+            appendFormat(source, "        v_add_f32 v%u, v%u, s%u\n", k, k+1, (i+k)%16);
+        source += "        s_endpgm\n";
+    }
+}
+
+// many AMD OpenCL 2.0 kernels with configs and kernel arguments
+static void generateAmdCL2Metadata(std::string& source, cxuint scale)
+{
+    source += ".amdcl2\n.64bit\n.gpu Bonaire\n.driver_version 191205\n";
+    const cxuint kernelsNum = 300*scale;
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        appendFormat(source, ".kernel kernel%u\n"
+            "    .config\n"
+            "        .dims xyz\n"
+            "        .setupargs\n", i);
+        for (cxuint k = 0; k < 6; k++)
+            appendFormat(source, "        .arg in%u, float*, global, const\n", k);
+        appendFormat(source,
+            "        .arg out, float*, global\n"
+            "        .arg n, uint\n"
+            "        .arg img, image2d, read_only\n"
+            "        .arg smp, sampler\n"
+            "        .localsize %u\n"
+            "        .ieeemode\n"
+            "        .floatmode 0xc0\n"
+            "        .useargs\n"
+            "    .text\n", (i%64)*16);
+        generateKernelCode(source, i);
+    }
+}
+
+static const BenchWorkload benchWorkloads[] =
+{
+    { "straightline", "long straight-line GCN code", BinaryFormat::RAWCODE,
+        GPUDeviceType::TONGA, ASM_WARNINGS, false, false, generateStraightLine },
+    { "macros", "heavy macro/.rept/.irp/.for expansion", BinaryFormat::RAWCODE,
+        GPUDeviceType::TONGA, ASM_WARNINGS, false, false, generateMacros },
+    { "symbols", "huge symbol table", BinaryFormat::RAWCODE,
+        GPUDeviceType::TONGA, ASM_WARNINGS, false, false, generateSymbols },
+    /* register usage is collected only in test mode */
+    { "regalloc", "regvar-heavy code with register allocation", BinaryFormat::RAWCODE,
+        GPUDeviceType::CAPE_VERDE, ASM_WARNINGS | ASM_TESTRUN | ASM_TESTRESOLVE,
+        true, false, generateRegVars },
+    { "linearscan", "regvar-heavy code with linear-scan register allocation",
+        BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE,
+        ASM_WARNINGS | ASM_TESTRUN | ASM_TESTRESOLVE | ASM_LINEARSCAN,
+        true, false, generateRegVars },
+    { "regallocmulti", "many kernels with register allocation for each code section",
+        BinaryFormat::AMD, GPUDeviceType::CAPE_VERDE,
+        ASM_WARNINGS | ASM_TESTRUN | ASM_TESTRESOLVE, true, false,
+        generateRegVarsKernels },
+    { "waitsched", "loads and waits in many blocks with wait scheduling",
+        BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE,
+        ASM_WARNINGS | ASM_TESTRUN | ASM_TESTRESOLVE, true, true, generateWaitSched },
+    { "rocm", "large ROCm metadata", BinaryFormat::ROCM,
+        GPUDeviceType::FIJI, ASM_WARNINGS, false, false, generateROCmMetadata },
+    { "amdcl2", "large AMD OpenCL 2.0 metadata", BinaryFormat::AMDCL2,
+        GPUDeviceType::BONAIRE, ASM_WARNINGS, false, false, generateAmdCL2Metadata }
+};
+
+static const size_t benchWorkloadsNum = sizeof(benchWorkloads)/sizeof(BenchWorkload);
+
+static void runWorkload(const BenchWorkload& workload, cxuint scale, cxuint repeats,
+            cxuint threadsNum, const char* dumpDir, std::vector<BenchPhaseResult>& results)
+{
+    std::string source;
+    workload.generate(source, scale);
+    if (dumpDir != nullptr)
+    {
+        const std::string dumpName = std::string(dumpDir) + "/" + workload.name + ".s";
+        std::ofstream dumpFile(dumpName.c_str(), std::ios::binary);
+        dumpFile.exceptions(std::ios::badbit | std::ios::failbit);
+        dumpFile.write(source.data(), source.size());
+    }
+    const uint64_t linesNum = std::count(source.begin(), source.end(), '\n');
+    
+    const size_t firstResult = results.size();
+    results.push_back({ workload.name, "assemble", 1e30, linesNum, source.size(), 0 });
+    if (workload.regAlloc)
+        results.push_back({ workload.name, "regalloc", 1e30, linesNum, 0, 0 });
+    if (workload.waitSched)
+        results.push_back({ workload.name, "waitsched", 1e30, linesNum, 0, 0 });
+    results.push_back({ workload.name, "writeBinary", 1e30, 0, 0, 0 });
+    
+    for (cxuint r = 0; r < repeats; r++)
+    {
+        BenchPhaseResult* result = results.data() + firstResult;
+        std::istringstream input(source);
+        std::ostringstream msgStream;
+        std::ostringstream printStream;
+        std::unique_ptr<Assembler> assembler(new Assembler("bench.s", input,
+                    workload.flags, workload.format, workload.deviceType,
+                    msgStream, printStream));
+        assembler->set64Bit(true);
+        
+        // assemble
+        size_t baseMemory = getBenchAllocatedMemory();
+        uint64_t baseAllocs = getBenchAllocationsCount();
+        resetBenchPeakMemory();
+        BenchTimer timer;
+        const bool good = assembler->assemble();
+        result->update(timer.elapsed(), getBenchPeakMemory() - baseMemory,
+                    getBenchAllocationsCount() - baseAllocs);
+        result++;
+        if (!good)
+        {
+            std::cerr << msgStream.str();
+            throw Exception(std::string("Workload '") + workload.name +
+                        "' failed to assemble");
+        }
+        
+        std::vector<std::unique_ptr<AsmRegAllocator> > regAllocs;
+        if (workload.regAlloc)
+        {
+            baseMemory = getBenchAllocatedMemory();
+            baseAllocs = getBenchAllocationsCount();
+            resetBenchPeakMemory();
+            timer.reset();
+            // one allocator per code section
+            regAllocs = AsmRegAllocator::allocateRegistersForSections(
+                        *assembler, threadsNum);
+            if (!workload.waitSched)
+                regAllocs.clear();
+            result->update(timer.elapsed(), getBenchPeakMemory() - baseMemory,
+                    getBenchAllocationsCount() - baseAllocs);
+            result++;
+        }
+        
+        if (workload.waitSched)
+        {
+            const AsmWaitConfig& waitConfig =
+                    assembler->getISAAssembler()->getWaitConfig();
+            baseMemory = getBenchAllocatedMemory();
+            baseAllocs = getBenchAllocationsCount();
+            resetBenchPeakMemory();
+            timer.reset();
+            // code blocks of section are simulated in threadsNum threads
+            for (size_t i = 0; i < regAllocs.size(); i++)
+                if (regAllocs[i] != nullptr)
+                {
+                    const AsmSection& section = assembler->getSections()[i];
+                    AsmWaitScheduler waitScheduler(waitConfig, *assembler,
+                            regAllocs[i]->getCodeBlocks(),
+                            regAllocs[i]->getVregIndexMaps(),
+                            regAllocs[i]->getGraphColorMaps(), false);
+                    waitScheduler.schedule(*section.usageHandler, *section.waitHandler,
+                            threadsNum);
+                }
+            result->update(timer.elapsed(), getBenchPeakMemory() - baseMemory,
+                    getBenchAllocationsCount() - baseAllocs);
+            result++;
+        }
+        
+        // write binary
+        Array<cxbyte> binary;
+        baseMemory = getBenchAllocatedMemory();
+        baseAllocs = getBenchAllocationsCount();
+        resetBenchPeakMemory();
+        timer.reset();
+        assembler->writeBinary(binary);
+        result->update(timer.elapsed(), getBenchPeakMemory() - baseMemory,
+                    getBenchAllocationsCount() - baseAllocs);
+        result->bytes = binary.size();
+    }
+}
+
+int main(int argc, const char** argv)
+try
+{
+    CLIParser cli("clrxbench", programOptions, argc, argv);
+    cli.parse();
+    if (cli.handleHelpOrUsage())
+        return 0;
+    
+    if (cli.hasShortOption('l'))
+    {
+        for (const BenchWorkload& workload: benchWorkloads)
+            std::cout << workload.name << " - " << workload.description << "\n";
+        std::cout.flush();
+        return 0;
+    }
+    
+    cxuint repeats = 3;
+    cxuint scale = 1;
+    if (cli.hasShortOption('r'))
+        repeats = std::max(cli.getShortOptArg<cxuint>('r'), 1U);
+    if (cli.hasShortOption('s'))
+        scale = std::max(cli.getShortOptArg<cxuint>('s'), 1U);
+    cxuint threadsNum = 0;
+    if (cli.hasShortOption('j'))
+        threadsNum = cli.getShortOptArg<cxuint>('j');
+    const char* dumpDir = nullptr;
+    if (cli.hasShortOption('d'))
+        dumpDir = cli.getShortOptArg<const char*>('d');
+    
+    // choose workloads
+    bool chosen[benchWorkloadsNum];
+    std::fill(chosen, chosen + benchWorkloadsNum, !cli.hasShortOption('W'));
+    if (cli.hasShortOption('W'))
+    {
+        size_t namesNum = 0;
+        const char* const* names = cli.getShortOptArgArray<const char*>('W', namesNum);
+        for (size_t i = 0; i < namesNum; i++)
+        {
+            size_t w = 0;
+            for (; w < benchWorkloadsNum; w++)
+                if (::strcmp(benchWorkloads[w].name, names[i]) == 0)
+                    break;
+            if (w == benchWorkloadsNum)
+                throw Exception(std::string("Unknown workload '") + names[i] + "'");
+            chosen[w] = true;
+        }
+    }
+    
+    std::vector<BenchPhaseResult> results;
+    for (size_t w = 0; w < benchWorkloadsNum; w++)
+        if (chosen[w])
+            runWorkload(benchWorkloads[w], scale, repeats, threadsNum, dumpDir,
+                        results);
+    printBenchResults(std::cout, "lines/s", results);
+    return 0;
+}
+catch(const Exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
+catch(const std::bad_alloc& ex)
+{
+    std::cerr << "Out of memory" << std::endl;
+    return 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << "System exception: " << ex.what() << std::endl;
+    return 1;
+}
+catch(...)
+{
+    std::cerr << "Unknown exception" << std::endl;
+    return 1;
+}
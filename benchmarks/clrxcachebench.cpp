@@ -0,0 +1,174 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/CLIParser.h>
+#include <CLRX/utils/Containers.h>
+#include "BenchUtils.h"
+
+using namespace CLRX;
+
+static const CLIOption programOptions[] =
+{
+    { "repeats", 'r', CLIArgType::UINT, false, false,
+        "set number of repeats (the best time will be reported)", "NUMBER" },
+    { "scale", 's', CLIArgType::UINT, false, false,
+        "set scale of workloads (multiplies number of operations)", "SCALE" },
+    CLRX_CLI_AUTOHELP
+    { nullptr, 0 }
+};
+
+// value stored in cache (weight like size of the SSA id maps)
+struct BenchCacheValue
+{
+    size_t size;
+
+    size_t weight() const
+    { return size; }
+};
+
+// simple deterministic random generator
+class BenchRandom
+{
+private:
+    uint64_t state;
+public:
+    explicit BenchRandom(uint64_t seed) : state(seed)
+    { }
+
+    uint32_t next()
+    {
+        state = state*6364136223846793005ULL + 1442695040888963407ULL;
+        return uint32_t(state>>33);
+    }
+
+    // random number from range 0..n-1 with more frequent smaller numbers
+    size_t nextSkewed(size_t n)
+    {
+        const uint64_t r = next() & 0xffff;
+        return size_t((r*r*n) >> 32);
+    }
+};
+
+/* access patterns of cache. they imitate usage of caches in register allocator:
+ * keys are code block indices, cache size is proportional to number of blocks,
+ * if value is not in cache, then it will be computed and put to cache */
+struct BenchCachePattern
+{
+    const char* name;
+    const char* description;
+    size_t blocksNum;   // number of keys (code blocks)
+    size_t weightPerBlock; // max weight of cache per block
+    size_t maxValueWeight;
+    cxuint putPercent;  // percent of operations that put (update) value
+};
+
+static const BenchCachePattern benchCachePatterns[] =
+{
+    { "ssadata", "SSA data resolving (big cache, rare misses)", 4096, 256, 512, 5 },
+    { "update", "frequent updates of cached entries", 4096, 128, 512, 40 },
+    { "evict", "small cache with frequent evictions", 16384, 16, 512, 10 }
+};
+
+static size_t runBenchCachePattern(const BenchCachePattern& pattern, cxuint scale)
+{
+    SimpleCache<size_t, BenchCacheValue> cache(pattern.blocksNum*pattern.weightPerBlock);
+    BenchRandom random(pattern.blocksNum);
+    const size_t opsNum = size_t(pattern.blocksNum)*256*scale;
+    size_t hits = 0;
+    for (size_t i = 0; i < opsNum; i++)
+    {
+        const size_t key = random.nextSkewed(pattern.blocksNum);
+        if ((random.next() % 100) < pattern.putPercent)
+        {
+            // update entry
+            cache.put(key, { 1 + random.next() % pattern.maxValueWeight });
+            continue;
+        }
+        BenchCacheValue* value = cache.use(key);
+        if (value != nullptr)
+            hits += value->size!=0;
+        else
+            cache.put(key, { 1 + random.next() % pattern.maxValueWeight });
+    }
+    return hits;
+}
+
+int main(int argc, const char** argv)
+try
+{
+    CLIParser cli("clrxcachebench", programOptions, argc, argv);
+    cli.parse();
+    if (cli.handleHelpOrUsage())
+        return 0;
+
+    cxuint repeats = 3;
+    cxuint scale = 1;
+    if (cli.hasShortOption('r'))
+        repeats = std::max(cli.getShortOptArg<cxuint>('r'), 1U);
+    if (cli.hasShortOption('s'))
+        scale = std::max(cli.getShortOptArg<cxuint>('s'), 1U);
+
+    std::vector<BenchPhaseResult> results;
+    for (const BenchCachePattern& pattern: benchCachePatterns)
+    {
+        const uint64_t opsNum = uint64_t(pattern.blocksNum)*256*scale;
+        BenchPhaseResult result = { pattern.name, "simplecache", 1e30, opsNum, 0, 0, 0 };
+        size_t hits = 0;
+        for (cxuint r = 0; r < repeats; r++)
+        {
+            const size_t baseMemory = getBenchAllocatedMemory();
+            const uint64_t baseAllocs = getBenchAllocationsCount();
+            resetBenchPeakMemory();
+            BenchTimer timer;
+            hits = runBenchCachePattern(pattern, scale);
+            result.update(timer.elapsed(), getBenchPeakMemory() - baseMemory,
+                        getBenchAllocationsCount() - baseAllocs);
+        }
+        results.push_back(result);
+        std::cout << pattern.name << " - " << pattern.description << ", hits: " <<
+                hits << " of " << opsNum << " operations\n";
+    }
+    printBenchResults(std::cout, "ops/s", results);
+    return 0;
+}
+catch(const Exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
+catch(const std::bad_alloc& ex)
+{
+    std::cerr << "Out of memory" << std::endl;
+    return 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << "System exception: " << ex.what() << std::endl;
+    return 1;
+}
+catch(...)
+{
+    std::cerr << "Unknown exception" << std::endl;
+    return 1;
+}
@@ -0,0 +1,379 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/CLIParser.h>
+#include <CLRX/amdbin/AmdBinaries.h>
+#include <CLRX/amdbin/AmdCL2Binaries.h>
+#include <CLRX/amdbin/ROCmBinaries.h>
+#include <CLRX/amdbin/GalliumBinaries.h>
+#include <CLRX/amdasm/Disassembler.h>
+#include "BenchUtils.h"
+
+using namespace CLRX;
+
+static const CLIOption programOptions[] =
+{
+    { "repeats", 'r', CLIArgType::UINT, false, false,
+        "set number of repeats (the best time will be reported)", "NUMBER" },
+    { "noDefaultCorpus", 'N', CLIArgType::NONE, false, false,
+        "do not load binaries from tests directories", nullptr },
+    { "gpuType", 'g', CLIArgType::TRIMMED_STRING, false, false,
+        "set GPU type for Gallium binaries", "DEVICE" },
+    { "verbose", 'v', CLIArgType::NONE, false, false,
+        "print loaded and skipped files", nullptr },
+    CLRX_CLI_AUTOHELP
+    { nullptr, 0 }
+};
+
+// directories with binaries from tests
+static const char* defaultCorpusDirs[] =
+{
+    CLRX_SOURCE_DIR "/tests/amdasm/amdbins",
+    CLRX_SOURCE_DIR "/tests/amdbin/amdbins",
+    CLRX_SOURCE_DIR "/tests/amdbin/amdcl2bins",
+    CLRX_SOURCE_DIR "/tests/amdbin/galliumbins",
+    CLRX_SOURCE_DIR "/tests/amdbin/rocmbins"
+};
+
+struct BenchFlagSet
+{
+    const char* name;
+    Flags flags;
+};
+
+static const BenchFlagSet benchFlagSets[] =
+{
+    { "all", DISASM_ALL },
+    // code is dumped only with DISASM_DUMPCODE
+    { "hexcode", DISASM_DUMPCODE | DISASM_HEXCODE },
+    { "floatlits", DISASM_DUMPCODE | DISASM_FLOATLITS }
+};
+
+// code region of binary (code of kernel or code section)
+struct BenchCodeRegion
+{
+    GPUDeviceType deviceType;
+    size_t size;
+    const cxbyte* code;
+};
+
+// loaded binary with disassembler inputs
+struct BenchBinary
+{
+    std::string filename;
+    std::unique_ptr<MappedFileData> data;
+    BinaryFormat format;
+    std::unique_ptr<AmdMainBinaryBase> amdBinary;
+    std::unique_ptr<ROCmBinary> rocmBinary;
+    std::unique_ptr<GalliumBinary> galliumBinary;
+    std::unique_ptr<AmdDisasmInput> amdInput;
+    std::unique_ptr<AmdCL2DisasmInput> amdCL2Input;
+    std::unique_ptr<ROCmDisasmInput> rocmInput;
+    std::unique_ptr<GalliumDisasmInput> galliumInput;
+    std::vector<BenchCodeRegion> regions;
+    uint64_t codeSize;
+    uint64_t instrsNum;
+};
+
+static const Flags benchAmdBinFlags = AMDBIN_CREATE_KERNELINFO |
+        AMDBIN_CREATE_KERNELINFOMAP | AMDBIN_CREATE_INNERBINMAP |
+        AMDBIN_CREATE_KERNELHEADERS | AMDBIN_CREATE_KERNELHEADERMAP |
+        AMDBIN_INNER_CREATE_CALNOTES | AMDBIN_CREATE_INFOSTRINGS;
+
+static const Flags benchAmdCL2BinFlags = benchAmdBinFlags |
+        AMDCL2BIN_INNER_CREATE_KERNELDATA | AMDCL2BIN_INNER_CREATE_KERNELDATAMAP |
+        AMDCL2BIN_INNER_CREATE_KERNELSTUBS;
+
+// load and parse binary, returns false if file is not supported GPU binary
+static bool loadBenchBinary(const std::string& filename, GPUDeviceType galliumDevType,
+            BenchBinary& binary)
+{
+    binary.filename = filename;
+    binary.data.reset(new MappedFileData(filename.c_str()));
+    const size_t size = binary.data->size();
+    cxbyte* data = binary.data->data();
+    
+    if (isAmdBinary(size, data))
+    {
+        binary.format = BinaryFormat::AMD;
+        binary.amdBinary.reset(createAmdBinaryFromCode(size, data, benchAmdBinFlags));
+        if (binary.amdBinary->getType() == AmdMainType::GPU_BINARY)
+            binary.amdInput.reset(getAmdDisasmInputFromBinary32(
+                    *static_cast<AmdMainGPUBinary32*>(binary.amdBinary.get()),
+                    DISASM_ALL));
+        else if (binary.amdBinary->getType() == AmdMainType::GPU_64_BINARY)
+            binary.amdInput.reset(getAmdDisasmInputFromBinary64(
+                    *static_cast<AmdMainGPUBinary64*>(binary.amdBinary.get()),
+                    DISASM_ALL));
+        else
+            return false; // CPU binary
+        for (const AmdDisasmKernelInput& kernel: binary.amdInput->kernels)
+            if (kernel.code != nullptr)
+                binary.regions.push_back({ binary.amdInput->deviceType,
+                        kernel.codeSize, kernel.code });
+    }
+    else if (isAmdCL2Binary(size, data))
+    {
+        binary.format = BinaryFormat::AMDCL2;
+        binary.amdBinary.reset(createAmdCL2BinaryFromCode(size, data,
+                    benchAmdCL2BinFlags));
+        if (binary.amdBinary->getType() == AmdMainType::GPU_CL2_BINARY)
+            binary.amdCL2Input.reset(getAmdCL2DisasmInputFromBinary32(
+                    *static_cast<AmdCL2MainGPUBinary32*>(binary.amdBinary.get()), 0));
+        else if (binary.amdBinary->getType() == AmdMainType::GPU_CL2_64_BINARY)
+            binary.amdCL2Input.reset(getAmdCL2DisasmInputFromBinary64(
+                    *static_cast<AmdCL2MainGPUBinary64*>(binary.amdBinary.get()), 0));
+        else
+            return false;
+        const AmdCL2DisasmInput& input = *binary.amdCL2Input;
+        if (input.code != nullptr)
+            binary.regions.push_back({ input.deviceType, input.codeSize, input.code });
+        else
+            for (const AmdCL2DisasmKernelInput& kernel: input.kernels)
+                if (kernel.code != nullptr)
+                    binary.regions.push_back({ input.deviceType,
+                            kernel.codeSize, kernel.code });
+    }
+    else if (isROCmBinary(size, data))
+    {
+        binary.format = BinaryFormat::ROCM;
+        binary.rocmBinary.reset(new ROCmBinary(size, data, 0));
+        binary.rocmInput.reset(getROCmDisasmInputFromBinary(*binary.rocmBinary));
+        binary.regions.push_back({ binary.rocmInput->deviceType,
+                    binary.rocmInput->codeSize, binary.rocmInput->code });
+    }
+    else
+    {
+        // try to load as gallium binary
+        try
+        { binary.galliumBinary.reset(new GalliumBinary(size, data, 0)); }
+        catch(const Exception& ex)
+        { return false; }
+        binary.format = BinaryFormat::GALLIUM;
+        binary.galliumInput.reset(getGalliumDisasmInputFromBinary(galliumDevType,
+                    *binary.galliumBinary, 0));
+        binary.regions.push_back({ binary.galliumInput->deviceType,
+                    binary.galliumInput->codeSize, binary.galliumInput->code });
+    }
+    
+    // count code size and instructions
+    binary.codeSize = 0;
+    binary.instrsNum = 0;
+    for (const BenchCodeRegion& region: binary.regions)
+    {
+        binary.codeSize += region.size;
+        GCNInstrDecoder decoder(region.deviceType, region.size, region.code);
+        GCNDecodedInstr instr;
+        while (decoder.next(instr))
+            binary.instrsNum++;
+    }
+    return true;
+}
+
+// create disassembler from prepared input
+static Disassembler* createBenchDisassembler(const BenchBinary& binary,
+            std::ostream& output, Flags flags)
+{
+    switch (binary.format)
+    {
+        case BinaryFormat::AMD:
+            return new Disassembler(binary.amdInput.get(), output, flags);
+        case BinaryFormat::AMDCL2:
+            return new Disassembler(binary.amdCL2Input.get(), output, flags);
+        case BinaryFormat::ROCM:
+            return new Disassembler(binary.rocmInput.get(), output, flags);
+        default:
+            return new Disassembler(binary.galliumInput.get(), output, flags);
+    }
+}
+
+enum : cxuint
+{
+    PHASE_TOTAL = 0,
+    PHASE_ANALYZE,
+    PHASE_DISASSEMBLE,
+    PHASE_METADATA,
+    PHASES_NUM
+};
+
+static const char* phaseNames[PHASES_NUM] =
+{ "total", "analyzeBefore", "disassemble", "metadata" };
+
+int main(int argc, const char** argv)
+try
+{
+    CLIParser cli("clrxdisasmbench", programOptions, argc, argv);
+    cli.parse();
+    if (cli.handleHelpOrUsage())
+        return 0;
+    
+    cxuint repeats = 3;
+    if (cli.hasShortOption('r'))
+        repeats = std::max(cli.getShortOptArg<cxuint>('r'), 1U);
+    GPUDeviceType galliumDevType = GPUDeviceType::CAPE_VERDE;
+    if (cli.hasShortOption('g'))
+        galliumDevType = getGPUDeviceTypeFromName(cli.getShortOptArg<const char*>('g'));
+    const bool verbose = cli.hasShortOption('v');
+    
+    // collect files
+    std::vector<std::string> files;
+    if (!cli.hasShortOption('N'))
+        for (const char* dirName: defaultCorpusDirs)
+            listBenchDirectory(dirName, files);
+    for (const char* const* args = cli.getArgs(); *args != nullptr; args++)
+        if (isDirectory(*args))
+            listBenchDirectory(*args, files);
+        else
+            files.push_back(*args);
+    
+    // load binaries
+    std::vector<std::unique_ptr<BenchBinary> > binaries;
+    uint64_t corpusCodeSize = 0;
+    uint64_t corpusInstrsNum = 0;
+    BenchTimer timer;
+    size_t baseMemory = getBenchAllocatedMemory();
+    resetBenchPeakMemory();
+    for (const std::string& filename: files)
+    {
+        std::unique_ptr<BenchBinary> binary(new BenchBinary);
+        bool loaded = false;
+        try
+        { loaded = loadBenchBinary(filename, galliumDevType, *binary); }
+        catch(const Exception& ex)
+        {
+            if (verbose)
+                std::cerr << "Error for '" << filename << "': " << ex.what() << "\n";
+        }
+        if (!loaded)
+        {
+            if (verbose)
+                std::cerr << "Skipped: " << filename << "\n";
+            continue;
+        }
+        if (verbose)
+            std::cerr << "Loaded: " << filename << " (" << binary->codeSize <<
+                    " bytes of code)\n";
+        corpusCodeSize += binary->codeSize;
+        corpusInstrsNum += binary->instrsNum;
+        binaries.push_back(std::move(binary));
+    }
+    const double loadTime = timer.elapsed();
+    const size_t loadPeakMemory = getBenchPeakMemory() - baseMemory;
+    std::cout << "Binaries: " << binaries.size() << ", code: " << corpusCodeSize <<
+            " bytes, instructions: " << corpusInstrsNum << "\n";
+    
+    std::vector<BenchPhaseResult> results;
+    results.push_back({ "load", "parse+decode", loadTime, corpusInstrsNum,
+                corpusCodeSize, loadPeakMemory });
+    
+    BenchNullStream nullStream;
+    for (const BenchFlagSet& flagSet: benchFlagSets)
+    {
+        const size_t firstResult = results.size();
+        for (cxuint p = 0; p < PHASES_NUM; p++)
+            results.push_back({ flagSet.name, phaseNames[p], 1e30, corpusInstrsNum,
+                    corpusCodeSize, 0 });
+        BenchPhaseResult* phaseResults = results.data() + firstResult;
+        
+        for (cxuint r = 0; r < repeats; r++)
+        {
+            // whole disassembling (with metadata and data dumping)
+            double phaseTimes[PHASES_NUM] = { };
+            size_t phasePeaks[PHASES_NUM] = { };
+            for (const std::unique_ptr<BenchBinary>& binary: binaries)
+            {
+                std::unique_ptr<Disassembler> disasm(createBenchDisassembler(
+                            *binary, nullStream, flagSet.flags));
+                baseMemory = getBenchAllocatedMemory();
+                resetBenchPeakMemory();
+                timer.reset();
+                disasm->disassemble();
+                phaseTimes[PHASE_TOTAL] += timer.elapsed();
+                phasePeaks[PHASE_TOTAL] = std::max(phasePeaks[PHASE_TOTAL],
+                            getBenchPeakMemory() - baseMemory);
+            }
+            // code only: analyzing and disassembling of code regions
+            for (const std::unique_ptr<BenchBinary>& binary: binaries)
+                for (const BenchCodeRegion& region: binary->regions)
+                {
+                    Disassembler disasm(region.deviceType, region.size, region.code,
+                                nullStream, flagSet.flags);
+                    GCNDisassembler gcnDisasm(disasm);
+                    gcnDisasm.setInput(region.size, region.code);
+                    
+                    baseMemory = getBenchAllocatedMemory();
+                    resetBenchPeakMemory();
+                    timer.reset();
+                    gcnDisasm.beforeDisassemble();
+                    phaseTimes[PHASE_ANALYZE] += timer.elapsed();
+                    phasePeaks[PHASE_ANALYZE] = std::max(phasePeaks[PHASE_ANALYZE],
+                                getBenchPeakMemory() - baseMemory);
+                    
+                    baseMemory = getBenchAllocatedMemory();
+                    resetBenchPeakMemory();
+                    timer.reset();
+                    gcnDisasm.disassemble();
+                    phaseTimes[PHASE_DISASSEMBLE] += timer.elapsed();
+                    phasePeaks[PHASE_DISASSEMBLE] = std::max(
+                                phasePeaks[PHASE_DISASSEMBLE],
+                                getBenchPeakMemory() - baseMemory);
+                }
+            // metadata dumping is remaining part of whole disassembling
+            phaseTimes[PHASE_METADATA] = std::max(0.0, phaseTimes[PHASE_TOTAL] -
+                    phaseTimes[PHASE_ANALYZE] - phaseTimes[PHASE_DISASSEMBLE]);
+            phasePeaks[PHASE_METADATA] = phasePeaks[PHASE_TOTAL];
+            for (cxuint p = 0; p < PHASES_NUM; p++)
+                phaseResults[p].update(phaseTimes[p], phasePeaks[p]);
+        }
+        // metadata phase does not process code
+        phaseResults[PHASE_METADATA].items = 0;
+        phaseResults[PHASE_METADATA].bytes = 0;
+    }
+    printBenchResults(std::cout, "instrs/s", results);
+    return 0;
+}
+catch(const Exception& ex)
+{
+    std::cerr << ex.what() << std::endl;
+    return 1;
+}
+catch(const std::bad_alloc& ex)
+{
+    std::cerr << "Out of memory" << std::endl;
+    return 1;
+}
+catch(const std::exception& ex)
+{
+    std::cerr << "System exception: " << ex.what() << std::endl;
+    return 1;
+}
+catch(...)
+{
+    std::cerr << "Unknown exception" << std::endl;
+    return 1;
+}
@@ -22,6 +22,8 @@
 #include <algorithm>
 #include <exception>
 #include <cstdio>
+#include <fstream>
+#include <functional>
 #include <vector>
 #include <utility>
 #include <thread>
@@ -31,6 +33,11 @@
 #include <climits>
 #include <cstdint>
 #include <cstddef>
+#ifdef HAVE_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/utils/Containers.h>
 #include <CLRX/amdasm/Assembler.h>
@@ -44,6 +51,8 @@ using namespace CLRX;
 
 OnceFlag clrxOnceFlag;
 bool useCLRXWrapper = true;
+// use on-disk cache of assembled binaries
+static bool useCLRXAsmCache = true;
 /* use pure pointer - AMDOCL library must be available to end of program,
  * even after main routine and within atexit callback */
 static DynLibrary* amdOclLibrary = nullptr;
@@ -352,6 +361,7 @@ void clrxWrapperInitialize()
     try
     {
         useCLRXWrapper = !parseEnvVariable<bool>("CLRX_FORCE_ORIGINAL_AMDOCL", false);
+        useCLRXAsmCache = parseEnvVariable<bool>("CLRX_ASMCACHE", true);
         std::string amdOclPath = findAmdOCL();
         /// set temporary amd ocl library
         tmpAmdOclLibrary.reset(new DynLibrary(amdOclPath.c_str(), DYNLIB_NOW));
@@ -1524,6 +1534,340 @@ static cl_int genDeviceOrder(cl_uint devicesNum, const cl_device_id* devices,
     return CL_SUCCESS;
 }
 
+// common parameters of assembling for devices
+struct CLRX_INTERNAL CLAsmCommonParams
+{
+    const char* sourceCode;
+    size_t sourceCodeSize;
+    Flags asmFlags;
+    const std::vector<CString>& includePaths;
+    const std::vector<std::pair<CString, uint64_t> >& defSyms;
+    bool havePolicy;
+    cxuint policyVersion;
+    uint32_t driverVersion;
+    const std::string& cacheDir;  // empty if cache is disabled
+    RefPtr<AsmIncludeCache> includeCache; // shared by assemblings for all devices
+};
+
+// single assembling job for distinct device type
+struct CLRX_INTERNAL CLAsmDevJob
+{
+    cxuint index;   // index in sorted devices
+    GPUDeviceType devType;
+    bool is64Bit;
+    BinaryFormat binFormat;
+};
+
+/* on-disk cache of assembled binaries.
+ * entry is stored in file named by hash of key (source, options, device type,
+ * bitness, binary format, driver and policy version). entry holds full key to
+ * avoid hash collisions, list of included files (with their size and hash),
+ * log of assembler and binary. */
+
+static const char clrxAsmCacheMagic[8] = { 'C', 'L', 'R', 'X', 'A', 'S', 'M', 'C' };
+static const uint32_t clrxAsmCacheVersion = 1;
+
+// FNV-1a hash
+static uint64_t clrxAsmCacheHash(size_t size, const char* data,
+            uint64_t hash = 0xcbf29ce484222325ULL)
+{
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ cxbyte(data[i])) * 0x100000001b3ULL;
+    return hash;
+}
+
+// get cache directory, create it if needed. returns empty string if not available
+static std::string clrxGetAsmCacheDir()
+{
+    if (!useCLRXAsmCache)
+        return "";
+    std::string cacheDir = getHomeDir();
+    if (cacheDir.empty())
+        return "";
+    cacheDir = joinPaths(cacheDir, ".clrxasmcache");
+    try
+    { makeDir(cacheDir.c_str()); }
+    catch(const std::exception& ex)
+    { }
+    return isDirectory(cacheDir.c_str()) ? cacheDir : "";
+}
+
+static std::string clrxAsmCacheKey(const CLAsmCommonParams& params,
+            const CLAsmDevJob& job)
+{
+    std::string key;
+    char buf[32];
+    auto addValue = [&key, &buf](const char* name, uint64_t value)
+    {
+        key += name;
+        key += '=';
+        key.append(buf, itocstrCStyle(value, buf, 32));
+        key += ';';
+    };
+    addValue("version", CLRX_VERSION_NUMBER);
+    addValue("flags", params.asmFlags);
+    addValue("device", cxuint(job.devType));
+    addValue("64bit", job.is64Bit);
+    addValue("format", cxuint(job.binFormat));
+    addValue("driver", params.driverVersion);
+    addValue("policy", params.havePolicy ? params.policyVersion+1 : 0);
+    for (const CString& incPath: params.includePaths)
+    {
+        key += "inc=";
+        key += incPath.c_str();
+        key += '\0';
+    }
+    for (const auto& defSym: params.defSyms)
+    {
+        key += "def=";
+        key += defSym.first.c_str();
+        key += '\0';
+        addValue("", defSym.second);
+    }
+    key += '\n';
+    key.append(params.sourceCode, params.sourceCodeSize);
+    return key;
+}
+
+static std::string clrxAsmCachePath(const std::string& cacheDir, const std::string& key)
+{
+    char buf[24];
+    size_t len = itocstrCStyle(clrxAsmCacheHash(key.size(), key.data()), buf, 24, 16, 16, false);
+    return joinPaths(cacheDir, std::string(buf, len) + ".bin");
+}
+
+// hash of included file, returns false if file can not be read
+static bool clrxAsmCacheFileHash(const char* filename, uint64_t& size, uint64_t& hash)
+try
+{
+    Array<cxbyte> content = loadDataFromFile(filename);
+    size = content.size();
+    hash = clrxAsmCacheHash(content.size(), (const char*)content.data());
+    return true;
+}
+catch(const std::exception& ex)
+{ return false; }
+
+template<typename T>
+static inline void clrxAsmCacheWriteValue(std::ostream& os, T value)
+{ os.write((const char*)&value, sizeof(T)); }
+
+template<typename T>
+static inline T clrxAsmCacheReadValue(std::istream& is)
+{
+    T value;
+    is.read((char*)&value, sizeof(T));
+    return value;
+}
+
+static void clrxAsmCacheWriteString(std::ostream& os, size_t size, const char* str)
+{
+    clrxAsmCacheWriteValue<uint64_t>(os, size);
+    os.write(str, size);
+}
+
+static std::string clrxAsmCacheReadString(std::istream& is)
+{
+    const uint64_t size = clrxAsmCacheReadValue<uint64_t>(is);
+    if (size > (uint64_t(1)<<32))
+        throw Exception("Corrupted cache entry");
+    std::string str(size, 0);
+    is.read(&str[0], size);
+    return str;
+}
+
+// try to load binary and log from cache, returns true if found and valid
+static bool clrxAsmCacheLoad(const std::string& path, const std::string& key,
+            std::string& log, Array<cxbyte>& binary)
+try
+{
+    std::ifstream ifs(path.c_str(), std::ios::binary);
+    if (!ifs)
+        return false;
+    ifs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+    char magic[8];
+    ifs.read(magic, 8);
+    if (::memcmp(magic, clrxAsmCacheMagic, 8)!=0 ||
+        clrxAsmCacheReadValue<uint32_t>(ifs) != clrxAsmCacheVersion)
+        return false;
+    if (clrxAsmCacheReadString(ifs) != key)
+        return false; // hash collision
+    // check included files
+    const uint32_t depsNum = clrxAsmCacheReadValue<uint32_t>(ifs);
+    for (uint32_t i = 0; i < depsNum; i++)
+    {
+        const std::string depPath = clrxAsmCacheReadString(ifs);
+        const uint64_t depSize = clrxAsmCacheReadValue<uint64_t>(ifs);
+        const uint64_t depHash = clrxAsmCacheReadValue<uint64_t>(ifs);
+        uint64_t curSize, curHash;
+        if (!clrxAsmCacheFileHash(depPath.c_str(), curSize, curHash) ||
+            curSize != depSize || curHash != depHash)
+            return false; // included file has been changed
+    }
+    log = clrxAsmCacheReadString(ifs);
+    const uint64_t binSize = clrxAsmCacheReadValue<uint64_t>(ifs);
+    binary.resize(binSize);
+    ifs.read((char*)binary.data(), binSize);
+    return true;
+}
+catch(const std::exception& ex)
+{ return false; }
+
+// store binary and log in cache. any failure is ignored
+static void clrxAsmCacheStore(const std::string& path, const std::string& key,
+            const std::vector<CString>& includedFiles, const std::string& log,
+            const Array<cxbyte>& binary)
+{
+    /* write to temporary file and rename it to keep entry consistent for other
+     * processes. name of temporary file is unique for process and thread */
+    char buf[24];
+    size_t len = itocstrCStyle(uint64_t(::getpid()), buf, 24, 16, 0, false);
+    std::string tmpPath = path + ".tmp" + std::string(buf, len) + "_";
+    len = itocstrCStyle(uint64_t(std::hash<std::thread::id>()(
+                std::this_thread::get_id())), buf, 24, 16, 0, false);
+    tmpPath.append(buf, len);
+    try
+    {
+        {
+        std::ofstream ofs(tmpPath.c_str(), std::ios::binary);
+        if (!ofs)
+            return;
+        ofs.exceptions(std::ios::badbit | std::ios::failbit);
+        ofs.write(clrxAsmCacheMagic, 8);
+        clrxAsmCacheWriteValue<uint32_t>(ofs, clrxAsmCacheVersion);
+        clrxAsmCacheWriteString(ofs, key.size(), key.data());
+        clrxAsmCacheWriteValue<uint32_t>(ofs, includedFiles.size());
+        for (const CString& depPath: includedFiles)
+        {
+            uint64_t depSize, depHash;
+            if (!clrxAsmCacheFileHash(depPath.c_str(), depSize, depHash))
+                throw Exception("Can't read included file");
+            clrxAsmCacheWriteString(ofs, depPath.size(), depPath.c_str());
+            clrxAsmCacheWriteValue<uint64_t>(ofs, depSize);
+            clrxAsmCacheWriteValue<uint64_t>(ofs, depHash);
+        }
+        clrxAsmCacheWriteString(ofs, log.size(), log.data());
+        clrxAsmCacheWriteString(ofs, binary.size(), (const char*)binary.data());
+        }
+        if (::rename(tmpPath.c_str(), path.c_str())==0)
+            return;
+    }
+    catch(const std::exception& ex)
+    { }
+    ::remove(tmpPath.c_str());
+}
+
+/* assemble program for single device type. does not touch any OpenCL state,
+ * hence it can be called from any thread. returns false if assembling failed */
+static bool clrxAssembleProgramForDevice(const CLAsmCommonParams& params,
+            const CLAsmDevJob& job, ProgDeviceEntry& progDevEntry,
+            RefPtr<CLProgBinEntry>& progBin)
+{
+    std::string cacheKey, cachePath;
+    if (!params.cacheDir.empty())
+    {
+        // try to get binary from cache
+        cacheKey = clrxAsmCacheKey(params, job);
+        cachePath = clrxAsmCachePath(params.cacheDir, cacheKey);
+        std::string log;
+        Array<cxbyte> binary;
+        if (clrxAsmCacheLoad(cachePath, cacheKey, log, binary))
+        {
+            progDevEntry.log = RefPtr<CLProgLogEntry>(new CLProgLogEntry(std::move(log)));
+            progDevEntry.status = CL_BUILD_SUCCESS;
+            progBin = RefPtr<CLProgBinEntry>(new CLProgBinEntry(std::move(binary)));
+            return true;
+        }
+    }
+    
+    // assemble it
+    ArrayIStream astream(params.sourceCodeSize, params.sourceCode);
+    std::string msgString;
+    StringOStream msgStream(msgString);
+    Assembler assembler("", astream, params.asmFlags, job.binFormat,
+                job.devType, msgStream);
+    assembler.set64Bit(job.is64Bit);
+    
+    assembler.setIncludeCache(params.includeCache);
+    for (const CString& incPath: params.includePaths)
+        assembler.addIncludeDir(incPath);
+    for (const auto& defSym: params.defSyms)
+        assembler.addInitialDefSym(defSym.first, defSym.second);
+    if (params.havePolicy)
+        assembler.setPolicyVersion(params.policyVersion);
+    
+    /// call main assembler routine
+    bool good = false;
+    try
+    { good = assembler.assemble(); }
+    catch(...)
+    {
+        // if failed
+        progDevEntry.log = RefPtr<CLProgLogEntry>(
+                        new CLProgLogEntry(std::move(msgString)));
+        progDevEntry.status = CL_BUILD_ERROR;
+        return false;
+    }
+    if (!good)
+    {
+        progDevEntry.log = RefPtr<CLProgLogEntry>(
+                        new CLProgLogEntry(std::move(msgString)));
+        progDevEntry.status = CL_BUILD_ERROR;
+        return false;
+    }
+    // try to write binary and keep it in compiled program binaries
+    try
+    {
+        progDevEntry.status = CL_BUILD_SUCCESS;
+        Array<cxbyte> output;
+        assembler.writeBinary(output);
+        if (!params.cacheDir.empty())
+            clrxAsmCacheStore(cachePath, cacheKey, assembler.getIncludedFiles(),
+                        msgString, output);
+        /// set up logs
+        progDevEntry.log = RefPtr<CLProgLogEntry>(
+                        new CLProgLogEntry(std::move(msgString)));
+        progBin = RefPtr<CLProgBinEntry>(new CLProgBinEntry(std::move(output)));
+    }
+    catch(const Exception& ex)
+    {
+        // if exception during writing binary
+        progBin.reset();
+        msgString.append(ex.what());
+        progDevEntry.log = RefPtr<CLProgLogEntry>(
+                        new CLProgLogEntry(std::move(msgString)));
+        progDevEntry.status = CL_BUILD_ERROR;
+        return false;
+    }
+    return true;
+}
+
+/* assemble program for all jobs concurrently on bounded pool of threads.
+ * results are stored in progDevEntries and progBins by index of job,
+ * hence order of results does not depend on threads scheduling.
+ * returns false if any assembling failed */
+static bool clrxAssembleProgramForDevices(const CLAsmCommonParams& params,
+            const std::vector<CLAsmDevJob>& jobs, ProgDeviceEntry* progDevEntries,
+            RefPtr<CLProgBinEntry>* progBins)
+{
+    const size_t jobsNum = jobs.size();
+    std::unique_ptr<bool[]> jobResults(new bool[jobsNum]);
+    std::fill(jobResults.get(), jobResults.get() + jobsNum, false);
+    // exception from first failed job (in order) will be rethrown
+    runParallelJobs(jobsNum, 0, [&](size_t j)
+    {
+        const CLAsmDevJob& job = jobs[j];
+        jobResults[j] = clrxAssembleProgramForDevice(params, job,
+                    progDevEntries[job.index], progBins[job.index]);
+    });
+    
+    bool good = true;
+    for (size_t j = 0; j < jobsNum; j++)
+        if (!jobResults[j])
+            good = false;
+    return good;
+}
+
 static const char* stripCString(char* str)
 {
     while (*str==' ') str++;
@@ -1581,7 +1925,8 @@ try
     bool useCL20Std = false;
     bool useLegacy = false;
     // drivers since 200406 version uses AmdCL2 binary format by default for >=GCN1.1
-    bool useCL2StdForGCN11 = detectAmdDriverVersion() >= 200406;
+    const uint32_t driverVersion = detectAmdDriverVersion();
+    bool useCL2StdForGCN11 = driverVersion >= 200406;
     bool havePolicy = false;
     cxuint policyVersion = 0;
     
@@ -1735,17 +2080,21 @@ try
     bool asmFailure = false;
     bool asmNotAvailable = false;
     cxuint prevDeviceType = -1;
+    /* determine distinct device types to assemble (sequentially, because
+     * it calls original OpenCL implementation) */
+    std::vector<CLAsmDevJob> asmJobs;
+    std::unique_ptr<bool[]> isDupDevice(new bool[devicesNum]);
     for (cxuint i = 0; i < devicesNum; i++)
     {
         const auto& entry = outDeviceIndexMap[i];
-        ProgDeviceEntry& progDevEntry = progDeviceEntries[i];
+        isDupDevice[i] = false;
         cxuint devType = -1;
         try
         { devType = cxuint(getGPUDeviceTypeFromName(entry.devName.c_str())); }
         catch(const Exception& ex)
         {
             // if assembler not available for this device
-            progDevEntry.status = CL_BUILD_ERROR;
+            progDeviceEntries[i].status = CL_BUILD_ERROR;
             asmNotAvailable = true;
             prevDeviceType = devType;
             continue;
@@ -1754,22 +2103,10 @@ try
         if (i!=0 && devType == prevDeviceType)
         {
             // copy from previous device (if this same device type)
-            compiledProgBins[i] = compiledProgBins[i-1];
-            progDevEntry = progDeviceEntries[i-1];
+            isDupDevice[i] = true;
             continue; // skip if this same architecture
         }
         prevDeviceType = devType;
-        // assemble it
-        ArrayIStream astream(sourceCodeSize-1, sourceCode.get());
-        std::string msgString;
-        StringOStream msgStream(msgString);
-        /// determine whether use useCL20StdByDev
-        bool useCL20StdByDev = (useCL20Std || (useCL2StdForGCN11 &&
-                getGPUArchitectureFromDeviceType(GPUDeviceType(devType))
-                        >=GPUArchitecture::GCN1_1));
-        Assembler assembler("", astream, asmFlags,
-                    (useCL20StdByDev) ? BinaryFormat::AMDCL2 : BinaryFormat::AMD,
-                    GPUDeviceType(devType), msgStream);
         
         // get address bit - for bitness
         cl_uint addressBits;
@@ -1777,59 +2114,30 @@ try
                     CL_DEVICE_ADDRESS_BITS, sizeof(cl_uint), &addressBits, nullptr);
         if (error != CL_SUCCESS)
             clrxAbort("Fatal error at clCompilerCall (clGetDeviceInfo)");
-        assembler.set64Bit(addressBits==64);
-        
-        for (const CString& incPath: includePaths)
-            assembler.addIncludeDir(incPath);
-        for (const auto& defSym: defSyms)
-            assembler.addInitialDefSym(defSym.first, defSym.second);
-        if (havePolicy)
-            assembler.setPolicyVersion(policyVersion);
-        
-        /// call main assembler routine
-        bool good = false;
-        try
-        { good = assembler.assemble(); }
-        catch(...)
-        {
-            // if failed
-            progDevEntry.log = RefPtr<CLProgLogEntry>(
-                            new CLProgLogEntry(std::move(msgString)));
-            progDevEntry.status = CL_BUILD_ERROR;
-            asmFailure = true;
-            continue;
-        }
-        /// set up logs
-        progDevEntry.log = RefPtr<CLProgLogEntry>(
-                            new CLProgLogEntry(std::move(msgString)));
-        if (good)
-        {
-            // try to write binary and keep it in compiled program binaries
-            try
-            {
-                progDevEntry.status = CL_BUILD_SUCCESS;
-                Array<cxbyte> output;
-                assembler.writeBinary(output);
-                compiledProgBins[i] = RefPtr<CLProgBinEntry>(
-                            new CLProgBinEntry(std::move(output)));
-            }
-            catch(const Exception& ex)
-            {
-                // if exception during writing binary
-                compiledProgBins[i].reset();
-                msgString.append(ex.what());
-                progDevEntry.log = RefPtr<CLProgLogEntry>(
-                            new CLProgLogEntry(std::move(msgString)));
-                progDevEntry.status = CL_BUILD_ERROR;
-                asmFailure = true;
-            }
-        }
-        else // error
+        /// determine whether use useCL20StdByDev
+        bool useCL20StdByDev = (useCL20Std || (useCL2StdForGCN11 &&
+                getGPUArchitectureFromDeviceType(GPUDeviceType(devType))
+                        >=GPUArchitecture::GCN1_1));
+        asmJobs.push_back({ i, GPUDeviceType(devType), addressBits==64,
+                (useCL20StdByDev) ? BinaryFormat::AMDCL2 : BinaryFormat::AMD });
+    }
+    
+    /* assemble for all distinct device types */
+    const std::string asmCacheDir = clrxGetAsmCacheDir();
+    const CLAsmCommonParams asmParams = { sourceCode.get(), sourceCodeSize-1, asmFlags,
+            includePaths, defSyms, havePolicy, policyVersion, driverVersion, asmCacheDir,
+            RefPtr<AsmIncludeCache>(new AsmIncludeCache()) };
+    if (!clrxAssembleProgramForDevices(asmParams, asmJobs, progDeviceEntries.get(),
+                compiledProgBins.data()))
+        asmFailure = true;
+    
+    /* copy results to duplicates of devices (in order) */
+    for (cxuint i = 1; i < devicesNum; i++)
+        if (isDupDevice[i])
         {
-            progDevEntry.status = CL_BUILD_ERROR;
-            asmFailure = true;
+            compiledProgBins[i] = compiledProgBins[i-1];
+            progDeviceEntries[i] = progDeviceEntries[i-1];
         }
-    }
     /* set program binaries in order of original devices list */
     std::unique_ptr<size_t[]> programBinSizes(new size_t[devicesNum]);
     std::unique_ptr<cxbyte*[]> programBinaries(new cxbyte*[devicesNum]);
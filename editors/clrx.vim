@@ -215,6 +215,7 @@ syntax match asmPseudoOps "\.kernel_code_prefetch_offset"
 syntax match asmPseudoOps "\.kernel_code_prefetch_size"
 syntax match asmPseudoOps "\.lflags"
 syntax match asmPseudoOps "\.line"
+syntax match asmPseudoOps "\.linearscan"
 syntax match asmPseudoOps "\.llvm10binfmt"
 syntax match asmPseudoOps "\.llvm_version"
 syntax match asmPseudoOps "\.ln"
@@ -241,6 +242,7 @@ syntax match asmPseudoOps "\..metadatav3"
 syntax match asmPseudoOps "\.newbinfmt"
 syntax match asmPseudoOps "\.noaltmacro"
 syntax match asmPseudoOps "\.nobuggyfplit"
+syntax match asmPseudoOps "\.nolinearscan"
 syntax match asmPseudoOps "\.nomacrocase"
 syntax match asmPseudoOps "\.nosectdiffs"
 syntax match asmPseudoOps "\.nowave32"
@@ -266,6 +268,7 @@ syntax match asmPseudoOps "\.proginfo"
 syntax match asmPseudoOps "\.purgem"
 syntax match asmPseudoOps "\.quad"
 syntax match asmPseudoOps "\.rawcode"
+syntax match asmPseudoOps "\.regalloc_occupancy"
 syntax match asmPseudoOps "\.regvar"
 syntax match asmPseudoOps "\.rept"
 syntax match asmPseudoOps "\.reqd_work_group_size"
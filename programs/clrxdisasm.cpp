@@ -59,6 +59,8 @@ static const CLIOption programOptions[] =
         "set LLVM version (for Gallium)", "VERSION" },
     { "buggyFPLit", 0, CLIArgType::NONE, false, false,
         "use old and buggy fplit rules", nullptr },
+    { "threads", 'j', CLIArgType::UINT, false, false,
+        "disassemble kernels concurrently (0 - all hardware threads)", "THREADS" },
     CLRX_CLI_AUTOHELP
     { nullptr, 0 }
 };
@@ -107,16 +109,21 @@ try
     cxuint llvmVersion = 0;
     if (cli.hasLongOption("llvmVersion"))
         llvmVersion = cli.getLongOptArg<cxuint>("llvmVersion");
+    cxuint threadsNum = 1;
+    if (cli.hasShortOption('j'))
+        threadsNum = cli.getShortOptArg<cxuint>('j');
     
     int ret = 0;
     for (const char* const* args = cli.getArgs();*args != nullptr; args++)
     {
         std::cout << "/* Disassembling '" << *args << "\' */" << std::endl;
-        Array<cxbyte> binaryData;
+        // binary objects use data directly, hence data must be destroyed later
+        std::unique_ptr<MappedFileData> binaryDataPtr;
         std::unique_ptr<AmdMainBinaryBase> base = nullptr;
         try
         {
-            binaryData = loadDataFromFile(*args);
+            binaryDataPtr.reset(new MappedFileData(*args));
+            MappedFileData& binaryData = *binaryDataPtr;
             
             if (!fromRawCode)
             {
@@ -141,6 +148,7 @@ try
                         AmdMainGPUBinary32* amdGpuBin =
                                 static_cast<AmdMainGPUBinary32*>(base.get());
                         Disassembler disasm(*amdGpuBin, std::cout, disasmFlags);
+                        disasm.setThreadsNum(threadsNum);
                         disasm.disassemble();
                     }
                     else if (base->getType() == AmdMainType::GPU_64_BINARY)
@@ -148,6 +156,7 @@ try
                         AmdMainGPUBinary64* amdGpuBin =
                                 static_cast<AmdMainGPUBinary64*>(base.get());
                         Disassembler disasm(*amdGpuBin, std::cout, disasmFlags);
+                        disasm.setThreadsNum(threadsNum);
                         disasm.disassemble();
                     }
                     else
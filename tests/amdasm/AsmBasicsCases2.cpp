@@ -2499,5 +2499,75 @@ aa2=6
         { }, { }, { { ".", 0, 0, 0, true, false, false, 0, 0 } }, true,
         "", "isNotGCN1.4.1\n",
     },
+    /* 91 - register allocator options */
+    {   R"ffDXD(            .rawcode
+            .regalloc_occupancy 8
+            .regalloc_occupancy 11
+            .linearscan
+            .nolinearscan xx
+            .regalloc_occupancy)ffDXD",
+        BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, false, { }, { },
+        { { ".", 0U, 0, 0U, true, false, false, 0, 0 } },
+        false, "test.s:3:33: Error: Occupancy out of range (0-10)\n"
+        "test.s:5:27: Error: Garbages at end of line\n"
+        "test.s:6:32: Error: Expected expression\n", ""
+    },
+    /* 92 - macro substitutions in splitted lines and statements */
+    {   R"ffDXD(            .macro pair a, b
+            .byte \a, \
+                \b ; .byte \a\()1, \@
+            .byte \a+\x, 7
+            .endm
+            pair 2, 3
+            pair 4, (5)ffDXD",
+        BinaryFormat::AMD, GPUDeviceType::CAPE_VERDE, false, { },
+        { { nullptr, ASMKERN_GLOBAL, AsmSectionType::DATA,
+            { 0x02, 0x03, 0x15, 0x00, 0x04, 0x29, 0x01 } } },
+        { { ".", 7U, 0, 0U, true, false, false, 0, 0 } },
+        false, R"ffDXD(In macro substituted from test.s:6:13:
+test.s:4:21: Error: Unterminated expression
+In macro substituted from test.s:6:13:
+test.s:4:21: Error: Expected ',' before next value
+In macro substituted from test.s:6:13:
+test.s:4:22: Error: Garbages at end of line
+In macro substituted from test.s:7:13:
+test.s:3:20: Error: Missing ')'
+In macro substituted from test.s:7:13:
+test.s:4:21: Error: Unterminated expression
+In macro substituted from test.s:7:13:
+test.s:4:21: Error: Expected ',' before next value
+In macro substituted from test.s:7:13:
+test.s:4:22: Error: Garbages at end of line
+)ffDXD", ""
+    },
+    /* 93 - forward references to many symbols in scopes */
+    {   R"ffDXD(            .byte s0+s9, s7*2, z::t1, z::t2
+            .scope z
+            t1 = ::s3+1
+            .byte t1, t2, s8
+            .ends
+            .irp n, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9
+            s\n = \n+10
+            .endr
+            z::t2 = s1+s2)ffDXD",
+        BinaryFormat::AMD, GPUDeviceType::CAPE_VERDE, false, { },
+        { { nullptr, ASMKERN_GLOBAL, AsmSectionType::DATA,
+            { 0x1d, 0x22, 0x0e, 0x17, 0x0e, 0x17, 0x00 } } },
+        { { ".", 7U, 0, 0U, true, false, false, 0, 0 },
+          { "s0", 10U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s1", 11U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s2", 12U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s3", 13U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s4", 14U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s5", 15U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s6", 16U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s7", 17U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s8", 18U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "s9", 19U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "z::s8", 0U, ASMSECT_ABS, 0U, false, false, false, 0, 0 },
+          { "z::t1", 14U, ASMSECT_ABS, 0U, true, false, false, 0, 0 },
+          { "z::t2", 23U, ASMSECT_ABS, 0U, true, false, false, 0, 0 } },
+        true, "", ""
+    },
     { nullptr }
 };
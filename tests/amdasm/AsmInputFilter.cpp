@@ -0,0 +1,358 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <utime.h>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/amdasm/Assembler.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+struct StreamFilterLine
+{
+    LineNo lineNo;  // line number after reading line
+    const char* line;
+    std::vector<LineTrans> colTrans;
+};
+
+struct StreamFilterCase
+{
+    const char* input;
+    std::vector<StreamFilterLine> lines;
+};
+
+// lines longer than 32 characters to check copying many characters at once
+static const StreamFilterCase streamFilterTestCases[] =
+{
+    {   /* 0 - line comments, statements and spaces */
+        "        v_add_f32 v1, v2, v3 # comment with long text after instruction\n"
+        "    s_mov_b32 s1, s2; s_mov_b32 s3, s4;s_add_u32  s5,\ts6, s7   \n",
+        {
+            { 2, "        v_add_f32 v1, v2, v3                                "
+                "           ", { { 0, 1 } } },
+            { 2, "    s_mov_b32 s1, s2", { { 0, 2 } } },
+            { 2, " s_mov_b32 s3, s4", { { -21, 2 } } },
+            { 3, "s_add_u32  s5, s6, s7   ", { { -39, 2 } } }
+        }
+    },
+    {   /* 1 - long comments */
+        "v_mad_f32_with_very_long_name_to_fill_vectors v1, v2 /* long\ncomment */ v3, v4\n"
+        "/*x*/abcdefghijklmnopqrstuvwxyz0123456789abcdefghij/*y*/klmnop\n",
+        {
+            { 2, "v_mad_f32_with_very_long_name_to_fill_vectors v1, v2        ",
+                { { 0, 1 } } },
+            { 3, "           v3, v4", { { 0, 2 } } },
+            { 4, "     abcdefghijklmnopqrstuvwxyz0123456789abcdefghij     klmnop",
+                { { 0, 3 } } }
+        }
+    },
+    {   /* 2 - strings and splitted lines */
+        ".ascii \"string with spaces;#* and \\\" escapes\"   ,   'abc' # x\n"
+        ".ascii \"splitted \\\nstring\" ; "
+        "label_with_long_name_abcdefghijklmnopqrstuvwxyz: \\\n  s_endpgm\n",
+        {
+            { 2, ".ascii \"string with spaces;#* and \\\" escapes\"   ,   'abc'    ",
+                { { 0, 1 } } },
+            { 3, ".ascii \"splitted string\" ", { { 0, 2 }, { 17, 3 } } },
+            { 5, " label_with_long_name_abcdefghijklmnopqrstuvwxyz:   s_endpgm",
+                { { -9, 3 }, { 50, 4 } } }
+        }
+    },
+    {   /* 3 - splitted comment, backslash after regular characters */
+        "first_long_symbol_name_abcdefghijklmnopqrstuvwxyz = 1 # comment \\\n"
+        "continued comment\n"
+        "second_symbol_name_with_backslash_at_end_abcdefghijklmno\\\nzzz\n"
+        "unterminated \"string\nx",
+        {
+            { 3, "first_long_symbol_name_abcdefghijklmnopqrstuvwxyz = 1    "
+                "                        ", { { 0, 1 }, { 64, 2 } } },
+            { 5, "second_symbol_name_with_backslash_at_end_abcdefghijklmnozzz",
+                { { 0, 3 }, { 56, 4 } } },
+            { 6, "unterminated \"string", { { 0, 5 } } },
+            { 6, "x", { { 0, 6 } } }
+        }
+    },
+    {   /* 4 - clean lines mixed with lines to change */
+        "    s_mov_b32 s1, s2\n\n"
+        "label_with_long_name_abcdefghijklmnopqrstuvwxyz0123456789:\n"
+        "    v_add_f32 v1, v2, v3 # comment\n"
+        "    s_endpgm\n"
+        "\ts_nop 0\n"
+        "s_nop 1; s_nop 2\n"
+        "s_nop 3 /* comment */\n"
+        "s_nop 4",
+        {
+            { 2, "    s_mov_b32 s1, s2", { { 0, 1 } } },
+            { 3, "", { { 0, 2 } } },
+            { 4, "label_with_long_name_abcdefghijklmnopqrstuvwxyz0123456789:",
+                { { 0, 3 } } },
+            { 5, "    v_add_f32 v1, v2, v3          ", { { 0, 4 } } },
+            { 6, "    s_endpgm", { { 0, 5 } } },
+            { 7, " s_nop 0", { { 0, 6 } } },
+            { 7, "s_nop 1", { { 0, 7 } } },
+            { 8, " s_nop 2", { { -8, 7 } } },
+            { 9, "s_nop 3              ", { { 0, 8 } } },
+            { 9, "s_nop 4", { { 0, 9 } } }
+        }
+    }
+};
+
+// if fromFile is true, then input will be read from file (mapped to memory)
+static void testStreamFilter(cxuint testId, const StreamFilterCase& testCase,
+                bool fromFile)
+{
+    static const char* inputFileName = "AsmInputFilterTest.s";
+    std::istringstream input(testCase.input);
+    std::istringstream emptyInput("");
+    std::ostringstream msgOut;
+    Assembler assembler("", emptyInput, 0, BinaryFormat::RAWCODE,
+                GPUDeviceType::CAPE_VERDE, msgOut);
+    std::unique_ptr<AsmStreamInputFilter> filterPtr;
+    if (fromFile)
+    {
+        {
+            std::ofstream ofs(inputFileName, std::ios::binary);
+            ofs << testCase.input;
+        }
+        filterPtr.reset(new AsmStreamInputFilter(inputFileName));
+    }
+    else
+        filterPtr.reset(new AsmStreamInputFilter(input, "test.s"));
+    AsmStreamInputFilter& filter = *filterPtr;
+
+    std::ostringstream oss;
+    oss << (fromFile ? "streamFileFilter#" : "streamFilter#") << testId;
+    const std::string testName = oss.str();
+    size_t i = 0;
+    size_t lineSize;
+    const char* line;
+    for (; (line = filter.readLine(assembler, lineSize)) != nullptr; i++)
+    {
+        std::ostringstream lineOss;
+        lineOss << testName << ".line#" << i;
+        const std::string lineName = lineOss.str();
+        assertTrue(testName, lineName + ".length", i < testCase.lines.size());
+        const StreamFilterLine& expected = testCase.lines[i];
+        assertString(testName, lineName + ".text", expected.line,
+                    std::string(line, lineSize));
+        assertValue(testName, lineName + ".lineNo", expected.lineNo,
+                    filter.getLineNo());
+        const std::vector<LineTrans> colTrans = filter.getColTranslations();
+        assertValue(testName, lineName + ".colTransSize", expected.colTrans.size(),
+                    colTrans.size());
+        for (size_t j = 0; j < colTrans.size(); j++)
+        {
+            std::ostringstream ctOss;
+            ctOss << lineName << ".colTrans#" << j;
+            assertValue(testName, ctOss.str() + ".position",
+                    expected.colTrans[j].position, colTrans[j].position);
+            assertValue(testName, ctOss.str() + ".lineNo",
+                    expected.colTrans[j].lineNo, colTrans[j].lineNo);
+        }
+    }
+    assertValue(testName, "length", testCase.lines.size(), i);
+    filterPtr.reset();
+    if (fromFile)
+        ::remove(inputFileName);
+}
+
+static const char* includeCacheMessages =
+    "In file included from test.s:1:1:\n"
+    "AsmIncludeCacheTest.s:3:11: Warning: Unterminated string: newline inserted\n"
+    "In file included from test.s:1:1:\n"
+    "AsmIncludeCacheTest.s:2:8: Error: Unterminated string\n"
+    "In file included from test.s:1:1:\n"
+    "AsmIncludeCacheTest.s:3:1: Error: Garbages at statement place\n"
+    "In file included from test.s:1:1:\n"
+    "AsmIncludeCacheTest.s:4:19: Error: Unterminated multi-line comment\n"
+    "In file included from test.s:3:1:\n"
+    "AsmIncludeCacheTest.s:3:11: Warning: Unterminated string: newline inserted\n"
+    "In file included from test.s:3:1:\n"
+    "AsmIncludeCacheTest.s:2:8: Error: Unterminated string\n"
+    "In file included from test.s:3:1:\n"
+    "AsmIncludeCacheTest.s:3:1: Error: Garbages at statement place\n"
+    "In file included from test.s:3:1:\n"
+    "AsmIncludeCacheTest.s:4:19: Error: Unterminated multi-line comment\n";
+
+static void testIncludeCache()
+{
+    static const char* includeFileName = "AsmIncludeCacheTest.s";
+    {
+        std::ofstream ofs(includeFileName, std::ios::binary);
+        ofs << ".byte 1, 2 # comment\n"
+            ".ascii \"ab\n"
+            "\"\n"
+            ".byte 3 /* comment";
+    }
+    RefPtr<AsmIncludeCache> cache(new AsmIncludeCache());
+    /* first assembler puts content to cache, second assembler uses cached content,
+     * third assembler does not use cache */
+    for (cxuint i = 0; i < 3; i++)
+    {
+        std::ostringstream oss;
+        oss << "includeCache#" << i;
+        const std::string testName = oss.str();
+        std::istringstream input(".include \"AsmIncludeCacheTest.s\"\n.byte 4\n"
+                    ".include \"AsmIncludeCacheTest.s\"\n");
+        std::ostringstream msgOut;
+        Assembler assembler("test.s", input, ASM_WARNINGS, BinaryFormat::AMD,
+                    GPUDeviceType::CAPE_VERDE, msgOut);
+        assembler.setIncludeCache((i < 2) ? cache : RefPtr<AsmIncludeCache>());
+        assertValue(testName, "good", false, assembler.assemble());
+        assertString(testName, "messages", includeCacheMessages, msgOut.str());
+        const cxbyte expContent[7] = { 1, 2, 3, 4, 1, 2, 3 };
+        const std::vector<cxbyte>& content = assembler.getSections()[0].content;
+        assertArray<cxbyte>(testName, "content", Array<cxbyte>(expContent, expContent+7),
+                    content.size(), content.data());
+        assertTrue(testName, "cached", cache->getContent(includeFileName,
+                    getFileTimestamp(includeFileName), getFileSize(includeFileName)));
+    }
+    ::remove(includeFileName);
+}
+
+// assemble source that includes file, returns content of first section
+static std::vector<cxbyte> assembleWithIncludeCache(const std::string& testName,
+            RefPtr<AsmIncludeCache> cache, const char* source)
+{
+    std::istringstream input(source);
+    std::ostringstream msgOut;
+    Assembler assembler("test.s", input, ASM_WARNINGS, BinaryFormat::AMD,
+                GPUDeviceType::CAPE_VERDE, msgOut);
+    assembler.setIncludeCache(cache);
+    assertValue(testName, "good", true, assembler.assemble());
+    assertString(testName, "messages", "", msgOut.str());
+    return assembler.getSections()[0].content;
+}
+
+static void writeIncludeFile(const char* filename, const char* content,
+            time_t modTime)
+{
+    {
+        std::ofstream ofs(filename, std::ios::binary);
+        ofs << content;
+    }
+    struct utimbuf times = { modTime, modTime };
+    ::utime(filename, &times);
+}
+
+static void testIncludeCacheInvalidation()
+{
+    static const char* includeFileName = "AsmIncludeCacheTest2.s";
+    static const char* source = ".include \"AsmIncludeCacheTest2.s\"\n";
+    const std::string testName = "includeCacheInvalidation";
+    {
+        std::istringstream emptyInput("");
+        std::ostringstream msgOut;
+        Assembler assembler("", emptyInput, 0, BinaryFormat::AMD,
+                    GPUDeviceType::CAPE_VERDE, msgOut);
+        // cache is disabled by default
+        assertTrue(testName, "defaultNoCache", !assembler.getIncludeCache());
+    }
+    RefPtr<AsmIncludeCache> cache(new AsmIncludeCache());
+    writeIncludeFile(includeFileName, ".byte 1, 2\n", 1000000000);
+    assertArray<cxbyte>(testName, "content0", Array<cxbyte>({ 1, 2 }),
+                assembleWithIncludeCache(testName, cache, source));
+    // same timestamp, different size
+    writeIncludeFile(includeFileName, ".byte 3, 4, 5\n", 1000000000);
+    assertArray<cxbyte>(testName, "content1", Array<cxbyte>({ 3, 4, 5 }),
+                assembleWithIncludeCache(testName, cache, source));
+    // same size, different timestamp
+    writeIncludeFile(includeFileName, ".byte 6, 7, 8\n", 1000000010);
+    assertArray<cxbyte>(testName, "content2", Array<cxbyte>({ 6, 7, 8 }),
+                assembleWithIncludeCache(testName, cache, source));
+    // unchanged file, content from cache
+    assertTrue(testName, "cached", cache->getContent(includeFileName,
+                getFileTimestamp(includeFileName), getFileSize(includeFileName)));
+    assertArray<cxbyte>(testName, "content3", Array<cxbyte>({ 6, 7, 8 }),
+                assembleWithIncludeCache(testName, cache, source));
+    assertTrue(testName, "oldTimestamp", !cache->getContent(includeFileName,
+                1000000000000000000ULL, getFileSize(includeFileName)));
+    ::remove(includeFileName);
+}
+
+static void testIncludeCacheThreads()
+{
+    static const char* includeFileName = "AsmIncludeCacheTest3.s";
+    {
+        std::ofstream ofs(includeFileName, std::ios::binary);
+        ofs << ".byte 1, 2 /* comment */, 3\n.byte 4 # comment\n";
+    }
+    static const char* source = ".rept 20\n.include \"AsmIncludeCacheTest3.s\"\n"
+                ".endr\n";
+    const std::vector<cxbyte> expContent = assembleWithIncludeCache(
+                "includeCacheThreads", RefPtr<AsmIncludeCache>(), source);
+    assertValue("includeCacheThreads", "contentSize", size_t(80), expContent.size());
+    // many assemblers in many threads use one cache
+    RefPtr<AsmIncludeCache> cache(new AsmIncludeCache());
+    const cxuint threadsNum = 8;
+    std::vector<std::vector<cxbyte> > contents(threadsNum);
+    std::vector<std::string> errors(threadsNum);
+    std::vector<std::thread> threads;
+    for (cxuint i = 0; i < threadsNum; i++)
+        threads.push_back(std::thread([&cache, &contents, &errors, i]()
+        {
+            std::ostringstream oss;
+            oss << "includeCacheThreads#" << i;
+            try
+            {
+                for (cxuint j = 0; j < 10; j++)
+                    contents[i] = assembleWithIncludeCache(oss.str(), cache, source);
+            }
+            catch(const std::exception& ex)
+            { errors[i] = ex.what(); }
+        }));
+    for (std::thread& thread: threads)
+        thread.join();
+    for (cxuint i = 0; i < threadsNum; i++)
+    {
+        std::ostringstream oss;
+        oss << "includeCacheThreads#" << i;
+        assertString(oss.str(), "error", "", errors[i]);
+        assertArray<cxbyte>(oss.str(), "content", Array<cxbyte>(expContent.begin(),
+                    expContent.end()), contents[i]);
+    }
+    ::remove(includeFileName);
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    retVal |= callTest(testIncludeCache);
+    retVal |= callTest(testIncludeCacheInvalidation);
+    retVal |= callTest(testIncludeCacheThreads);
+    for (size_t i = 0; i < sizeof(streamFilterTestCases)/sizeof(StreamFilterCase); i++)
+        for (bool fromFile: { false, true })
+            try
+            { testStreamFilter(i, streamFilterTestCases[i], fromFile); }
+            catch(const std::exception& ex)
+            {
+                std::cerr << ex.what() << std::endl;
+                retVal = 1;
+            }
+    return retVal;
+}
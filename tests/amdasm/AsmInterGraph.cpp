@@ -0,0 +1,407 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <set>
+#include <vector>
+#include <random>
+#include <climits>
+#include <memory>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdasm/Assembler.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+typedef AsmRegAllocator::InterGraph InterGraph;
+
+// compare graph with reference adjacency sets
+static void checkInterGraph(const std::string& caseName, const InterGraph& graph,
+            const std::vector<std::set<size_t> >& refGraph)
+{
+    const size_t nodesNum = refGraph.size();
+    assertValue("InterGraph", caseName + ".size", nodesNum, graph.size());
+    assertTrue("InterGraph", caseName + ".sparse",
+               graph.isSparse() == (nodesNum > InterGraph::maxMatrixNodesNum));
+    for (size_t i = 0; i < nodesNum; i++)
+    {
+        std::ostringstream oss;
+        oss << caseName << ".node" << i;
+        const std::string nodeName = oss.str();
+        assertValue("InterGraph", nodeName + ".degree", refGraph[i].size(),
+                    graph.degree(i));
+        std::vector<size_t> neighbors;
+        graph.forEachNeighbor(i, [&neighbors](size_t nb)
+        { neighbors.push_back(nb); });
+        std::sort(neighbors.begin(), neighbors.end());
+        assertTrue("InterGraph", nodeName + ".neighbors",
+                   std::vector<size_t>(refGraph[i].begin(), refGraph[i].end()) ==
+                   neighbors);
+        for (size_t nb: refGraph[i])
+            assertTrue("InterGraph", nodeName + ".hasEdge", graph.hasEdge(nb, i));
+    }
+}
+
+static void testInterGraph(size_t nodesNum, size_t edgesNum)
+{
+    std::ostringstream oss;
+    oss << "graph" << nodesNum << "_" << edgesNum;
+    const std::string caseName = oss.str();
+    
+    std::mt19937 rng(nodesNum*131 + edgesNum);
+    InterGraph graph;
+    graph.resize(nodesNum);
+    std::vector<std::set<size_t> > refGraph(nodesNum);
+    for (size_t i = 0; nodesNum != 0 && i < edgesNum; i++)
+    {
+        const size_t a = rng() % nodesNum;
+        // put most of edges near diagonal, like live intervals of code
+        const size_t b = (i&3) != 0 ? std::min(nodesNum-1, a + rng()%70) :
+                    rng() % nodesNum;
+        const bool isNew = a != b && refGraph[a].find(b) == refGraph[a].end();
+        assertTrue("InterGraph", caseName + ".addEdge", graph.addEdge(a, b) == isNew);
+        if (a != b)
+        {
+            refGraph[a].insert(b);
+            refGraph[b].insert(a);
+        }
+    }
+    checkInterGraph(caseName, graph, refGraph);
+    
+    // resize clears all edges
+    graph.resize(nodesNum);
+    checkInterGraph(caseName + ".cleared",
+                    graph, std::vector<std::set<size_t> >(nodesNum));
+}
+
+// check whether concurrent allocation for sections gives same results as serial
+static void testParallelSections(cxuint threadsNum)
+{
+    std::ostringstream oss;
+    oss << "parallelSections" << threadsNum;
+    const std::string caseName = oss.str();
+    
+    std::ostringstream srcOss;
+    srcOss << ".amd\n.gpu CapeVerde\n";
+    const cxuint kernelsNum = 7;
+    for (cxuint i = 0; i < kernelsNum; i++)
+    {
+        const cxuint liveVgprsNum = 4 + i*5;
+        srcOss << ".kernel kernel" << i << "\n.text\n";
+        srcOss << ".regvar va" << i << ":v:" << liveVgprsNum << "\n";
+        for (cxuint k = 0; k < liveVgprsNum; k++)
+            srcOss << "v_mov_b32 va" << i << "[" << k << "], v" << (k&3) << "\n";
+        for (cxuint k = 1; k < liveVgprsNum; k++)
+            srcOss << "v_add_f32 va" << i << "[0], va" << i << "[0], va" <<
+                    i << "[" << k << "]\n";
+        srcOss << "s_endpgm\n";
+    }
+    const std::string source = srcOss.str();
+    
+    std::istringstream input(source);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::AMD, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue("InterGraph", caseName + ".good", assembler.assemble());
+    
+    std::vector<std::unique_ptr<AsmRegAllocator> > regAllocs =
+            AsmRegAllocator::allocateRegistersForSections(assembler, threadsNum);
+    assertValue("InterGraph", caseName + ".allocsSize", assembler.getSections().size(),
+                regAllocs.size());
+    cxuint allocsNum = 0;
+    for (AsmSectionId sectionId = 0; sectionId < regAllocs.size(); sectionId++)
+    {
+        if (regAllocs[sectionId] == nullptr)
+            continue;
+        allocsNum++;
+        std::ostringstream soss;
+        soss << caseName << ".section" << sectionId;
+        const std::string sectionName = soss.str();
+        // serial allocation for this section
+        AsmRegAllocator regAlloc(assembler);
+        regAlloc.allocateRegisters(sectionId);
+        const AsmRegAllocator& parRegAlloc = *regAllocs[sectionId];
+        for (size_t regType = 0; regType < regAlloc.getRegTypesNum(); regType++)
+        {
+            const Array<cxuint>& gcMap = regAlloc.getGraphColorMaps()[regType];
+            const Array<cxuint>& parGcMap = parRegAlloc.getGraphColorMaps()[regType];
+            assertValue("InterGraph", sectionName + ".colorsNum",
+                    regAlloc.getColorsNums()[regType],
+                    parRegAlloc.getColorsNums()[regType]);
+            assertTrue("InterGraph", sectionName + ".colorMap", gcMap.size() ==
+                    parGcMap.size() && std::equal(gcMap.begin(), gcMap.end(),
+                            parGcMap.begin()));
+        }
+        assertValue("InterGraph", sectionName + ".occupancy", regAlloc.getOccupancy(),
+                    parRegAlloc.getOccupancy());
+    }
+    assertValue("InterGraph", caseName + ".allocsNum", kernelsNum, allocsNum);
+}
+
+
+static const char* colorGraphSourcesTbl[] =
+{
+    R"ffDXD(.regvar sa:s:8, va:v:10
+        s_mov_b32 sa[4], sa[2]
+        s_add_u32 sa[4], sa[4], s3
+        v_xor_b32 va[4], va[2], v3
+        s_endpgm
+)ffDXD",
+    R"ffDXD(.regvar sa:s:8, va:v:12, sc:s:4
+        s_mov_b32 sa[0], s4
+        s_mov_b32 sa[1], s5
+        v_mov_b32 va[0], v0
+        v_mov_b32 va[1], v1
+loop:
+        s_add_u32 sa[2], sa[0], sa[1]
+        s_xor_b32 sa[3], sa[2], sa[0]
+        v_add_f32 va[2], va[0], va[1]
+        v_mul_f32 va[3], va[2], va[0]
+        v_mad_f32 va[4], va[3], va[2], va[1]
+        v_sub_f32 va[0], va[4], va[3]
+        s_and_b32 sa[1], sa[3], sa[1]
+        s_cmp_lg_u32 sa[1], 0
+        s_cbranch_scc1 loop
+        s_mov_b32 sc[0], sa[0]
+        s_mov_b32 sc[1], sa[1]
+        v_add_f32 va[5], va[0], va[1]
+        v_add_f32 va[6], va[5], va[4]
+        s_endpgm
+)ffDXD",
+    R"ffDXD(.regvar sa:s:12, va:v:12
+        s_mov_b32 sa[0], s4
+        s_mov_b32 sa[1], s5
+        s_mov_b32 sa[7], s6
+        s_load_dwordx4 sa[2:5], sa[0:1], 0
+        s_load_dwordx2 sa[8:9], sa[0:1], 8
+        s_waitcnt lgkmcnt(0)
+        s_add_u32 sa[6], sa[2], sa[7]
+        s_add_u32 sa[10], sa[3], sa[8]
+        v_mov_b32 va[0], sa[4]
+        v_mov_b32 va[1], sa[5]
+        v_add_f32 va[2], sa[6], va[0]
+        v_add_f32 va[3], sa[9], va[1]
+        v_mov_b32 va[4], sa[10]
+        buffer_store_dwordx4 va[0:3], v2, sa[2:5], 0 offen
+        s_endpgm
+)ffDXD"
+};
+
+// check whether allocator colored interference graph properly
+static void testColorGraph(cxuint i, const char* source)
+{
+    std::ostringstream oss;
+    oss << "colorGraph" << i;
+    const std::string caseName = oss.str();
+    
+    std::istringstream input(source);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue("InterGraph", caseName + ".good", assembler.assemble());
+    
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.allocateRegisters(0);
+    for (size_t regType = 0; regType < regAlloc.getRegTypesNum(); regType++)
+    {
+        const InterGraph& graph = regAlloc.getInterGraphs()[regType];
+        const Array<cxuint>& gcMap = regAlloc.getGraphColorMaps()[regType];
+        assertValue("InterGraph", caseName + ".colorsSize", graph.size(), gcMap.size());
+        for (size_t node = 0; node < graph.size(); node++)
+        {
+            assertTrue("InterGraph", caseName + ".colored", gcMap[node] != UINT_MAX);
+            graph.forEachNeighbor(node, [&](size_t nb)
+            {
+                assertTrue("InterGraph", caseName + ".color",
+                           gcMap[node] != gcMap[nb]);
+            });
+        }
+    }
+}
+
+// check whether linear-scan allocator assigned registers properly
+static void testLinearScan(cxuint i, const char* source)
+{
+    std::ostringstream oss;
+    oss << "linearScan" << i;
+    const std::string caseName = oss.str();
+    
+    // graph mode: get interference graph
+    std::istringstream input(source);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue("InterGraph", caseName + ".good", assembler.assemble());
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.allocateRegisters(0);
+    
+    // linear-scan mode enabled by pseudo-op
+    std::istringstream lsInput(std::string(".linearscan\n") + source);
+    Assembler lsAssembler("test.s", lsInput,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue("InterGraph", caseName + ".lsGood", lsAssembler.assemble());
+    assertTrue("InterGraph", caseName + ".isLinearScan", lsAssembler.isLinearScan());
+    AsmRegAllocator lsRegAlloc(lsAssembler);
+    lsRegAlloc.allocateRegisters(0);
+    
+    for (size_t regType = 0; regType < regAlloc.getRegTypesNum(); regType++)
+    {
+        const InterGraph& graph = regAlloc.getInterGraphs()[regType];
+        const Array<cxuint>& gcMap = lsRegAlloc.getGraphColorMaps()[regType];
+        assertValue("InterGraph", caseName + ".colorsSize", graph.size(), gcMap.size());
+        for (size_t node = 0; node < graph.size(); node++)
+        {
+            assertTrue("InterGraph", caseName + ".colored", gcMap[node] != UINT_MAX);
+            graph.forEachNeighbor(node, [&](size_t nb)
+            {
+                assertTrue("InterGraph", caseName + ".color",
+                           gcMap[node] != gcMap[nb]);
+            });
+        }
+        // linear dependencies: aligned and consecutive registers
+        for (const auto& entry: lsRegAlloc.getLinearDepMaps()[regType])
+        {
+            const AsmRegAllocator::LinearDep& ldep = entry.second;
+            if (ldep.prevVidxes.empty() && ldep.align != 0)
+                assertValue("InterGraph", caseName + ".align", cxuint(0),
+                            gcMap[entry.first] % ldep.align);
+            if (ldep.nextVidxes.size() == 1)
+                assertValue("InterGraph", caseName + ".linear", gcMap[entry.first]+1,
+                            gcMap[ldep.nextVidxes[0]]);
+        }
+    }
+}
+
+// check achieved occupancy for code with many live VGPRs
+static void testOccupancy(cxuint i, GPUDeviceType deviceType, bool wave32,
+            cxuint liveVgprsNum, cxuint targetOccupancy, cxuint expectedOccupancy,
+            bool linearScan)
+{
+    std::ostringstream oss;
+    oss << "occupancy" << i;
+    const std::string caseName = oss.str();
+    
+    std::ostringstream srcOss;
+    if (linearScan)
+        srcOss << ".linearscan\n";
+    if (wave32)
+        srcOss << ".wave32\n";
+    srcOss << ".regalloc_occupancy " << targetOccupancy << "\n";
+    srcOss << ".regvar va:v:" << liveVgprsNum << "\n";
+    for (cxuint k = 0; k < liveVgprsNum; k++)
+        srcOss << "v_mov_b32 va[" << k << "], v" << (k&3) << "\n";
+    for (cxuint k = 1; k < liveVgprsNum; k++)
+        srcOss << "v_add_f32 va[0], va[0], va[" << k << "]\n";
+    srcOss << "s_endpgm\n";
+    
+    std::istringstream input(srcOss.str());
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, deviceType, errorStream);
+    assertTrue("InterGraph", caseName + ".good", assembler.assemble());
+    assertValue("InterGraph", caseName + ".target", targetOccupancy,
+                assembler.getRegAllocOccupancy());
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.allocateRegisters(0);
+    // linear-scan reserves real registers (v0-v3) for whole code
+    assertValue("InterGraph", caseName + ".vgprsNum", liveVgprsNum + (linearScan ? 4 : 0),
+                regAlloc.getColorsNums()[1]);
+    assertValue("InterGraph", caseName + ".occupancy", expectedOccupancy,
+                regAlloc.getOccupancy());
+    const bool haveWarning = errorStream.str().find(
+                "Register allocation achieved occupancy") != std::string::npos;
+    assertTrue("InterGraph", caseName + ".warning",
+               haveWarning == (targetOccupancy > expectedOccupancy));
+}
+
+int main(int argc, const char** argv)
+{
+    static const std::pair<size_t, size_t> graphSizes[] =
+    {
+        { 0, 0 }, { 1, 4 }, { 2, 3 }, { 7, 30 }, { 65, 400 }, { 200, 3000 },
+        { 4096, 40000 }, { 4097, 40000 }, { 10000, 100000 }
+    };
+    int retVal = 0;
+    for (const std::pair<size_t, size_t>& graphSize: graphSizes)
+        try
+        { testInterGraph(graphSize.first, graphSize.second); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (cxuint i = 0; i < sizeof(colorGraphSourcesTbl)/sizeof(const char*); i++)
+        try
+        { testColorGraph(i, colorGraphSourcesTbl[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (cxuint i = 0; i < sizeof(colorGraphSourcesTbl)/sizeof(const char*); i++)
+        try
+        { testLinearScan(i, colorGraphSourcesTbl[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    for (cxuint threadsNum: { 1U, 4U, 0U })
+        try
+        { testParallelSections(threadsNum); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    static const struct { GPUDeviceType deviceType; bool wave32;
+            cxuint liveVgprsNum, target, expected; bool linearScan; }
+    occupancyCases[] =
+    {
+        { GPUDeviceType::CAPE_VERDE, false, 28, 8, 9, false },
+        { GPUDeviceType::CAPE_VERDE, false, 36, 8, 7, false },
+        { GPUDeviceType::CAPE_VERDE, false, 36, 0, 7, false },
+        { GPUDeviceType::CAPE_VERDE, false, 36, 6, 6, true },
+        { GPUDeviceType::CAPE_VERDE, false, 60, 4, 4, false },
+        /* GFX10 wave64 uses twice register file per wave than wave32 */
+        { GPUDeviceType::GFX1010, false, 60, 10, 8, false },
+        { GPUDeviceType::GFX1010, true, 60, 10, 16, false },
+        { GPUDeviceType::GFX1010, false, 36, 16, 14, false }
+    };
+    for (cxuint i = 0; i < sizeof(occupancyCases)/sizeof(occupancyCases[0]); i++)
+        try
+        { testOccupancy(i, occupancyCases[i].deviceType, occupancyCases[i].wave32,
+                    occupancyCases[i].liveVgprsNum, occupancyCases[i].target,
+                    occupancyCases[i].expected, occupancyCases[i].linearScan); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    return retVal;
+}
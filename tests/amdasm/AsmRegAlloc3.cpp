@@ -23,6 +23,7 @@
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <set>
 #include <vector>
 #include <cstring>
 #include <CLRX/utils/Utilities.h>
@@ -3167,6 +3168,322 @@ static void testCreateLivenessesCase(cxuint i, const AsmLivenessesCase& testCase
                 regAlloc.getVIdxCallMap(), revLvIndexCvtTables);
 }
 
+struct UpdateLivenessesCase
+{
+    const char* input;  // original code
+    const char* changedInput;   // code after changes in code blocks
+    size_t firstBlock, lastBlock;   // changed code blocks
+    bool incremental;   // expected result of updateBlockLivenesses
+};
+
+static const UpdateLivenessesCase updateLivenessesCasesTbl[] =
+{
+    {   // 0 - reorder code in block (the same variables read and written)
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        v_mov_b32 va[0], sa[0]
+        s_cbranch_scc0 b2
+        v_add_f32 va[1], va[0], va[0]
+        v_mul_f32 va[2], sa[1], va[1]
+        s_mov_b64 sa[4:5], sa[6:7]
+        v_mov_b32 va[3], va[2]
+        s_add_u32 sa[3], sa[4], sa[5]
+b2:     v_add_f32 va[4], va[3], va[0]
+        s_add_u32 sa[2], sa[1], sa[0]
+        s_endpgm
+)ffDXD",
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        v_mov_b32 va[0], sa[0]
+        s_cbranch_scc0 b2
+        s_mov_b64 sa[4:5], sa[6:7]
+        v_mul_f32 va[1], va[0], va[0]
+        v_mov_b32 va[2], va[1]
+        s_add_u32 sa[3], sa[5], sa[4]
+        v_add_f32 va[3], sa[1], va[2]
+b2:     v_add_f32 va[4], va[3], va[0]
+        s_add_u32 sa[2], sa[1], sa[0]
+        s_endpgm
+)ffDXD",
+        1, 2, true
+    },
+    {   // 1 - reorder code in loop
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 0
+        v_mov_b32 va[0], 0
+loop:   v_add_f32 va[0], va[0], va[1]
+        v_mul_f32 va[2], va[0], va[0]
+        v_mov_b32 va[1], va[2]
+        s_add_u32 sa[0], sa[0], 1
+        s_cbranch_scc0 loop
+        v_mov_b32 va[3], va[0]
+        s_endpgm
+)ffDXD",
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 0
+        v_mov_b32 va[0], 0
+loop:   s_add_u32 sa[0], sa[0], 1
+        v_add_f32 va[0], va[0], va[1]
+        v_mov_b32 va[2], va[0]
+        v_mul_f32 va[1], va[2], va[2]
+        s_cbranch_scc0 loop
+        v_mov_b32 va[3], va[0]
+        s_endpgm
+)ffDXD",
+        1, 2, true
+    },
+    {   // 2 - variable not written in changed block
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        v_mov_b32 va[0], sa[0]
+        s_cbranch_scc0 b2
+        v_add_f32 va[1], va[0], va[0]
+        v_mul_f32 va[2], sa[1], va[1]
+        v_mov_b32 va[3], va[2]
+b2:     v_add_f32 va[4], va[3], va[0]
+        s_endpgm
+)ffDXD",
+        R"ffDXD(.regvar sa:s:8, va:v:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        v_mov_b32 va[0], sa[0]
+        s_cbranch_scc0 b2
+        v_add_f32 va[1], va[0], va[0]
+        v_mul_f32 va[1], sa[1], va[1]
+        v_mov_b32 va[3], va[1]
+b2:     v_add_f32 va[4], va[3], va[0]
+        s_endpgm
+)ffDXD",
+        1, 2, false
+    },
+    {   // 3 - remove linear deps of variables living outside changed block
+        R"ffDXD(.regvar sa:s:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        s_cbranch_scc0 b2
+        s_load_dword sa[2], sa[0:1], 0
+        s_add_u32 sa[3], sa[0], sa[2]
+b2:     s_add_u32 sa[4], sa[0], sa[1]
+        s_endpgm
+)ffDXD",
+        R"ffDXD(.regvar sa:s:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        s_cbranch_scc0 b2
+        s_add_u32 sa[2], sa[0], sa[1]
+        s_add_u32 sa[3], sa[0], sa[2]
+b2:     s_add_u32 sa[4], sa[0], sa[1]
+        s_endpgm
+)ffDXD",
+        1, 2, true
+    },
+    {   // 4 - keep linear deps from unchanged blocks
+        R"ffDXD(.regvar sa:s:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        s_cbranch_scc0 b2
+        s_load_dword sa[2], sa[0:1], 0
+        s_add_u32 sa[3], sa[0], sa[2]
+b2:     s_load_dword sa[4], sa[0:1], 0
+        s_endpgm
+)ffDXD",
+        R"ffDXD(.regvar sa:s:8
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        s_cbranch_scc0 b2
+        s_add_u32 sa[2], sa[0], sa[1]
+        s_add_u32 sa[3], sa[0], sa[2]
+b2:     s_load_dword sa[4], sa[0:1], 0
+        s_endpgm
+)ffDXD",
+        1, 2, true
+    }
+};
+
+// dump livenesses and linear deps (with names of variables) to compare results
+static std::string dumpRegAllocLivenesses(const AsmRegAllocator& regAlloc,
+            const Assembler& assembler)
+{
+    std::unordered_map<const AsmRegVar*, CString> regVarNamesMap;
+    for (const auto& rvEntry: assembler.getRegVarMap())
+        regVarNamesMap.insert(std::make_pair(&rvEntry.second, rvEntry.first));
+    
+    std::ostringstream oss;
+    for (size_t r = 0; r < MAX_REGTYPES_NUM; r++)
+    {
+        // variable names for vidxes
+        std::vector<std::string> vidxNames(regAlloc.getOutLivenesses()[r].size());
+        for (const auto& entry: regAlloc.getVregIndexMaps()[r])
+        {
+            TestSingleVReg vreg = getTestSingleVReg(entry.first, regVarNamesMap);
+            for (size_t ssaId = 0; ssaId < entry.second.size(); ssaId++)
+                if (entry.second[ssaId] != SIZE_MAX)
+                {
+                    std::ostringstream vnOss;
+                    vnOss << vreg.name.c_str() << "[" << vreg.index << "]'" << ssaId;
+                    vidxNames[entry.second[ssaId]] = vnOss.str();
+                }
+        }
+        std::vector<std::string> lines;
+        for (size_t vidx = 0; vidx < vidxNames.size(); vidx++)
+        {
+            std::ostringstream lOss;
+            lOss << vidxNames[vidx] << ":";
+            for (const auto& interval: regAlloc.getOutLivenesses()[r][vidx])
+                lOss << " " << interval.first << "-" << interval.second;
+            auto ldit = regAlloc.getLinearDepMaps()[r].find(vidx);
+            if (ldit != regAlloc.getLinearDepMaps()[r].end())
+            {
+                std::vector<std::string> prevs, nexts;
+                for (size_t v: ldit->second.prevVidxes)
+                    prevs.push_back(vidxNames[v]);
+                for (size_t v: ldit->second.nextVidxes)
+                    nexts.push_back(vidxNames[v]);
+                std::sort(prevs.begin(), prevs.end());
+                std::sort(nexts.begin(), nexts.end());
+                lOss << "; align " << cxuint(ldit->second.align) << " prev";
+                for (const std::string& v: prevs)
+                    lOss << " " << v;
+                lOss << " next";
+                for (const std::string& v: nexts)
+                    lOss << " " << v;
+            }
+            lines.push_back(lOss.str());
+        }
+        std::sort(lines.begin(), lines.end());
+        oss << "regType " << r << "\n";
+        for (const std::string& line: lines)
+            oss << line << "\n";
+    }
+    return oss.str();
+}
+
+static void testUpdateLivenessesCase(cxuint i, const UpdateLivenessesCase& testCase)
+{
+    std::ostringstream oss;
+    oss << " testUpdateLivenesses case#" << i;
+    const std::string testCaseName = oss.str();
+    
+    std::istringstream input(testCase.input);
+    std::istringstream changedInput(testCase.changedInput);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    Assembler changedAssembler("test.s", changedInput,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue("testUpdateLivenesses", testCaseName+".good",
+               assembler.assemble() && changedAssembler.assemble());
+    const AsmSection& section = assembler.getSections()[0];
+    const AsmSection& changedSection = changedAssembler.getSections()[0];
+    assertValue("testUpdateLivenesses", testCaseName+".codeSize",
+                section.getSize(), changedSection.getSize());
+    
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.createCodeStructure(section.codeFlow, section.getSize(),
+                            section.content.data());
+    regAlloc.createSSAData(*section.usageHandler, *section.linearDepHandler);
+    regAlloc.applySSAReplaces();
+    regAlloc.createLivenesses(*section.usageHandler, *section.linearDepHandler);
+    
+    // convert register usage of changed code to register variables of first assembler
+    GCNUsageHandler usageHandler;
+    {
+        std::unordered_map<const AsmRegVar*, const AsmRegVar*> regVarCvtMap;
+        for (const auto& rvEntry: changedAssembler.getRegVarMap())
+            regVarCvtMap.insert(std::make_pair(&rvEntry.second,
+                        &assembler.getRegVarMap().find(rvEntry.first)->second));
+        ISAUsageHandler::ReadPos readPos{ 0, 0, 0 };
+        while (changedSection.usageHandler->hasNext(readPos))
+        {
+            AsmRegVarUsage rvu = changedSection.usageHandler->nextUsage(readPos);
+            if (rvu.regVar != nullptr)
+                rvu.regVar = regVarCvtMap.find(rvu.regVar)->second;
+            usageHandler.pushUsage(rvu);
+        }
+    }
+    
+    const std::string origLivenesses = dumpRegAllocLivenesses(regAlloc, assembler);
+    const bool incremental = regAlloc.updateBlockLivenesses(usageHandler,
+                *section.linearDepHandler, testCase.firstBlock, testCase.lastBlock);
+    assertValue("testUpdateLivenesses", testCaseName+".incremental",
+                testCase.incremental, incremental);
+    if (!incremental)
+    {
+        // if SSA ids changed then nothing is updated
+        assertString("testUpdateLivenesses", testCaseName+".notUpdated",
+                origLivenesses.c_str(), dumpRegAllocLivenesses(regAlloc, assembler));
+        regAlloc.recreateLivenesses(usageHandler, *section.linearDepHandler);
+    }
+    
+    // compare with livenesses created from scratch
+    AsmRegAllocator changedRegAlloc(changedAssembler);
+    changedRegAlloc.createCodeStructure(changedSection.codeFlow, changedSection.getSize(),
+                            changedSection.content.data());
+    changedRegAlloc.createSSAData(*changedSection.usageHandler,
+                *changedSection.linearDepHandler);
+    changedRegAlloc.applySSAReplaces();
+    changedRegAlloc.createLivenesses(*changedSection.usageHandler,
+                *changedSection.linearDepHandler);
+    
+    assertString("testUpdateLivenesses", testCaseName+".livenesses",
+            dumpRegAllocLivenesses(changedRegAlloc, changedAssembler).c_str(),
+            dumpRegAllocLivenesses(regAlloc, assembler));
+}
+
+// check interference graph for live blocks where later block ends before
+// end of previous block (short live range inside long live range)
+static void testInterGraphNestedLiveBlocks()
+{
+    const char* source = R"ffDXD(.regvar sa:s:4
+        s_mov_b32 sa[0], 1
+        s_mov_b32 sa[1], 2
+        s_add_u32 sa[2], sa[1], 3
+        s_add_u32 sa[3], sa[0], sa[2]
+        s_cmp_eq_u32 sa[3], 0
+        s_endpgm
+)ffDXD";
+    std::istringstream input(source);
+    std::ostringstream errorStream;
+    Assembler assembler("test.s", input,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue("testInterGraph", "nested.good", assembler.assemble());
+    
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.allocateRegisters(0);
+    const AsmRegVar* regVar = &assembler.getRegVarMap().find("sa")->second;
+    // graph node indices of sa[0], sa[1], sa[2] and sa[3] (after first write)
+    std::vector<size_t> vidxes;
+    for (uint16_t i = 0; i < 4; i++)
+    {
+        auto it = regAlloc.getVregIndexMaps()[0].find(AsmSingleVReg{ regVar, i });
+        assertTrue("testInterGraph", "nested.vidx", it != regAlloc.getVregIndexMaps()[0].end());
+        vidxes.push_back(it->second[1]);
+    }
+    // sa[0] lives while sa[1] and sa[2] live
+    std::vector<std::set<size_t> > refGraph(4);
+    refGraph[0] = { vidxes[1], vidxes[2] };
+    refGraph[1] = { vidxes[0] };
+    refGraph[2] = { vidxes[0] };
+    refGraph[3] = { };
+    const AsmRegAllocator::InterGraph& graph = regAlloc.getInterGraphs()[0];
+    assertValue("testInterGraph", "nested.size", size_t(4), graph.size());
+    for (size_t i = 0; i < 4; i++)
+    {
+        std::set<size_t> neighbors;
+        graph.forEachNeighbor(vidxes[i], [&neighbors](size_t nb)
+        { neighbors.insert(nb); });
+        std::ostringstream oss;
+        oss << "nested.sa" << i;
+        assertTrue("testInterGraph", oss.str(), neighbors == refGraph[i]);
+    }
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
@@ -3178,5 +3495,21 @@ int main(int argc, const char** argv)
             std::cerr << ex.what() << std::endl;
             retVal = 1;
         }
+    for (size_t i = 0; i < sizeof(updateLivenessesCasesTbl)/
+                sizeof(UpdateLivenessesCase); i++)
+        try
+        { testUpdateLivenessesCase(i, updateLivenessesCasesTbl[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    try
+    { testInterGraphNestedLiveBlocks(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
     return retVal;
 }
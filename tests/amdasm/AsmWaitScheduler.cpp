@@ -0,0 +1,335 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdasm/GCNDefs.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+typedef AsmWaitScheduler::QueueState QueueState;
+typedef AsmWaitScheduler::BlockState BlockState;
+
+// wait config for GCN 1.0 (same as in GCN assembler)
+static const AsmWaitConfig gcnWaitConfig10 =
+{
+    cxuint(GCNDELOP_MAX+1),
+    cxuint(GCNWAIT_MAX+1),
+    {
+        { GCNWAIT_VMCNT, true, false, 255 },  // GCNDELOP_VMOP
+        { GCNWAIT_LGKMCNT, true, false, 255 },  // GCNDELOP_LDSOP
+        { GCNWAIT_LGKMCNT, true, false, 255 },  // GCNDELOP_GDSOP
+        { GCNWAIT_LGKMCNT, true, false, 255 },  // GCNDELOP_SENDMSG
+        { GCNWAIT_LGKMCNT, false, false, 4 },  // GCNDELOP_SMOP
+        { GCNWAIT_EXPCNT, true, true, 255 },  // GCNDELOP_EXPVMWRITE
+        { GCNWAIT_EXPCNT, false, false, 255 }  // GCNDELOP_EXPORT
+    },
+    { 16, 8, 8 }
+};
+
+// schedule waits for all thread numbers (with same register allocation)
+static std::vector<std::vector<BlockState> > scheduleWaits(const char* testName,
+                const char* input, const std::vector<cxuint>& threadsNums)
+{
+    std::istringstream input2(input);
+    std::ostringstream errorStream;
+    
+    Assembler assembler("test.s", input2,
+                    (ASM_ALL&~ASM_ALTMACRO) | ASM_TESTRUN | ASM_TESTRESOLVE,
+                    BinaryFormat::RAWCODE, GPUDeviceType::CAPE_VERDE, errorStream);
+    assertTrue(testName, "assemble", assembler.assemble());
+    const AsmSection& section = assembler.getSections()[0];
+    
+    AsmRegAllocator regAlloc(assembler);
+    regAlloc.allocateRegisters(0);
+    
+    std::vector<std::vector<BlockState> > blockStatesList;
+    for (cxuint threadsNum: threadsNums)
+    {
+        AsmWaitScheduler waitScheduler(gcnWaitConfig10, assembler,
+                    regAlloc.getCodeBlocks(), regAlloc.getVregIndexMaps(),
+                    regAlloc.getGraphColorMaps(), false);
+        waitScheduler.setCollectBlockStates(true);
+        waitScheduler.schedule(*section.usageHandler, *section.waitHandler, threadsNum);
+        blockStatesList.push_back(waitScheduler.getBlockStates());
+    }
+    return blockStatesList;
+}
+
+static void checkQueueState(const std::string& testCaseName,
+                const QueueState& expQueue, const QueueState& resQueue)
+{
+    assertValue("testWaitSched", testCaseName + ".orderedSize",
+                expQueue.ordered.size(), resQueue.ordered.size());
+    for (size_t i = 0; i < expQueue.ordered.size(); i++)
+    {
+        std::ostringstream oOss;
+        oOss << ".ordered#" << i;
+        const std::string oname = testCaseName + oOss.str();
+        assertValue("testWaitSched", oname + ".size",
+                expQueue.ordered[i].size(), resQueue.ordered[i].size());
+        for (size_t j = 0; j < expQueue.ordered[i].size(); j++)
+            assertValue("testWaitSched", oname + ".reg",
+                    expQueue.ordered[i][j], resQueue.ordered[i][j]);
+    }
+    assertValue("testWaitSched", testCaseName + ".randomSize",
+                expQueue.random.size(), resQueue.random.size());
+    for (size_t j = 0; j < expQueue.random.size(); j++)
+        assertValue("testWaitSched", testCaseName + ".random.reg",
+                expQueue.random[j], resQueue.random[j]);
+    assertValue("testWaitSched", testCaseName + ".requestedQueueSize",
+                expQueue.requestedQueueSize, resQueue.requestedQueueSize);
+    assertValue("testWaitSched", testCaseName + ".reallyFlushed",
+                int(expQueue.reallyFlushed), int(resQueue.reallyFlushed));
+}
+
+static void checkWaitInstrs(const std::string& testCaseName,
+            const std::vector<AsmWaitInstr>& expWaitInstrs,
+            const std::vector<AsmWaitInstr>& resWaitInstrs)
+{
+    assertValue("testWaitSched", testCaseName + ".waitInstrsSize",
+                expWaitInstrs.size(), resWaitInstrs.size());
+    for (size_t i = 0; i < expWaitInstrs.size(); i++)
+    {
+        std::ostringstream wOss;
+        wOss << ".waitInstr#" << i;
+        const std::string wname = testCaseName + wOss.str();
+        assertValue("testWaitSched", wname + ".offset",
+                expWaitInstrs[i].offset, resWaitInstrs[i].offset);
+        for (cxuint q = 0; q < gcnWaitConfig10.waitQueuesNum; q++)
+            assertValue("testWaitSched", wname + ".waits",
+                    expWaitInstrs[i].waits[q], resWaitInstrs[i].waits[q]);
+    }
+}
+
+static const char* multiBlockSource = R"ffDXD(
+        .regvar sa:s:12, va:v:12
+        s_mov_b32 sa[0], 0
+        s_load_dwordx2 sa[2:3], s[4:5], 0
+        buffer_load_dword va[0], v0, s[0:3], 0 offen
+        buffer_load_dword va[1], v1, s[0:3], 0 offen
+        s_cmp_eq_u32 s6, 0
+        s_cbranch_scc0 b3
+b1:     s_waitcnt lgkmcnt(0)
+        s_load_dword sa[4], s[10:11], 8
+        buffer_load_dword va[2], v2, s[0:3], 0 offen
+        s_waitcnt vmcnt(1)
+        v_add_f32 va[3], va[0], va[1]
+        s_cmp_eq_u32 s7, 0
+        s_cbranch_scc1 b4
+        buffer_store_dword va[3], v3, s[0:3], 0 offen
+        s_waitcnt vmcnt(1) lgkmcnt(0)
+        v_mul_f32 va[4], sa[4], va[2]
+        s_branch b5
+b3:     s_waitcnt vmcnt(0)
+        v_sub_f32 va[5], va[0], va[1]
+        s_load_dword sa[5], s[8:9], 0
+        s_waitcnt lgkmcnt(0)
+        s_add_u32 sa[6], sa[5], sa[2]
+        s_cbranch_scc0 b1
+b4:     s_waitcnt vmcnt(0) lgkmcnt(0)
+        v_mov_b32 va[6], va[2]
+b5:     s_waitcnt vmcnt(0)
+        s_endpgm
+)ffDXD";
+
+// queues simulated in parallel must be same as queues simulated in single thread
+static void testThreadedSchedule()
+{
+    const std::vector<std::vector<BlockState> > statesList = scheduleWaits(
+                "testThreadedSchedule", multiBlockSource, { 1, 4 });
+    const std::vector<BlockState>& expStates = statesList[0];
+    const std::vector<BlockState>& resStates = statesList[1];
+    
+    assertValue("testWaitSched", "threaded.blockStatesSize",
+                size_t(6), resStates.size());
+    assertValue("testWaitSched", "threaded.blockStatesSize",
+                expStates.size(), resStates.size());
+    // two buffer loads in first block are in separate entries of VM queue
+    assertValue("testWaitSched", "threaded.block#0.queue#0.orderedSize",
+                size_t(2), expStates[0].queues[0].ordered.size());
+    for (size_t i = 0; i < expStates.size(); i++)
+    {
+        std::ostringstream bOss;
+        bOss << "threaded.block#" << i;
+        const std::string bname = bOss.str();
+        checkWaitInstrs(bname, expStates[i].waitInstrs, resStates[i].waitInstrs);
+        for (cxuint q = 0; q < gcnWaitConfig10.waitQueuesNum; q++)
+        {
+            std::ostringstream qOss;
+            qOss << ".queue#" << q;
+            checkQueueState(bname + qOss.str(), expStates[i].queues[q],
+                        resStates[i].queues[q]);
+            checkQueueState(bname + ".joined" + qOss.str(),
+                        expStates[i].joinedQueues[q], resStates[i].joinedQueues[q]);
+        }
+    }
+}
+
+static QueueState makeQueueState(const std::vector<std::vector<uint16_t> >& ordered,
+            const std::vector<uint16_t>& random, cxuint requestedQueueSize,
+            bool reallyFlushed)
+{
+    QueueState queue;
+    queue.ordered = ordered;
+    queue.random = random;
+    queue.requestedQueueSize = requestedQueueSize;
+    queue.reallyFlushed = reallyFlushed;
+    return queue;
+}
+
+// block requests bigger queue than number of entries in joined queue
+static void testJoinNextBiggerQueue()
+{
+    const std::vector<BlockState> states = scheduleWaits("testJoinNextBiggerQueue",
+        R"ffDXD(
+        .regvar sa:s:4, va:v:4
+        buffer_load_dword va[0], v0, s[0:3], 0 offen
+        s_cbranch_scc0 b1
+        v_mov_b32 va[2], va[0]
+b1:     s_endpgm
+)ffDXD", { 1 })[0];
+    assertValue("testWaitSched", "joinNext.blockStatesSize", size_t(3), states.size());
+    // VM queue of first block requests 17 entries, but has only one entry
+    checkQueueState("joinNext.block#0.queue#0", makeQueueState(
+                { { 0x8100 } }, { }, 17, false), states[0].queues[0]);
+    // requested size limited to maximal queue size, entries are not duplicated
+    checkQueueState("joinNext.block#0.joined.queue#0", makeQueueState(
+                { { 0x8100 } }, { }, 16, false), states[0].joinedQueues[0]);
+    checkQueueState("joinNext.block#0.joined.queue#1", makeQueueState(
+                { }, { }, 8, false), states[0].joinedQueues[1]);
+}
+
+// wait instruction is first instruction in code block
+static void testFirstWaitAfterBlockBoundary()
+{
+    const std::vector<BlockState> states = scheduleWaits(
+        "testFirstWaitAfterBlockBoundary", R"ffDXD(
+        .regvar sa:s:4, va:v:4
+        s_load_dword sa[0], s[4:5], 0
+        s_cbranch_scc0 b1
+        s_mov_b32 sa[2], 1
+b1:     s_waitcnt lgkmcnt(0)
+        s_load_dword sa[1], s[6:7], 0
+        s_add_u32 sa[3], sa[0], sa[1]
+        s_endpgm
+)ffDXD", { 1 })[0];
+    assertValue("testWaitSched", "firstWait.blockStatesSize", size_t(3), states.size());
+    checkWaitInstrs("firstWait.block#0", { }, states[0].waitInstrs);
+    checkWaitInstrs("firstWait.block#1", { }, states[1].waitInstrs);
+    // s_waitcnt at block start and wait generated before s_add_u32
+    checkWaitInstrs("firstWait.block#2", {
+                { 12, { 15, 0, 7, 0 } },
+                { 20, { 15, 0, 7, 0 } } }, states[2].waitInstrs);
+    checkQueueState("firstWait.block#2.queue#1", makeQueueState(
+                { }, { }, 0, false), states[2].queues[1]);
+}
+
+// consecutive delayed operations are in separate entries of ordered queue
+static void testSeparateDelayedOps()
+{
+    const std::vector<BlockState> states = scheduleWaits("testSeparateDelayedOps",
+        R"ffDXD(
+        .regvar va:v:4
+        buffer_load_dword va[0], v0, s[0:3], 0 offen
+        buffer_load_dword va[1], v1, s[0:3], 0 offen
+        s_cbranch_scc0 b1
+b1:     v_add_f32 va[2], va[0], va[1]
+        s_endpgm
+)ffDXD", { 1 })[0];
+    assertValue("testWaitSched", "separate.blockStatesSize", size_t(2), states.size());
+    const QueueState& queue = states[0].queues[0];
+    assertValue("testWaitSched", "separate.queue#0.orderedSize",
+                size_t(2), queue.ordered.size());
+    assertValue("testWaitSched", "separate.queue#0.ordered#0.size",
+                size_t(1), queue.ordered[0].size());
+    assertValue("testWaitSched", "separate.queue#0.ordered#1.size",
+                size_t(1), queue.ordered[1].size());
+    assertTrue("testWaitSched", "separate.queue#0.regs",
+                queue.ordered[0][0] != queue.ordered[1][0]);
+}
+
+// buffer store with second queue (EXPCNT) of delayed op does not wait for itself
+// in VM queue
+static void testSecondQueueOfDelayedOp()
+{
+    const std::vector<BlockState> states = scheduleWaits("testSecondQueueOfDelayedOp",
+        R"ffDXD(
+        .regvar va:v:4
+        v_mov_b32 va[0], v0
+        buffer_store_dword va[0], v1, s[0:3], 0 offen
+        s_cbranch_scc0 b1
+b1:     s_endpgm
+)ffDXD", { 1 })[0];
+    assertValue("testWaitSched", "queue2.blockStatesSize", size_t(2), states.size());
+    // store is in VM queue as single entry
+    checkQueueState("queue2.block#0.queue#0", makeQueueState(
+                { { } }, { }, 15, false), states[0].queues[0]);
+    for (const AsmWaitInstr& waitInstr: states[0].waitInstrs)
+        assertValue("testWaitSched", "queue2.block#0.vmcnt",
+                    uint16_t(15), waitInstr.waits[0]);
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    try
+    { testThreadedSchedule(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testJoinNextBiggerQueue(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testSeparateDelayedOps(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testSecondQueueOfDelayedOp(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    try
+    { testFirstWaitAfterBlockBoundary(); }
+    catch(const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        retVal = 1;
+    }
+    return retVal;
+}
@@ -2210,6 +2210,9 @@ static void testDisasmData(cxuint testId, const DisasmAmdTestCase& testCase)
 {
     std::ostringstream disasmOss;
     std::string resultStr;
+    // result of concurrent disassembling (only for AMD binaries)
+    std::ostringstream parDisasmOss;
+    std::string parResultStr;
     Flags disasmFlags = DISASM_ALL&~DISASM_CODEPOS;
     if (testCase.config)
         disasmFlags |= DISASM_CONFIG;
@@ -2228,6 +2231,10 @@ static void testDisasmData(cxuint testId, const DisasmAmdTestCase& testCase)
             Disassembler disasm(testCase.amdInput, disasmOss, disasmFlags);
             disasm.disassemble();
             resultStr = disasmOss.str();
+            Disassembler parDisasm(testCase.amdInput, parDisasmOss, disasmFlags);
+            parDisasm.setThreadsNum(3);
+            parDisasm.disassemble();
+            parResultStr = parDisasmOss.str();
         }
         else if (testCase.galliumInput != nullptr)
         {
@@ -2253,6 +2260,10 @@ static void testDisasmData(cxuint testId, const DisasmAmdTestCase& testCase)
             Disassembler disasm(*amdGpuBin, disasmOss, disasmFlags);
             disasm.disassemble();
             resultStr = disasmOss.str();
+            Disassembler parDisasm(*amdGpuBin, parDisasmOss, disasmFlags);
+            parDisasm.setThreadsNum(3);
+            parDisasm.disassemble();
+            parResultStr = parDisasmOss.str();
         }
         else if (isAmdCL2Binary(binaryData.size(), binaryData.data()))
         {
@@ -2318,6 +2329,10 @@ static void testDisasmData(cxuint testId, const DisasmAmdTestCase& testCase)
         oss.flush();
         throw Exception(oss.str());
     }
+    // concurrent disassembling must give same output
+    if (!parResultStr.empty())
+        assertString("DisasmData", caseName + ".parallel", resultStr.c_str(),
+                     parResultStr);
 }
 
 int main(int argc, const char** argv)
@@ -4076,6 +4076,12 @@ const GCNDisasmOpcodeCase2 decGCNOpcodeGCN15Cases2[] =
         "v55, v180, 0x3d4c /* 1.3242h */, v229 op_sel_hi:[0,0,0]\n" },
     { { 0xcc0e0037U, 0x03ff4c47U, 0x3d4c }, 3, "        v_pk_fma_f16    "
         "v55, s71, v166, 0x3d4c /* 1.3242h */ op_sel_hi:[0,0,0]\n" },
+    /* non-NSA MIMG followed by next instruction */
+    { { 0xf2003b00U, 0x00159d79U, 0xbf800000U }, 3, "        image_load      v[157:159], "
+        "v121, s[84:91] dmask:11 dim:1d unorm glc slc\n        s_nop           0x0\n" },
+    /* VOP3 with literal at end of code */
+    { { 0xd5510037U, 0x07974cffU }, 2, "        v_min3_f32      "
+        "v55, lit(0) /* 0f */, v166, v229\n" },
     { {}, 0, nullptr }
 };
 
@@ -71,7 +71,9 @@ static void testDecGCNOpcodes2(cxuint i, const GCNDisasmOpcodeCase2& testCase,
     Disassembler disasm(&input, disOss, DISASM_FLOATLITS);
     GCNDisassembler gcnDisasm(disasm);
     // create input code
-    uint32_t inputCode[6];
+    // words after code are filled by guard to detect reading beyond end of code
+    uint32_t inputCode[6] = { 0x55555555U, 0x55555555U, 0x55555555U,
+            0x55555555U, 0x55555555U, 0x55555555U };
     for (cxuint i = 0; i < testCase.wordsNum; i++)
         inputCode[i] = LEV(testCase.words[i]);
     gcnDisasm.setInput(testCase.wordsNum<<2, reinterpret_cast<cxbyte*>(inputCode));
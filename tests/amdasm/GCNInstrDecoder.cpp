@@ -0,0 +1,254 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <CLRX/utils/Utilities.h>
+#include <CLRX/utils/Containers.h>
+#include <CLRX/amdasm/Assembler.h>
+#include <CLRX/amdasm/Disassembler.h>
+#include <CLRX/amdasm/GCNDefs.h>
+#include <CLRX/utils/MemAccess.h>
+#include "../TestUtils.h"
+#include "GCNDisasmOpc.h"
+
+using namespace CLRX;
+
+struct GCNDecOperand
+{
+    cxbyte field;
+    uint16_t code;
+};
+
+struct GCNInstrDecoderCase
+{
+    GPUDeviceType deviceType;
+    Array<uint32_t> words;
+    cxuint wordsNum;
+    GCNEncoding encoding;
+    const char* mnemonic;
+    Array<GCNDecOperand> operands;
+    bool haveLiteral;
+    uint32_t literal;
+    int32_t imm;
+    uint32_t modifiers;
+};
+
+static const GCNInstrDecoderCase gcnInstrDecoderCases[] =
+{
+    {   /* 0 - SOP2 */
+        GPUDeviceType::PITCAIRN, { 0x81953d04U }, 1, GCNEncoding::SOP2, "s_sub_i32",
+        { { GCNFIELD_SDST, 21 }, { GCNFIELD_SSRC0, 4 }, { GCNFIELD_SSRC1, 61 } },
+        false, 0, 0, 0
+    },
+    {   /* 1 - SOP2 with literal */
+        GPUDeviceType::PITCAIRN, { 0x807fff05U, 0xd3abc5fU }, 2, GCNEncoding::SOP2,
+        "s_add_u32",
+        { { GCNFIELD_SDST, 127 }, { GCNFIELD_SSRC0, 5 }, { GCNFIELD_SSRC1, 255 } },
+        true, 0xd3abc5fU, 0, 0
+    },
+    {   /* 2 - SOPK */
+        GPUDeviceType::PITCAIRN, { 0xb1abd3b9U }, 1, GCNEncoding::SOPK, "s_cmpk_eq_i32",
+        { { GCNFIELD_SDST, 43 } }, false, 0, int16_t(0xd3b9), 0
+    },
+    {   /* 3 - SOPP */
+        GPUDeviceType::PITCAIRN, { 0xbf82fffeU }, 1, GCNEncoding::SOPP, "s_branch",
+        { }, false, 0, -2, 0
+    },
+    {   /* 4 - VOP2 */
+        GPUDeviceType::PITCAIRN, { 0x0134d715U }, 1, GCNEncoding::VOP2, "v_cndmask_b32",
+        { { GCNFIELD_VOP_VDST, 256+154 }, { GCNFIELD_VOP_SRC0, 256+21 },
+          { GCNFIELD_VOP_VSRC1, 256+107 } }, false, 0, 0, 0
+    },
+    {   /* 5 - VOP3A with neg */
+        GPUDeviceType::PITCAIRN, { 0xd22e0037U, 0x4002b41bU }, 2, GCNEncoding::VOP3A,
+        "v_ashr_i32",
+        { { GCNFIELD_VOP3_VDST, 256+55 }, { GCNFIELD_VOP3_SRC0, 27 },
+          { GCNFIELD_VOP3_SRC1, 256+90 }, { GCNFIELD_VOP3_SRC2, 0 } },
+        false, 0, 0, GCNDECMOD_NEG1
+    },
+    {   /* 6 - DS */
+        GPUDeviceType::PITCAIRN, { 0xd814cd67U, 0x0000a947U }, 2, GCNEncoding::DS,
+        "ds_min_i32",
+        { { GCNFIELD_DS_ADDR, 256+71 }, { GCNFIELD_DS_DATA0, 256+169 },
+          { GCNFIELD_DS_DATA1, 256 }, { GCNFIELD_DS_VDST, 256 } },
+        false, 0, 52583, 0
+    },
+    {   /* 7 - MTBUF with all flags */
+        GPUDeviceType::PITCAIRN, { 0xea88f7d4U, 0x23f43d12U }, 2, GCNEncoding::MTBUF,
+        "tbuffer_load_format_x",
+        { { GCNFIELD_M_VADDR, 256+18 }, { GCNFIELD_M_VDATA, 256+61 },
+          { GCNFIELD_M_SRSRC, 80 }, { GCNFIELD_M_SOFFSET, 35 } },
+        false, 0, 2004, GCNDECMOD_OFFEN|GCNDECMOD_IDXEN|GCNDECMOD_GLC|
+                GCNDECMOD_ADDR64|GCNDECMOD_SLC|GCNDECMOD_TFE
+    },
+    {   /* 8 - SMEM (GCN 1.2) with immediate offset */
+        GPUDeviceType::TONGA, { 0xc0060b03U, 0x0005b1cU }, 2, GCNEncoding::SMEM,
+        "s_load_dwordx2",
+        { { GCNFIELD_SMRD_SDST, 44 }, { GCNFIELD_SMRD_SBASE, 6 } },
+        false, 0, 0x5b1c, GCNDECMOD_IMM
+    },
+    {   /* 9 - illegal opcode */
+        GPUDeviceType::PITCAIRN, { 0x86153d04U }, 1, GCNEncoding::SOP2, nullptr,
+        { { GCNFIELD_SDST, 21 }, { GCNFIELD_SSRC0, 4 }, { GCNFIELD_SSRC1, 61 } },
+        false, 0, 0, GCNDECMOD_ILLEGAL
+    },
+    {   /* 10 - MIMG NSA (GCN 1.5), 6 addresses, padding bytes are skipped */
+        GPUDeviceType::GFX1010, { 0xf2883b0cU, 0x02759d79U, 0x615b492cU, 0xd8U }, 4,
+        GCNEncoding::MIMG, "image_sample_d",
+        { { GCNFIELD_M_VADDR, 256+121 }, { GCNFIELD_M_VDATA, 256+157 },
+          { GCNFIELD_M_SRSRC, 84 }, { GCNFIELD_MIMG_SSAMP, 76 },
+          { GCNFIELD_M_VADDR_MULTI+1, 256+44 }, { GCNFIELD_M_VADDR_MULTI+2, 256+73 },
+          { GCNFIELD_M_VADDR_MULTI+3, 256+91 }, { GCNFIELD_M_VADDR_MULTI+4, 256+97 },
+          { GCNFIELD_M_VADDR_MULTI+5, 256+216 } },
+        false, 0, 11, GCNDECMOD_GLC|GCNDECMOD_SLC
+    },
+    {   /* 11 - MIMG NSA (GCN 1.5), 12 addresses */
+        GPUDeviceType::GFX1010, { 0xf2ec3b16U, 0x02759d79U, 0x615b492cU, 0x199b3ed8U,
+            0x00090177U }, 5, GCNEncoding::MIMG, "image_sample_c_d_cl_o",
+        { { GCNFIELD_M_VADDR, 256+121 }, { GCNFIELD_M_VDATA, 256+157 },
+          { GCNFIELD_M_SRSRC, 84 }, { GCNFIELD_MIMG_SSAMP, 76 },
+          { GCNFIELD_M_VADDR_MULTI+1, 256+44 }, { GCNFIELD_M_VADDR_MULTI+2, 256+73 },
+          { GCNFIELD_M_VADDR_MULTI+3, 256+91 }, { GCNFIELD_M_VADDR_MULTI+4, 256+97 },
+          { GCNFIELD_M_VADDR_MULTI+5, 256+216 }, { GCNFIELD_M_VADDR_MULTI+6, 256+62 },
+          { GCNFIELD_M_VADDR_MULTI+7, 256+155 }, { GCNFIELD_M_VADDR_MULTI+8, 256+25 },
+          { GCNFIELD_M_VADDR_MULTI+9, 256+119 }, { GCNFIELD_M_VADDR_MULTI+10, 256+1 },
+          { GCNFIELD_M_VADDR_MULTI+11, 256+9 } },
+        false, 0, 11, GCNDECMOD_GLC|GCNDECMOD_SLC
+    }
+};
+
+static void testGCNInstrDecoder(cxuint i, const GCNInstrDecoderCase& testCase)
+{
+    std::ostringstream caseOss;
+    caseOss << "decCase#" << i;
+    const std::string caseName = caseOss.str();
+    Array<uint32_t> code(testCase.words.size());
+    for (size_t k = 0; k < testCase.words.size(); k++)
+        code[k] = LEV(testCase.words[k]);
+    GCNInstrDecoder decoder(testCase.deviceType, code.size()<<2,
+                reinterpret_cast<const cxbyte*>(code.data()), 0x100);
+    GCNDecodedInstr instr;
+    if (!decoder.next(instr))
+        throw Exception("FAILED "+caseName+": no instruction");
+    assertValue("GCNInstrDecoder", caseName+".offset", size_t(0x100), instr.offset);
+    assertValue("GCNInstrDecoder", caseName+".wordsNum", testCase.wordsNum,
+                instr.wordsNum);
+    assertValue("GCNInstrDecoder", caseName+".encoding", cxuint(testCase.encoding),
+                cxuint(instr.encoding));
+    assertString("GCNInstrDecoder", caseName+".mnemonic", testCase.mnemonic,
+                instr.mnemonic);
+    assertValue("GCNInstrDecoder", caseName+".operandsNum",
+                cxuint(testCase.operands.size()), instr.operandsNum);
+    for (cxuint k = 0; k < instr.operandsNum; k++)
+    {
+        std::ostringstream opOss;
+        opOss << caseName << ".operand#" << k;
+        assertValue("GCNInstrDecoder", opOss.str()+".field",
+                cxuint(testCase.operands[k].field), cxuint(instr.operands[k].field));
+        assertValue("GCNInstrDecoder", opOss.str()+".code",
+                cxuint(testCase.operands[k].code), cxuint(instr.operands[k].code));
+    }
+    assertValue("GCNInstrDecoder", caseName+".haveLiteral", testCase.haveLiteral,
+                instr.haveLiteral);
+    if (testCase.haveLiteral)
+        assertValue("GCNInstrDecoder", caseName+".literal", testCase.literal,
+                instr.literal);
+    assertValue("GCNInstrDecoder", caseName+".imm", testCase.imm, instr.imm);
+    assertValue("GCNInstrDecoder", caseName+".modifiers", testCase.modifiers,
+                instr.modifiers);
+    assertValue("GCNInstrDecoder", caseName+".atEnd", true, decoder.atEnd());
+    assertValue("GCNInstrDecoder", caseName+".next", false, decoder.next(instr));
+}
+
+// compare mnemonics and instruction sizes with disassembler output
+static void testGCNInstrDecoderOpcodes(const char* setName,
+            const GCNDisasmOpcodeCase* cases, GPUDeviceType deviceType)
+{
+    for (cxuint i = 0; cases[i].expected != nullptr; i++)
+    {
+        const GCNDisasmOpcodeCase& testCase = cases[i];
+        const char* expected = testCase.expected;
+        // skip warnings and unknown instructions
+        if (::strncmp(expected, "        /*", 10) == 0 ||
+            ::strncmp(expected, "        .int", 12) == 0)
+            continue;
+        uint32_t inputCode[2] = { LEV(testCase.word0), LEV(testCase.word1) };
+        GCNInstrDecoder decoder(deviceType, testCase.twoWords?8:4,
+                    reinterpret_cast<const cxbyte*>(inputCode));
+        GCNDecodedInstr instr;
+        std::ostringstream caseOss;
+        caseOss << setName << "#" << i;
+        const std::string caseName = caseOss.str();
+        decoder.next(instr);
+        if (instr.mnemonic == nullptr)
+        {
+            // disassembler prints illegal instructions as ENC_ill_OPCODE
+            if (::strstr(expected, "_ill_") == nullptr)
+                throw Exception("FAILED "+caseName+": illegal instruction for: "+
+                            expected);
+            continue;
+        }
+        const size_t mnemonicLen = ::strlen(instr.mnemonic);
+        if (::strncmp(expected+8, instr.mnemonic, mnemonicLen) != 0 ||
+            (expected[8+mnemonicLen] != ' ' && expected[8+mnemonicLen] != '\n'))
+            throw Exception("FAILED "+caseName+": mnemonic "+instr.mnemonic+
+                        " for: "+expected);
+        assertValue("GCNInstrDecoder", caseName+".wordsNum",
+                    cxuint(testCase.twoWords?2:1), instr.wordsNum);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    for (cxuint i = 0; i < sizeof(gcnInstrDecoderCases)/sizeof(GCNInstrDecoderCase); i++)
+        try
+        { testGCNInstrDecoder(i, gcnInstrDecoderCases[i]); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    
+    static const struct {
+        const char* name;
+        const GCNDisasmOpcodeCase* cases;
+        GPUDeviceType deviceType;
+    } opcodeSets[] =
+    {
+        { "GCN10", decGCNOpcodeCases, GPUDeviceType::PITCAIRN },
+        { "GCN11", decGCNOpcodeGCN11Cases, GPUDeviceType::HAWAII },
+        { "GCN12", decGCNOpcodeGCN12Cases, GPUDeviceType::TONGA },
+        { "GCN14", decGCNOpcodeGCN14Cases, GPUDeviceType::GFX900 },
+        { "GCN141", decGCNOpcodeGCN141Cases, GPUDeviceType::GFX906 },
+        { "GCN15", decGCNOpcodeGCN15Cases, GPUDeviceType::GFX1010 }
+    };
+    for (const auto& set: opcodeSets)
+        try
+        { testGCNInstrDecoderOpcodes(set.name, set.cases, set.deviceType); }
+        catch(const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            retVal = 1;
+        }
+    return retVal;
+}
@@ -21,6 +21,8 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <CLRX/utils/Utilities.h>
 #include <CLRX/amdasm/Assembler.h>
 #include <CLRX/utils/Containers.h>
@@ -2106,7 +2108,7 @@ static void testGCNRegVarUsages(cxuint i, const GCNRegVarUsageCase& testCase)
     std::unordered_map<const AsmRegVar*, CString> regVarNamesMap;
     pushRegVarsFromScopes(assembler.getGlobalScope(), regVarNamesMap, "");
     ISAUsageHandler* usageHandler = assembler.getSections()[0].usageHandler.get();
-    ISAUsageHandler::ReadPos usagePos{ 0, 0 };
+    ISAUsageHandler::ReadPos usagePos{ 0, 0, 0 };
     size_t j;
     for (j = 0; usageHandler->hasNext(usagePos); j++)
     {
@@ -2145,6 +2147,87 @@ static void testGCNRegVarUsages(cxuint i, const GCNRegVarUsageCase& testCase)
                    j == testCase.regVarUsages.size());
 }
 
+/* test packed encoding of usages: many usages in many chunks (64K ranges),
+ * long offset gaps, big register indices, and finding positions by offset */
+static void testUsageHandlerPacking()
+{
+    AsmRegVar regVars[3] = { { REGTYPE_SGPR, 4 }, { REGTYPE_VGPR, 300 },
+                { REGTYPE_VGPR, 2 } };
+    std::vector<AsmRegVarUsage> rvus;
+    size_t offset = 0;
+    uint32_t state = 7654321;
+    for (cxuint i = 0; i < 20000; i++)
+    {
+        state = state*1103515245U + 12345U;
+        // zero delta - next usage of same instruction
+        if ((state>>8) % 3 != 0)
+            offset += ((state>>12) % 10 == 0) ? 4 + (state>>16) % 100000 : 4;
+        const cxuint rvi = (state>>20) % 4;
+        const uint16_t rstart = (rvi==1) ? (state>>14) % 296 : (state>>14) % 2;
+        rvus.push_back({ offset, rvi!=3 ? regVars+rvi : nullptr, rstart,
+                uint16_t(rstart + 1 + (state>>24) % 4), AsmRegField(GCNFIELD_VOP_SRC0 + state%3),
+                cxbyte(1 + (state>>6) % 3), cxbyte((state>>4) & 1 ? 2 : 0),
+                ((state>>3) & 1)!=0 });
+    }
+    
+    GCNUsageHandler usageHandler;
+    for (const AsmRegVarUsage& rvu: rvus)
+        usageHandler.pushUsage(rvu);
+    
+    ISAUsageHandler::ReadPos usagePos{ 0, 0, 0 };
+    size_t j;
+    for (j = 0; usageHandler.hasNext(usagePos); j++)
+    {
+        std::ostringstream rvuOss;
+        rvuOss << "rvu#" << j << ".";
+        std::string rvuName(rvuOss.str());
+        assertTrue("testUsageHandlerPacking", rvuName+"length", j < rvus.size());
+        const AsmRegVarUsage& expected = rvus[j];
+        const AsmRegVarUsage result = usageHandler.nextUsage(usagePos);
+        assertValue("testUsageHandlerPacking", rvuName+"offset",
+                    expected.offset, result.offset);
+        assertTrue("testUsageHandlerPacking", rvuName+"regVar",
+                    expected.regVar == result.regVar);
+        assertValue("testUsageHandlerPacking", rvuName+"rstart",
+                    expected.rstart, result.rstart);
+        assertValue("testUsageHandlerPacking", rvuName+"rend",
+                    expected.rend, result.rend);
+        assertValue("testUsageHandlerPacking", rvuName+"regField",
+                    cxuint(expected.regField), cxuint(result.regField));
+        assertValue("testUsageHandlerPacking", rvuName+"rwFlags",
+                    cxuint(expected.rwFlags), cxuint(result.rwFlags));
+        assertValue("testUsageHandlerPacking", rvuName+"align",
+                    cxuint(expected.align), cxuint(result.align));
+        assertValue("testUsageHandlerPacking", rvuName+"useRegMode",
+                    int(expected.useRegMode), int(result.useRegMode));
+    }
+    assertValue("testUsageHandlerPacking", "length", rvus.size(), j);
+    
+    // find position by offset (first usage not before offset)
+    for (cxuint i = 0; i < 2000; i++)
+    {
+        state = state*1103515245U + 12345U;
+        const size_t findOffset = size_t(state>>4) % (offset + 8);
+        std::ostringstream findOss;
+        findOss << "find#" << i << ".";
+        std::string findName(findOss.str());
+        size_t expectedIndex = std::lower_bound(rvus.begin(), rvus.end(), findOffset,
+                [](const AsmRegVarUsage& a, size_t b)
+                { return a.offset < b; }) - rvus.begin();
+        ISAUsageHandler::ReadPos readPos =
+                usageHandler.findPositionByOffset(findOffset);
+        assertValue("testUsageHandlerPacking", findName+"hasNext",
+                    int(expectedIndex < rvus.size()), int(usageHandler.hasNext(readPos)));
+        if (expectedIndex < rvus.size())
+            assertValue("testUsageHandlerPacking", findName+"offset",
+                    rvus[expectedIndex].offset, usageHandler.nextUsage(readPos).offset);
+        // check next usage
+        if (expectedIndex+1 < rvus.size())
+            assertValue("testUsageHandlerPacking", findName+"offset2",
+                    rvus[expectedIndex+1].offset, usageHandler.nextUsage(readPos).offset);
+    }
+}
+
 int main(int argc, const char** argv)
 {
     int retVal = 0;
@@ -2156,5 +2239,6 @@ int main(int argc, const char** argv)
             std::cerr << ex.what() << std::endl;
             retVal = 1;
         }
+    retVal |= callTest(testUsageHandlerPacking);
     return retVal;
 }
@@ -307,6 +307,68 @@ static void testGetGPUExtraRegsNum()
     }
 }
 
+struct GPUWavesRegsTestCase
+{
+    GPUArchitecture arch;
+    cxuint regType;
+    Flags flags;
+    cxuint wavesNum;
+    cxuint regsNum;
+};
+
+// getGPUMaxRegsNumForWaves testcase table
+static const GPUWavesRegsTestCase gpuWavesRegsTestTable[] =
+{
+    { GPUArchitecture::GCN1_0, REGTYPE_VGPR, 0, 1, 256 },
+    { GPUArchitecture::GCN1_0, REGTYPE_VGPR, 0, 3, 84 },
+    { GPUArchitecture::GCN1_0, REGTYPE_VGPR, 0, 4, 64 },
+    { GPUArchitecture::GCN1_0, REGTYPE_VGPR, 0, 7, 36 },
+    { GPUArchitecture::GCN1_0, REGTYPE_VGPR, 0, 8, 32 },
+    { GPUArchitecture::GCN1_2, REGTYPE_VGPR, 0, 10, 24 },
+    { GPUArchitecture::GCN1_4, REGTYPE_VGPR, 0, 5, 48 },
+    { GPUArchitecture::GCN1_0, REGTYPE_SGPR, 0, 4, 104 },
+    { GPUArchitecture::GCN1_0, REGTYPE_SGPR, 0, 5, 96 },
+    { GPUArchitecture::GCN1_1, REGTYPE_SGPR, 0, 8, 64 },
+    { GPUArchitecture::GCN1_1, REGTYPE_SGPR, REGCOUNT_NO_VCC, 8, 62 },
+    { GPUArchitecture::GCN1_1, REGTYPE_SGPR, 0, 10, 48 },
+    { GPUArchitecture::GCN1_2, REGTYPE_SGPR, 0, 8, 96 },
+    { GPUArchitecture::GCN1_2, REGTYPE_SGPR, REGCOUNT_NO_FLAT, 8, 90 },
+    { GPUArchitecture::GCN1_4, REGTYPE_SGPR, 0, 10, 80 },
+    { GPUArchitecture::GCN1_4, REGTYPE_SGPR, 0, 7, 104 },
+    /* GCN1.5 wave64 */
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, 0, 2, 256 },
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, 0, 3, 168 },
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, 0, 5, 100 },
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, 0, 20, 24 },
+    /* GCN1.5 wave32 */
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, REGCOUNT_WAVE32, 4, 256 },
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, REGCOUNT_WAVE32, 5, 200 },
+    { GPUArchitecture::GCN1_5, REGTYPE_VGPR, REGCOUNT_WAVE32, 20, 48 },
+    { GPUArchitecture::GCN1_5, REGTYPE_SGPR, REGCOUNT_WAVE32, 20, 106 }
+};
+
+static void testGetGPUMaxRegsNumForWaves()
+{
+    char descBuf[60];
+    for (cxuint i = 0; i < sizeof gpuWavesRegsTestTable/ sizeof(GPUWavesRegsTestCase); i++)
+    {
+        const GPUWavesRegsTestCase testCase = gpuWavesRegsTestTable[i];
+        snprintf(descBuf, sizeof descBuf, "Test %d", i);
+        const cxuint result = getGPUMaxRegsNumForWaves(testCase.arch, testCase.regType,
+                                testCase.wavesNum, testCase.flags);
+        assertValue("testGetGPUMaxRegsNumForWaves", descBuf,
+                    testCase.regsNum, result);
+        // inverse function
+        const cxuint wavesNum = getGPUWavesNumForRegsNum(testCase.arch, testCase.regType,
+                                testCase.regsNum, testCase.flags);
+        assertTrue("testGetGPUMaxRegsNumForWaves", std::string(descBuf) + ".waves",
+                    wavesNum >= testCase.wavesNum);
+        if (wavesNum < getGPUMaxWavesPerSIMD(testCase.arch))
+            assertTrue("testGetGPUMaxRegsNumForWaves", std::string(descBuf) + ".waves2",
+                    testCase.regsNum > getGPUMaxRegsNumForWaves(testCase.arch,
+                            testCase.regType, wavesNum+1, testCase.flags));
+    }
+}
 
 int main(int argc, const char** argv)
 {
@@ -315,5 +377,6 @@ int main(int argc, const char** argv)
     retVal |= callTest(testGetGPUArchitectureFromName);
     retVal |= callTest(testGetGPUMaxRegistersNum);
     retVal |= callTest(testGetGPUExtraRegsNum);
+    retVal |= callTest(testGetGPUMaxRegsNumForWaves);
     return retVal;
 }
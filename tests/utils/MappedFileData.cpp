@@ -0,0 +1,108 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <CLRX/utils/Utilities.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+static const char* mappedFileName = "MappedFileDataTest.bin";
+
+static void writeTestFile(const char* filename, const Array<cxbyte>& content)
+{
+    std::ofstream ofs(filename, std::ios::binary);
+    ofs.write((const char*)content.data(), content.size());
+}
+
+// content longer than page to check mapping of many pages
+static Array<cxbyte> getTestContent()
+{
+    Array<cxbyte> content(10000);
+    for (cxuint i = 0; i < 10000; i++)
+        content[i] = cxbyte(i*7 + (i>>8));
+    return content;
+}
+
+static void testMapping()
+{
+    const Array<cxbyte> content = getTestContent();
+    writeTestFile(mappedFileName, content);
+    {
+        MappedFileData data(mappedFileName);
+#ifndef HAVE_WINDOWS
+        assertTrue("MappedFileData", "mapped", data.isMapped());
+#endif
+        assertArray<cxbyte>("MappedFileData", "content", content,
+                    data.size(), data.data());
+    }
+    ::remove(mappedFileName);
+}
+
+static void testWriteToMappedData()
+{
+    const Array<cxbyte> content = getTestContent();
+    writeTestFile(mappedFileName, content);
+    {
+        MappedFileData data(mappedFileName);
+        // change data in place (like binary classes that patch their input)
+        for (size_t i = 0; i < data.size(); i++)
+            data.data()[i] ^= 0xff;
+        assertValue("MappedFileData", "changedByte", cxbyte(content[100]^0xff),
+                    data.data()[100]);
+        // file opened at same time has original content
+        MappedFileData data2(mappedFileName);
+        assertArray<cxbyte>("MappedFileData", "otherMapping", content,
+                    data2.size(), data2.data());
+    }
+    // file on disk is not changed
+    Array<cxbyte> fileData = loadDataFromFile(mappedFileName);
+    assertArray<cxbyte>("MappedFileData", "fileContent", content, fileData);
+    ::remove(mappedFileName);
+}
+
+static void testFallbacks()
+{
+    // empty file can not be mapped
+    writeTestFile(mappedFileName, Array<cxbyte>());
+    {
+        MappedFileData data(mappedFileName);
+        assertTrue("MappedFileData", "emptyNotMapped", !data.isMapped());
+        assertValue("MappedFileData", "emptySize", size_t(0), data.size());
+    }
+    ::remove(mappedFileName);
+#ifndef HAVE_WINDOWS
+    // nonexistent file
+    assertCLRXException("MappedFileData", "nonExistent",
+                "File or directory doesn't exists",
+                [](){ MappedFileData data("MappedFileDataNonExistent.bin"); });
+#endif
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    retVal |= callTest(testMapping);
+    retVal |= callTest(testWriteToMappedData);
+    retVal |= callTest(testFallbacks);
+    return retVal;
+}
@@ -0,0 +1,206 @@
+/*
+ *  CLRadeonExtender - Unofficial OpenCL Radeon Extensions Library
+ *  Copyright (C) 2014-2018 Mateusz Szpakowski
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <CLRX/Config.h>
+#include <iostream>
+#include <sstream>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <CLRX/utils/Containers.h>
+#include "../TestUtils.h"
+
+using namespace CLRX;
+
+struct TestValue
+{
+    size_t value;
+    size_t size;
+
+    size_t weight() const
+    { return size; }
+};
+
+static void testSimpleCacheBasic()
+{
+    SimpleCache<cxuint, TestValue> cache(4);
+    cache.put(1, { 11, 1 });
+    cache.put(2, { 12, 1 });
+    cache.put(3, { 13, 1 });
+    cache.put(4, { 14, 1 });
+    assertTrue("SimpleCache", "use1", cache.use(1) != nullptr);
+    assertValue("SimpleCache", "use1value", size_t(11), cache.use(1)->value);
+    assertTrue("SimpleCache", "use2", cache.use(2) != nullptr);
+    assertTrue("SimpleCache", "use3", cache.use(3) != nullptr);
+    // 4 is least used
+    cache.put(5, { 15, 1 });
+    assertTrue("SimpleCache", "evict4", !cache.hasKey(4));
+    assertTrue("SimpleCache", "has5", cache.hasKey(5));
+    // 5 has zero usage
+    cache.put(6, { 16, 1 });
+    assertTrue("SimpleCache", "evict5", !cache.hasKey(5));
+    // 2 and 3 have same usage, 3 used later, put resets usage
+    cache.put(1, { 21, 1 });
+    assertValue("SimpleCache", "put1value", size_t(21), cache.use(1)->value);
+    cache.use(6);
+    cache.use(6);
+    cache.put(7, { 17, 1 });
+    assertTrue("SimpleCache", "evict1", !cache.hasKey(1));
+    assertTrue("SimpleCache", "has2", cache.hasKey(2));
+    assertTrue("SimpleCache", "has3", cache.hasKey(3));
+    assertTrue("SimpleCache", "has6", cache.hasKey(6));
+    // heavy element evicts many elements
+    cache.put(8, { 18, 3 });
+    assertTrue("SimpleCache", "evict7", !cache.hasKey(7));
+    assertTrue("SimpleCache", "evict3", !cache.hasKey(3));
+    assertTrue("SimpleCache", "evict2", !cache.hasKey(2));
+    assertTrue("SimpleCache", "has6_2", cache.hasKey(6));
+    assertTrue("SimpleCache", "has8", cache.hasKey(8));
+    // element heavier than max weight
+    cache.put(9, { 19, 10 });
+    assertTrue("SimpleCache", "has9", cache.use(9) != nullptr);
+    assertTrue("SimpleCache", "no10", cache.use(10) == nullptr);
+}
+
+// keys allocated on heap, eviction must not use key from destroyed node
+static void testSimpleCacheStringKeys()
+{
+    SimpleCache<std::string, TestValue> cache(4);
+    for (size_t i = 0; i < 64; i++)
+    {
+        std::ostringstream keyOss;
+        keyOss << "long key to avoid small string optimization #" << i;
+        cache.put(keyOss.str(), { i, 1 });
+        cache.use(keyOss.str());
+    }
+    size_t keysNum = 0;
+    for (size_t i = 0; i < 64; i++)
+    {
+        std::ostringstream keyOss;
+        keyOss << "long key to avoid small string optimization #" << i;
+        const TestValue* value = cache.use(keyOss.str());
+        if (value != nullptr)
+        {
+            assertValue("SimpleCache", keyOss.str() + ".value", i, value->value);
+            keysNum++;
+        }
+    }
+    assertValue("SimpleCache", "stringKeysNum", size_t(4), keysNum);
+}
+
+/* reference cache: evicts element with lowest usage,
+ * from them element which got its usage as last */
+class RefCache
+{
+private:
+    struct Entry
+    {
+        size_t usage;
+        size_t stamp;
+        size_t weight;
+    };
+    std::map<cxuint, Entry> entries;
+    size_t totalWeight;
+    size_t maxWeight;
+    size_t stamp;
+public:
+    explicit RefCache(size_t _maxWeight) : totalWeight(0), maxWeight(_maxWeight),
+            stamp(0)
+    { }
+
+    bool use(cxuint key)
+    {
+        auto it = entries.find(key);
+        if (it == entries.end())
+            return false;
+        it->second.usage++;
+        it->second.stamp = ++stamp;
+        return true;
+    }
+
+    bool hasKey(cxuint key) const
+    { return entries.find(key) != entries.end(); }
+
+    void put(cxuint key, size_t weight)
+    {
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            totalWeight -= it->second.weight;
+            entries.erase(it);
+        }
+        if (weight > maxWeight)
+            maxWeight = weight<<1;
+        while (totalWeight + weight > maxWeight)
+        {
+            auto minIt = entries.begin();
+            for (auto eit = entries.begin(); eit != entries.end(); ++eit)
+                if (eit->second.usage < minIt->second.usage ||
+                    (eit->second.usage == minIt->second.usage &&
+                        eit->second.stamp > minIt->second.stamp))
+                    minIt = eit;
+            totalWeight -= minIt->second.weight;
+            entries.erase(minIt);
+        }
+        entries.insert({ key, Entry{ 0, ++stamp, weight } });
+        totalWeight += weight;
+    }
+};
+
+static void testSimpleCacheRandom()
+{
+    SimpleCache<cxuint, TestValue> cache(100);
+    RefCache refCache(100);
+    uint32_t state = 1234567;
+    for (cxuint i = 0; i < 20000; i++)
+    {
+        state = state*1103515245U + 12345U;
+        const cxuint key = (state>>16) % 64;
+        const cxuint op = (state>>8) % 4;
+        std::ostringstream caseOss;
+        caseOss << "random#" << i;
+        if (op == 0)
+        {
+            const size_t weight = 1 + (state>>24) % 8;
+            cache.put(key, { key, weight });
+            refCache.put(key, weight);
+        }
+        else
+        {
+            TestValue* value = cache.use(key);
+            assertValue("SimpleCache", caseOss.str() + ".use",
+                        refCache.use(key), value != nullptr);
+            if (value != nullptr)
+                assertValue("SimpleCache", caseOss.str() + ".value",
+                            size_t(key), value->value);
+        }
+        for (cxuint k = 0; k < 64; k++)
+            assertValue("SimpleCache", caseOss.str() + ".hasKey",
+                        refCache.hasKey(k), cache.hasKey(k));
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    int retVal = 0;
+    retVal |= callTest(testSimpleCacheBasic);
+    retVal |= callTest(testSimpleCacheStringKeys);
+    retVal |= callTest(testSimpleCacheRandom);
+    return retVal;
+}
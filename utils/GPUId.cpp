@@ -19,6 +19,7 @@
 
 #include <CLRX/Config.h>
 #include <cstring>
+#include <algorithm>
 #include <utility>
 #include <cstdint>
 #include <climits>
@@ -374,6 +375,48 @@ cxuint CLRX::getGPUExtraRegsNum(GPUArchitecture architecture, cxuint regType, Fl
     return 0;
 }
 
+cxuint CLRX::getGPUMaxWavesPerSIMD(GPUArchitecture architecture)
+{
+    if (architecture > GPUArchitecture::GPUARCH_MAX)
+        throw GPUIdException("Unknown GPU architecture");
+    return (architecture>=GPUArchitecture::GCN1_5) ? 20 : 10;
+}
+
+cxuint CLRX::getGPUMaxRegsNumForWaves(GPUArchitecture architecture, cxuint regType,
+              cxuint wavesNum, Flags flags)
+{
+    if (wavesNum == 0 || wavesNum > getGPUMaxWavesPerSIMD(architecture))
+        throw GPUIdException("Waves number out of range");
+    const cxuint maxRegs = getGPUMaxRegistersNum(architecture, regType, flags);
+    if (regType == REGTYPE_VGPR)
+    {
+        // register file per SIMD lane and allocation granularity
+        // (wave64 in GCN1.5 uses two lanes of SIMD32)
+        const bool isGCN15 = architecture>=GPUArchitecture::GCN1_5;
+        const bool wave32 = isGCN15 && (flags & REGCOUNT_WAVE32)!=0;
+        const cxuint regsNum = ((wave32 ? 1024U : (isGCN15 ? 512U : 256U)) / wavesNum) &
+                    ~(wave32 ? 7U : 3U);
+        return std::min(maxRegs, regsNum);
+    }
+    if (architecture>=GPUArchitecture::GCN1_5)
+        return maxRegs; // SGPRs do not limit occupancy
+    // SGPRs per SIMD and allocation granularity (includes extra registers)
+    const bool isGCN12 = architecture>=GPUArchitecture::GCN1_2;
+    const cxuint regsNum = ((isGCN12 ? 800U : 512U) / wavesNum) & ~(isGCN12 ? 15U : 7U);
+    const cxuint allMaxRegs = getGPUMaxRegistersNum(architecture, regType, 0);
+    return std::min(allMaxRegs, regsNum) - (allMaxRegs - maxRegs);
+}
+
+cxuint CLRX::getGPUWavesNumForRegsNum(GPUArchitecture architecture, cxuint regType,
+              cxuint regsNum, Flags flags)
+{
+    cxuint wavesNum = getGPUMaxWavesPerSIMD(architecture);
+    for (; wavesNum > 1; wavesNum--)
+        if (regsNum <= getGPUMaxRegsNumForWaves(architecture, regType, wavesNum, flags))
+            break;
+    return wavesNum;
+}
+
 uint32_t CLRX::calculatePgmRSrc1(GPUArchitecture arch, cxuint vgprsNum, cxuint sgprsNum,
             cxuint priority, cxuint floatMode, bool privMode, bool dx10Clamp,
             bool debugMode, bool ieeeMode)
@@ -30,11 +30,17 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #endif
 #include <fstream>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <system_error>
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <string>
@@ -463,6 +469,48 @@ Array<cxbyte> CLRX::loadDataFromFile(const char* filename)
     return buf;
 }
 
+MappedFileData::MappedFileData(const char* filename) : dataSize(0), mappedData(nullptr)
+{
+#ifndef HAVE_WINDOWS
+    if (isDirectory(filename))
+        throw Exception("This is directory!");
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+        throw Exception("Can't open file");
+    struct stat stBuf;
+    if (::fstat(fd, &stBuf) == 0 && S_ISREG(stBuf.st_mode) && stBuf.st_size > 0)
+    {
+        if (uint64_t(stBuf.st_size) > SIZE_MAX)
+        {
+            ::close(fd);
+            throw Exception("File is too big to load");
+        }
+        // private mapping: changes of data (if any) will not be written to file
+        void* ptr = ::mmap(nullptr, stBuf.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE,
+                    fd, 0);
+        if (ptr != MAP_FAILED)
+        {
+            mappedData = (cxbyte*)ptr;
+            dataSize = stBuf.st_size;
+        }
+    }
+    ::close(fd);
+    if (mappedData != nullptr)
+        return;
+#endif
+    // fallback for streams or if mapping failed
+    loadedData = loadDataFromFile(filename);
+    dataSize = loadedData.size();
+}
+
+MappedFileData::~MappedFileData()
+{
+#ifndef HAVE_WINDOWS
+    if (mappedData != nullptr)
+        ::munmap(mappedData, dataSize);
+#endif
+}
+
 void CLRX::filesystemPath(char* path)
 {
     while (*path != 0)  // change to native dir separator
@@ -517,6 +565,22 @@ uint64_t CLRX::getFileTimestamp(const char* filename)
 #endif
 }
 
+uint64_t CLRX::getFileSize(const char* filename)
+{
+    struct stat stBuf;
+    errno = 0;
+    if (::stat(filename, &stBuf) != 0)
+    {
+        if (errno == ENOENT)
+            throw Exception("File or directory doesn't exists");
+        else if (errno == EACCES)
+            throw Exception("Access to file or directory is not permitted");
+        else
+            throw Exception("Can't determine size of file");
+    }
+    return stBuf.st_size;
+}
+
 std::string CLRX::getHomeDir()
 {
 #ifndef HAVE_WINDOWS
@@ -804,3 +868,51 @@ std::string CLRX::findLLVMConfig()
     }
     return "";
 }
+
+void CLRX::runParallelJobs(size_t jobsNum, cxuint threadsNum,
+            const std::function<void(size_t)>& job)
+{
+    std::atomic<size_t> nextJob(0);
+    std::mutex exMutex;
+    std::exception_ptr firstEx;
+    size_t firstExJob = SIZE_MAX;
+    
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            const size_t j = nextJob.fetch_add(1);
+            if (j >= jobsNum)
+                break;
+            try
+            { job(j); }
+            catch(...)
+            {
+                // keep exception from first job (in order) to rethrow it later
+                std::lock_guard<std::mutex> lock(exMutex);
+                if (j < firstExJob)
+                {
+                    firstExJob = j;
+                    firstEx = std::current_exception();
+                }
+            }
+        }
+    };
+    
+    if (threadsNum == 0)
+        threadsNum = std::max(std::thread::hardware_concurrency(), 1U);
+    const size_t workersNum = std::min(size_t(threadsNum), jobsNum);
+    std::vector<std::thread> threads;
+    // current thread is also worker
+    for (size_t i = 1; i < workersNum; i++)
+        try
+        { threads.push_back(std::thread(worker)); }
+        catch(const std::system_error& ex)
+        { break; } // if no new threads, then use already created threads
+    worker();
+    for (std::thread& thread: threads)
+        thread.join();
+    
+    if (firstEx)
+        std::rethrow_exception(firstEx);
+}